@@ -0,0 +1,234 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Benchmark of the bulk base64 codec against a per-character codec
+ *
+ * This example does not use the modem. It times the conversion of a
+ * socket sized payload to and from base64, first with a per-character
+ * codec like the one previously in the Thingstream library and then with
+ * Thingstream_Base64_encode() and Thingstream_Base64_decode(), and reports
+ * the throughput of each.
+ */
+
+#include <string.h>
+
+#include "run_example.h"
+#include "base64_codec.h"
+#include "platform_cycles.h"
+
+/** The size of the payload converted in each round */
+#ifndef BENCH_PAYLOAD_LEN
+#define BENCH_PAYLOAD_LEN 512
+#endif
+
+/** The number of rounds timed for each codec */
+#ifndef BENCH_ROUNDS
+#define BENCH_ROUNDS 200
+#endif
+
+static uint8_t payload[BENCH_PAYLOAD_LEN];
+static char b64Text[BASE64_ENCODED_LEN(BENCH_PAYLOAD_LEN)];
+static uint8_t decoded[BENCH_PAYLOAD_LEN];
+
+/** The base64 alphabet */
+static const char b64Digits[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/**
+ * Reference encoder: one 6-bit field at a time, carrying the spare bits
+ * from byte to byte.
+ */
+static char* scalarEncode(char* buf, const uint8_t* data, uint16_t len)
+{
+    uint16_t i;
+    uint8_t carry = 0;
+    for (i = 0; i < len; ++i)
+    {
+        uint8_t b = data[i];
+        switch (i % 3)
+        {
+        case 0:
+            *buf++ = b64Digits[b >> 2];
+            carry = (b & 0x03) << 4;
+            break;
+        case 1:
+            *buf++ = b64Digits[carry | (b >> 4)];
+            carry = (b & 0x0f) << 2;
+            break;
+        default:
+            *buf++ = b64Digits[carry | (b >> 6)];
+            *buf++ = b64Digits[b & 0x3f];
+            break;
+        }
+    }
+    if ((len % 3) != 0)
+    {
+        *buf++ = b64Digits[carry];
+        *buf++ = '=';
+        if ((len % 3) == 1)
+        {
+            *buf++ = '=';
+        }
+    }
+    return buf;
+}
+
+/**
+ * Reference decoder: branches on the class of each character.
+ */
+static int32_t scalarDecode(uint8_t* buf, const char* text, uint16_t textLen)
+{
+    uint16_t i;
+    int32_t outLen = 0;
+    uint32_t bits = 0;
+    uint8_t nbits = 0;
+    if ((textLen & 3) != 0)
+    {
+        return -1;
+    }
+    for (i = 0; i < textLen; ++i)
+    {
+        char ch = text[i];
+        uint8_t value;
+        if ((ch >= 'A') && (ch <= 'Z'))
+            value = ch - 'A';
+        else if ((ch >= 'a') && (ch <= 'z'))
+            value = ch - 'a' + 26;
+        else if ((ch >= '0') && (ch <= '9'))
+            value = ch - '0' + 52;
+        else if (ch == '+')
+            value = 62;
+        else if (ch == '/')
+            value = 63;
+        else if ((ch == '=') && (i >= textLen - 2))
+            break;
+        else
+            return -1;
+        bits = (bits << 6) | value;
+        nbits += 6;
+        if (nbits >= 8)
+        {
+            nbits -= 8;
+            buf[outLen++] = (uint8_t)(bits >> nbits);
+        }
+    }
+    return outLen;
+}
+
+typedef enum { ENCODE_SCALAR, ENCODE_BULK, DECODE_SCALAR, DECODE_BULK } BenchCase;
+
+static const char* const benchNames[] = {
+    "encode scalar", "encode bulk", "decode scalar", "decode bulk"
+};
+
+/**
+ * Time one codec and print its throughput.
+ *
+ * @param which the codec to time
+ * @param haveCycles true if the cycle counter is running
+ */
+static void bench(BenchCase which, bool haveCycles)
+{
+    uint32_t startMs = Thingstream_Platform_getTimeMillis();
+    uint32_t startCycles = Platform_getCycleCount();
+    uint16_t round;
+
+    for (round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        switch (which)
+        {
+        case ENCODE_SCALAR:
+            (void)scalarEncode(b64Text, payload, sizeof(payload));
+            break;
+        case ENCODE_BULK:
+            (void)Thingstream_Base64_encode(b64Text, payload, sizeof(payload));
+            break;
+        case DECODE_SCALAR:
+            (void)scalarDecode(decoded, b64Text, sizeof(b64Text));
+            break;
+        case DECODE_BULK:
+            (void)Thingstream_Base64_decode(decoded, b64Text, sizeof(b64Text));
+            break;
+        }
+    }
+
+    uint32_t cycles = Platform_getCycleCount() - startCycles;
+    uint32_t millis = Thingstream_Platform_getTimeMillis() - startMs;
+    uint32_t bytes = (uint32_t)BENCH_ROUNDS * BENCH_PAYLOAD_LEN;
+
+    if (haveCycles && (cycles > 0))
+    {
+        /* bytes per cycle, reported in thousandths */
+        Thingstream_Util_printf("%s: %d payload bytes, %d cycles, %d.%03d bytes/cycle\n",
+                                benchNames[which], bytes, cycles,
+                                (int)(bytes / cycles),
+                                (int)(((uint64_t)(bytes % cycles) * 1000) / cycles));
+    }
+    else
+    {
+        Thingstream_Util_printf("%s: %d payload bytes, %d ms\n",
+                                benchNames[which], bytes, millis);
+    }
+}
+
+/**
+ * Run the base64 codec benchmark. The transport is not used.
+ */
+ThingstreamClientResult run_example(ThingstreamTransport *transport,
+                        ThingstreamModemUdpInit *modem_init,
+                        uint16_t modem_flags)
+{
+    ThingstreamClientResult result = CLIENT_ILLEGAL_ARGUMENT;
+    uint32_t seed = 12345;
+    uint16_t i;
+
+    UNUSED(transport);
+    UNUSED(modem_init);
+    UNUSED(modem_flags);
+
+    for (i = 0; i < sizeof(payload); ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        payload[i] = (uint8_t)(seed >> 16);
+    }
+
+    bool haveCycles = Platform_initCycleCounter();
+
+    /* Check that both codecs agree before timing them */
+    (void)scalarEncode(b64Text, payload, sizeof(payload));
+    memset(decoded, 0, sizeof(decoded));
+    CHECK("bulk decode",
+          (Thingstream_Base64_decode(decoded, b64Text, sizeof(b64Text)) == sizeof(payload))
+          && (memcmp(decoded, payload, sizeof(payload)) == 0));
+    memset(b64Text, 0, sizeof(b64Text));
+    (void)Thingstream_Base64_encode(b64Text, payload, sizeof(payload));
+    memset(decoded, 0, sizeof(decoded));
+    CHECK("bulk encode",
+          (scalarDecode(decoded, b64Text, sizeof(b64Text)) == sizeof(payload))
+          && (memcmp(decoded, payload, sizeof(payload)) == 0));
+
+    bench(ENCODE_SCALAR, haveCycles);
+    bench(ENCODE_BULK, haveCycles);
+    bench(DECODE_SCALAR, haveCycles);
+    bench(DECODE_BULK, haveCycles);
+
+    result = CLIENT_SUCCESS;
+
+error:
+    return result;
+}
@@ -0,0 +1,338 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Bulk conversion of binary data to and from base64 text
+ *
+ * The portable code assembles each 3-byte group into a 32-bit word and
+ * looks up its four 6-bit fields. Decoding looks up each character in a
+ * 128 entry table whose invalid entries have the top bit set, so the
+ * lookups of a whole payload are ORed together and checked once at the
+ * end, keeping the loops free of per-character branches.
+ *
+ * The SSSE3 code follows Wojciech Mula's pshufb based encoder and
+ * decoder. The NEON code de-interleaves with vld3/vld4 and maps the 6-bit
+ * values with lane-wise range masks.
+ */
+
+#include <stddef.h>
+
+#include "base64_codec.h"
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/** The base64 alphabet */
+static const char alphabet[64] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/** A decodeTable entry for a character that is not in the alphabet */
+#define INVALID         0x80
+
+/** The value of each ASCII character, or INVALID */
+static const uint8_t decodeTable[128] = {
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x3e, 0x80, 0x80, 0x80, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0x80, 0x80, 0x80, 0x80, 0x80,
+};
+
+/**
+ * Decode four characters into a 24-bit word, ORing into *pBad a value
+ * with bit 7 set if any of them is not in the alphabet.
+ */
+static inline uint32_t decodeQuad(const uint8_t* in, uint32_t* pBad)
+{
+    uint32_t c0 = in[0];
+    uint32_t c1 = in[1];
+    uint32_t c2 = in[2];
+    uint32_t c3 = in[3];
+    uint32_t v0 = decodeTable[c0 & 0x7f];
+    uint32_t v1 = decodeTable[c1 & 0x7f];
+    uint32_t v2 = decodeTable[c2 & 0x7f];
+    uint32_t v3 = decodeTable[c3 & 0x7f];
+    *pBad |= c0 | c1 | c2 | c3 | v0 | v1 | v2 | v3;
+    return (v0 << 18) | (v1 << 12) | (v2 << 6) | v3;
+}
+
+#if defined(__SSSE3__)
+
+/**
+ * Convert 12 bytes, in the low 12 lanes, to 16 base64 characters.
+ */
+static inline __m128i ssse3Encode(__m128i in)
+{
+    /* Spread each 3-byte group over a 32-bit lane as bytes 1,0,2,1 */
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7,
+                                           4, 5, 3, 4, 1, 2, 0, 1));
+
+    /* Move the four 6-bit fields into their own bytes */
+    __m128i ac = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)),
+                                 _mm_set1_epi32(0x04000040));
+    __m128i bd = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)),
+                                 _mm_set1_epi32(0x01000010));
+    __m128i index = _mm_or_si128(ac, bd);
+
+    /* Map 0..25 to 13, 26..51 to 0, 52..61 to 1..10, 62 to 11, 63 to 12 and
+     * look up the offset to add for each range
+     */
+    __m128i range = _mm_subs_epu8(index, _mm_set1_epi8(51));
+    __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), index);
+    range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+    __m128i offset = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52,
+                                   '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                   '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                   '/' - 63, 'A', 0, 0);
+    return _mm_add_epi8(index, _mm_shuffle_epi8(offset, range));
+}
+
+/**
+ * Convert 16 base64 characters to 12 bytes, in the low 12 lanes, clearing
+ * lanes of *pOk that are not in the alphabet.
+ */
+static inline __m128i ssse3Decode(__m128i c, __m128i* pOk)
+{
+    __m128i nibbleMask = _mm_set1_epi8(0x0f);
+    __m128i hi = _mm_and_si128(_mm_srli_epi32(c, 4), nibbleMask);
+    __m128i lo = _mm_and_si128(c, nibbleMask);
+
+    /* For each low nibble, the high nibbles that make a valid character */
+    __m128i validHi = _mm_setr_epi8((char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8,
+                                    (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+                                    (char)0xf8, (char)0xf8, (char)0xf0, 0x54,
+                                    0x50, 0x50, 0x50, 0x54);
+    __m128i hiBit = _mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80,
+                                  0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i match = _mm_and_si128(_mm_shuffle_epi8(validHi, lo),
+                                  _mm_shuffle_epi8(hiBit, hi));
+    *pOk = _mm_andnot_si128(_mm_cmpeq_epi8(match, _mm_setzero_si128()), *pOk);
+
+    /* The offset by high nibble, '/' shares its high nibble with '+' */
+    __m128i offset = _mm_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71,
+                                   0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i slash = _mm_and_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('/')),
+                                  _mm_set1_epi8(-3));
+    __m128i v = _mm_add_epi8(c, _mm_add_epi8(_mm_shuffle_epi8(offset, hi), slash));
+
+    /* Pack each lane of four 6-bit values into 24 bits */
+    v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+    v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+    return _mm_shuffle_epi8(v, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                             -1, -1, -1, -1));
+}
+
+#elif defined(__ARM_NEON)
+
+/**
+ * Convert 6-bit values to base64 characters.
+ */
+static inline uint8x16_t neonEncode(uint8x16_t v)
+{
+    /* 'A' + v, then +6 from 26, -75 from 52, -15 from 62 and +3 for 63 */
+    uint8x16_t c = vaddq_u8(v, vdupq_n_u8('A'));
+    c = vaddq_u8(c, vandq_u8(vcgeq_u8(v, vdupq_n_u8(26)), vdupq_n_u8(6)));
+    c = vsubq_u8(c, vandq_u8(vcgeq_u8(v, vdupq_n_u8(52)), vdupq_n_u8(75)));
+    c = vsubq_u8(c, vandq_u8(vcgeq_u8(v, vdupq_n_u8(62)), vdupq_n_u8(15)));
+    c = vaddq_u8(c, vandq_u8(vceqq_u8(v, vdupq_n_u8(63)), vdupq_n_u8(3)));
+    return c;
+}
+
+/**
+ * Convert base64 characters to 6-bit values, clearing lanes of *pOk that
+ * are not in the alphabet.
+ */
+static inline uint8x16_t neonDecode(uint8x16_t c, uint8x16_t* pOk)
+{
+    uint8x16_t upper = vandq_u8(vcgeq_u8(c, vdupq_n_u8('A')), vcleq_u8(c, vdupq_n_u8('Z')));
+    uint8x16_t lower = vandq_u8(vcgeq_u8(c, vdupq_n_u8('a')), vcleq_u8(c, vdupq_n_u8('z')));
+    uint8x16_t digit = vandq_u8(vcgeq_u8(c, vdupq_n_u8('0')), vcleq_u8(c, vdupq_n_u8('9')));
+    uint8x16_t plus = vceqq_u8(c, vdupq_n_u8('+'));
+    uint8x16_t slash = vceqq_u8(c, vdupq_n_u8('/'));
+    uint8x16_t offset = vandq_u8(upper, vdupq_n_u8((uint8_t)-65));
+    offset = vorrq_u8(offset, vandq_u8(lower, vdupq_n_u8((uint8_t)-71)));
+    offset = vorrq_u8(offset, vandq_u8(digit, vdupq_n_u8(4)));
+    offset = vorrq_u8(offset, vandq_u8(plus, vdupq_n_u8(19)));
+    offset = vorrq_u8(offset, vandq_u8(slash, vdupq_n_u8(16)));
+    *pOk = vandq_u8(*pOk, vorrq_u8(vorrq_u8(upper, lower),
+                                   vorrq_u8(digit, vorrq_u8(plus, slash))));
+    return vaddq_u8(c, offset);
+}
+
+#endif /* __ARM_NEON */
+
+
+char *Thingstream_Base64_encode(char *buf, const uint8_t *data, uint16_t len)
+{
+    /* Each block is loaded before its output is stored, and with the data
+     * at least one byte per 3-byte group into the buffer the output
+     * never reaches data not yet loaded, so in place encoding is safe.
+     */
+#if defined(__SSSE3__)
+    while (len >= 16)
+    {
+        __m128i in = _mm_loadu_si128((const __m128i*)data);
+        _mm_storeu_si128((__m128i*)buf, ssse3Encode(in));
+        data += 12;
+        buf += 16;
+        len -= 12;
+    }
+#elif defined(__ARM_NEON)
+    while (len >= 48)
+    {
+        uint8x16x3_t in = vld3q_u8(data);
+        uint8x16x4_t out;
+        out.val[0] = neonEncode(vshrq_n_u8(in.val[0], 2));
+        out.val[1] = neonEncode(vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4),
+                                                  vshrq_n_u8(in.val[1], 4)),
+                                         vdupq_n_u8(0x3f)));
+        out.val[2] = neonEncode(vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2),
+                                                  vshrq_n_u8(in.val[2], 6)),
+                                         vdupq_n_u8(0x3f)));
+        out.val[3] = neonEncode(vandq_u8(in.val[2], vdupq_n_u8(0x3f)));
+        vst4q_u8((uint8_t*)buf, out);
+        data += 48;
+        buf += 64;
+        len -= 48;
+    }
+#endif /* __ARM_NEON */
+
+    while (len >= 3)
+    {
+        uint32_t w = ((uint32_t)data[0] << 16)
+                   | ((uint32_t)data[1] << 8)
+                   | (uint32_t)data[2];
+        buf[0] = alphabet[w >> 18];
+        buf[1] = alphabet[(w >> 12) & 0x3f];
+        buf[2] = alphabet[(w >> 6) & 0x3f];
+        buf[3] = alphabet[w & 0x3f];
+        data += 3;
+        buf += 4;
+        len -= 3;
+    }
+    if (len > 0)
+    {
+        uint32_t w = (uint32_t)data[0] << 16;
+        if (len == 2)
+        {
+            w |= (uint32_t)data[1] << 8;
+        }
+        buf[0] = alphabet[w >> 18];
+        buf[1] = alphabet[(w >> 12) & 0x3f];
+        buf[2] = (len == 2) ? alphabet[(w >> 6) & 0x3f] : '=';
+        buf[3] = '=';
+        buf += 4;
+    }
+    return buf;
+}
+
+
+int32_t Thingstream_Base64_decode(uint8_t *buf, const char *text, uint16_t textLen)
+{
+    const uint8_t* in = (const uint8_t*)text;
+    uint8_t* out = buf;
+    uint32_t bad = 0;
+
+    if ((textLen & 3) != 0)
+    {
+        return -1;
+    }
+    if (textLen == 0)
+    {
+        return 0;
+    }
+
+    /* Each block is loaded before its output is stored, and the output
+     * never moves ahead of the input, so in place decoding is safe. The
+     * blocks stop short of the last quad, which may hold padding.
+     */
+#if defined(__SSSE3__)
+    __m128i ok = _mm_set1_epi8(-1);
+    while (textLen >= 24)
+    {
+        /* 16 bytes are stored, of which the last 4 are overwritten later */
+        __m128i v = ssse3Decode(_mm_loadu_si128((const __m128i*)in), &ok);
+        _mm_storeu_si128((__m128i*)out, v);
+        in += 16;
+        out += 12;
+        textLen -= 16;
+    }
+    bad = (_mm_movemask_epi8(ok) != 0xffff) ? INVALID : 0;
+#elif defined(__ARM_NEON)
+    uint8x16_t ok = vdupq_n_u8(0xff);
+    while (textLen >= 68)
+    {
+        uint8x16x4_t c = vld4q_u8(in);
+        uint8x16_t a = neonDecode(c.val[0], &ok);
+        uint8x16_t b = neonDecode(c.val[1], &ok);
+        uint8x16_t d = neonDecode(c.val[2], &ok);
+        uint8x16_t e = neonDecode(c.val[3], &ok);
+        uint8x16x3_t bytes;
+        bytes.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+        bytes.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(d, 2));
+        bytes.val[2] = vorrq_u8(vshlq_n_u8(d, 6), e);
+        vst3q_u8(out, bytes);
+        in += 64;
+        out += 48;
+        textLen -= 64;
+    }
+    uint64x2_t ok64 = vreinterpretq_u64_u8(ok);
+    bad = ((vgetq_lane_u64(ok64, 0) & vgetq_lane_u64(ok64, 1)) != UINT64_MAX) ? INVALID : 0;
+#endif /* __ARM_NEON */
+
+    while (textLen > 4)
+    {
+        uint32_t w = decodeQuad(in, &bad);
+        out[0] = (uint8_t)(w >> 16);
+        out[1] = (uint8_t)(w >> 8);
+        out[2] = (uint8_t)w;
+        in += 4;
+        out += 3;
+        textLen -= 4;
+    }
+
+    /* The last quad, where '=' padding stands for zero bits */
+    uint8_t last[4];
+    uint8_t pad = (in[3] == '=') ? ((in[2] == '=') ? 2 : 1) : 0;
+    last[0] = in[0];
+    last[1] = in[1];
+    last[2] = (pad == 2) ? 'A' : in[2];
+    last[3] = (pad > 0) ? 'A' : in[3];
+    uint32_t w = decodeQuad(last, &bad);
+    out[0] = (uint8_t)(w >> 16);
+    if (pad < 2)
+    {
+        out[1] = (uint8_t)(w >> 8);
+    }
+    if (pad < 1)
+    {
+        out[2] = (uint8_t)w;
+    }
+    out += 3 - pad;
+
+    if ((bad & INVALID) != 0)
+    {
+        return -1;
+    }
+    return (int32_t)(out - buf);
+}
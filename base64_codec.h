@@ -0,0 +1,76 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Bulk conversion of binary data to and from base64 text
+ *
+ * These routines convert whole payloads using the standard alphabet with
+ * '=' padding. The portable code handles each 3-byte group as a 32-bit word
+ * with table lookups, and SSSE3 or NEON is used when built for a host that
+ * has them.
+ */
+
+#ifndef INC_BASE64_CODEC_H
+#define INC_BASE64_CODEC_H
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * The length of the base64 text for binary data of the given length.
+ * @hideinitializer
+ */
+#define BASE64_ENCODED_LEN(len) ((((len) + 2) / 3) * 4)
+
+/**
+ * Convert binary data to base64 text.
+ * Note that the result is not 0-terminated.
+ * The conversion may be done in place if the data is at least (len + 2) / 3
+ * bytes into the buffer, e.g. at the end of a buffer of
+ * BASE64_ENCODED_LEN(len) bytes.
+ * @param buf buffer to receive the text, at least BASE64_ENCODED_LEN(len)
+ *    bytes
+ * @param data the binary data
+ * @param len the length of the binary data
+ * @return a pointer to just after the last byte of the conversion.
+ */
+extern char *Thingstream_Base64_encode(char *buf, const uint8_t *data, uint16_t len);
+
+/**
+ * Convert base64 text to binary data.
+ * The conversion may be done in place by passing the same address as buf
+ * and text.
+ * @param buf buffer to receive the binary data, at least textLen / 4 * 3
+ *    bytes
+ * @param text the base64 text
+ * @param textLen the length of the base64 text
+ * @return the length of the binary data, or -1 if textLen is not a
+ *    multiple of 4 or the text contains a character that is not in the
+ *    alphabet (or '=' other than as padding).
+ */
+extern int32_t Thingstream_Base64_decode(uint8_t *buf, const char *text, uint16_t textLen);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_BASE64_CODEC_H */
@@ -1,5 +1,5 @@
 /*
- * Copyright 2017-2021 Thingstream AG
+ * Copyright 2017-2021, 2026 Thingstream AG
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -22,6 +22,7 @@
 #ifndef INC_BASE64_CODEC_TRANSPORT_H_
 #define INC_BASE64_CODEC_TRANSPORT_H_
 
+#include <stdbool.h>
 #include "transport_api.h"
 
 #if defined(__cplusplus)
@@ -30,11 +31,43 @@ extern "C" {
 
 /**
  * Create a base64 codec instance
+ *
+ * When the stack is initialised the codec asks the inner transports to
+ * accept binary data. If the modem transport is using UDP it does, and the
+ * codec becomes a pass-through; the base64 encoding is only used when the
+ * modem transport needs it for USSD.
+ *
  * @param inner the #ThingstreamTransport instance the codec should wrap
  * @return the new #ThingstreamTransport instance
  */
 extern ThingstreamTransport* Thingstream_createBase64CodecTransport(ThingstreamTransport* inner);
 
+/**
+ * Return whether the codec has been bypassed because the inner transports
+ * accept binary data. This is only meaningful once the stack has been
+ * initialised.
+ *
+ * @param self this instance of base64 codec transport
+ * @return true if data is passed through without base64 encoding
+ */
+extern bool Thingstream_Base64Codec_isBypassed(ThingstreamTransport* self);
+
+/**
+ * Initialise the inner transport of a text codec transport (base64 or
+ * base85). In a client stack the inner transports are first offered binary
+ * data, and the codec is bypassed if they accept it; otherwise they are
+ * told that the data is text.
+ *
+ * @param inner the inner transport, with the codec's callback registered
+ * @param version the version passed to the codec's init
+ * @param callback the callback registered by the codec's outer transport,
+ *   registered with the inner transport if the codec is bypassed
+ * @param cookie the cookie for the callback
+ * @param bypass set to true if the codec is bypassed
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+extern ThingstreamTransportResult Thingstream_Base64Codec_initInner(ThingstreamTransport* inner, uint16_t version, ThingstreamTransportCallback_t callback, void* cookie, bool* bypass);
+
 #if defined(__cplusplus)
 }
 #endif
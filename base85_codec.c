@@ -0,0 +1,173 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Bulk conversion of binary data to and from base85 text
+ *
+ * Each group of 4 bytes is read as a big-endian 32-bit word and written as
+ * 5 base 85 digits, most significant first. A final group of n bytes is
+ * padded with zero bytes and only its first n+1 digits are written; the
+ * decoder pads them with the largest digit and keeps n bytes, as Ascii85
+ * does.
+ *
+ * The 85 characters are those that are the same in ASCII and the GSM 7-bit
+ * default alphabet, less '"' and space (which a USSD gateway may trim from
+ * the end of the text), plus '$', '@' and '_' which are in both at
+ * different code points and are translated by the modem, and '|' which is
+ * in the GSM extension table and takes two septets.
+ */
+
+#include <stddef.h>
+
+#include "base85_codec.h"
+
+/** The base85 alphabet, in digit order */
+static const char alphabet[85] =
+    "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"
+    "!#$%&'()*+,-./:;<=>?@_|";
+
+/** A decodeTable entry for a character that is not in the alphabet */
+#define INVALID         0x80
+
+/** The value of each ASCII character, or INVALID */
+static const uint8_t decodeTable[128] = {
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x3e, 0x80, 0x3f, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x4b,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x4c, 0x4d, 0x4e, 0x4f, 0x50, 0x51,
+    0x52, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18,
+    0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x80, 0x80, 0x80, 0x80, 0x53,
+    0x80, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32,
+    0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x80, 0x54, 0x80, 0x80, 0x80,
+};
+
+/**
+ * Write the first count base 85 digits of a 32-bit word.
+ */
+static inline char* encodeWord(char* buf, uint32_t w, uint8_t count)
+{
+    char digits[5];
+    int8_t i;
+    for (i = 4; i >= 0; --i)
+    {
+        digits[i] = alphabet[w % 85];
+        w /= 85;
+    }
+    for (i = 0; i < (int8_t)count; ++i)
+    {
+        *buf++ = digits[i];
+    }
+    return buf;
+}
+
+/**
+ * Read count base 85 digits, padded with the largest digit, as a 32-bit
+ * word. Bit 7 of *pBad is set if a character is not in the alphabet or the
+ * value does not fit in 32 bits.
+ */
+static inline uint32_t decodeWord(const uint8_t* in, uint8_t count, uint32_t* pBad)
+{
+    uint32_t w = 0;
+    uint8_t i;
+    for (i = 0; i < 4; ++i)
+    {
+        uint32_t c = (i < count) ? in[i] : alphabet[84];
+        uint32_t d = decodeTable[c & 0x7f] | (c & 0x80);
+        *pBad |= d;
+        w = w * 85 + (d & 0x7f);
+    }
+    uint32_t c = (count == 5) ? in[4] : alphabet[84];
+    uint32_t d = decodeTable[c & 0x7f] | (c & 0x80);
+    *pBad |= d;
+    d &= 0x7f;
+    if (w > (UINT32_MAX - d) / 85)
+    {
+        *pBad |= INVALID;
+    }
+    return w * 85 + d;
+}
+
+
+char *Thingstream_Base85_encode(char *buf, const uint8_t *data, uint16_t len)
+{
+    /* Each group is loaded before its output is stored, so in place
+     * encoding is safe while the data is one byte per group ahead.
+     */
+    while (len >= 4)
+    {
+        uint32_t w = ((uint32_t)data[0] << 24)
+                   | ((uint32_t)data[1] << 16)
+                   | ((uint32_t)data[2] << 8)
+                   | (uint32_t)data[3];
+        buf = encodeWord(buf, w, 5);
+        data += 4;
+        len -= 4;
+    }
+    if (len > 0)
+    {
+        uint32_t w = (uint32_t)data[0] << 24;
+        if (len > 1)
+        {
+            w |= (uint32_t)data[1] << 16;
+        }
+        if (len > 2)
+        {
+            w |= (uint32_t)data[2] << 8;
+        }
+        buf = encodeWord(buf, w, (uint8_t)(len + 1));
+    }
+    return buf;
+}
+
+
+int32_t Thingstream_Base85_decode(uint8_t *buf, const char *text, uint16_t textLen)
+{
+    const uint8_t* in = (const uint8_t*)text;
+    uint8_t* out = buf;
+    uint32_t bad = 0;
+
+    if ((textLen % 5) == 1)
+    {
+        return -1;
+    }
+    while (textLen > 0)
+    {
+        uint8_t count = (textLen >= 5) ? 5 : (uint8_t)textLen;
+        uint32_t w = decodeWord(in, count, &bad);
+        out[0] = (uint8_t)(w >> 24);
+        if (count > 2)
+        {
+            out[1] = (uint8_t)(w >> 16);
+        }
+        if (count > 3)
+        {
+            out[2] = (uint8_t)(w >> 8);
+        }
+        if (count > 4)
+        {
+            out[3] = (uint8_t)w;
+        }
+        in += count;
+        out += count - 1;
+        textLen -= count;
+    }
+    if ((bad & INVALID) != 0)
+    {
+        return -1;
+    }
+    return (int32_t)(out - buf);
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Bulk conversion of binary data to and from base85 text
+ *
+ * Each 4-byte group is converted to 5 characters (a final group of 1 to 3
+ * bytes to one more character than it has bytes), compared with 4 per 3
+ * bytes for base64. The alphabet only has characters of the GSM 7-bit
+ * alphabet, excluding '"' so that the text can be quoted in AT commands
+ * and space so that it cannot be trimmed. One character, '|', is in the
+ * extension table and takes two septets.
+ */
+
+#ifndef INC_BASE85_CODEC_H
+#define INC_BASE85_CODEC_H
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * The length of the base85 text for binary data of the given length.
+ * @hideinitializer
+ */
+#define BASE85_ENCODED_LEN(len) ((len) + ((len) + 3) / 4)
+
+/**
+ * The largest length of binary data whose base85 text fits in the given
+ * length.
+ * @hideinitializer
+ */
+#define BASE85_DECODED_LEN(textLen) (((textLen) * 4) / 5)
+
+/**
+ * Convert binary data to base85 text.
+ * Note that the result is not 0-terminated.
+ * The conversion may be done in place if the data is at the end of the
+ * buffer, i.e. data is at buf + BASE85_ENCODED_LEN(len) - len or later.
+ * @param buf buffer to receive the text, at least BASE85_ENCODED_LEN(len)
+ *    bytes
+ * @param data the binary data
+ * @param len the length of the binary data
+ * @return a pointer to just after the last byte of the conversion.
+ */
+extern char *Thingstream_Base85_encode(char *buf, const uint8_t *data, uint16_t len);
+
+/**
+ * Convert base85 text to binary data.
+ * The conversion may be done in place by passing the same address as buf
+ * and text.
+ * @param buf buffer to receive the binary data, at least
+ *    BASE85_DECODED_LEN(textLen) bytes
+ * @param text the base85 text
+ * @param textLen the length of the base85 text
+ * @return the length of the binary data, or -1 if the text contains a
+ *    character that is not in the alphabet, a group that is too large or
+ *    a final group of a single character.
+ */
+extern int32_t Thingstream_Base85_decode(uint8_t *buf, const char *text, uint16_t textLen);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_BASE85_CODEC_H */
@@ -0,0 +1,301 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Base85 codec implemented as a ThingstreamTransport instance
+ *
+ * This is a debug option that forces base85 encoding, nothing is
+ * negotiated with the gateway. Outbound packets are always sent as
+ * #BASE85_CODEC_MARKER followed by the base85 text, built in place in the
+ * inner transport's buffer as in the base64 codec transport. Inbound packets are decoded in place, from base85 if
+ * they start with the marker and from base64 otherwise.
+ *
+ * When the modem transport is using a binary-clean bearer the codec is
+ * bypassed and every call is passed straight to the inner transport.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "base85_codec_transport.h"
+#include "base64_codec_transport.h"
+#include "base85_codec.h"
+#include "base64_codec.h"
+
+/**
+ * The Base85CodecState structure is used to store state for the base85
+ * codec transport.
+ */
+typedef struct Base85CodecState_s
+{
+    /** The inner transport */
+    ThingstreamTransport* inner;
+    /** The callback registered by the outer transport */
+    ThingstreamTransportCallback_t callback;
+    /** Cookie associated with the registered callback */
+    void* cookie;
+    /** The buffer of the inner transport */
+    uint8_t* buf;
+    /** The length of the buffer of the inner transport */
+    uint16_t len;
+    /** The inner transport accepts binary data so there is no encoding */
+    bool bypass;
+} Base85CodecState;
+
+/** Instance of Base85CodecState */
+static Base85CodecState _base85_codec_transport_state;
+
+static ThingstreamTransportResult base85_codec_init(ThingstreamTransport* self, uint16_t version);
+static ThingstreamTransportResult base85_codec_shutdown(ThingstreamTransport* self);
+static ThingstreamTransportResult base85_codec_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len);
+static ThingstreamTransportResult base85_codec_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis);
+static ThingstreamTransportResult base85_codec_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie);
+static ThingstreamTransportResult base85_codec_run(ThingstreamTransport* self, uint32_t millis);
+
+/** Instance of ThingstreamTransport for the base85 codec transport */
+static const ThingstreamTransport _base85_codec_transport_instance = {
+    (ThingstreamTransportState_t*)&_base85_codec_transport_state,
+    base85_codec_init,
+    base85_codec_shutdown,
+    base85_codec_get_buffer,
+    NULL, /* This slot no longer used */
+    base85_codec_send,
+    base85_codec_register_callback,
+    NULL, /* This slot no longer used */
+    base85_codec_run
+};
+
+
+ThingstreamTransport* Thingstream_createForcedBase85CodecTransport(ThingstreamTransport* inner)
+{
+    ThingstreamTransport* self = (ThingstreamTransport*)&_base85_codec_transport_instance;
+    Base85CodecState* state = (Base85CodecState*)self->_state;
+
+    if (inner == NULL)
+    {
+        return NULL;
+    }
+    memset(state, 0, sizeof(*state));
+    state->inner = inner;
+    return self;
+}
+
+
+bool Thingstream_Base85Codec_isBypassed(ThingstreamTransport* self)
+{
+    Base85CodecState* state = (Base85CodecState*)self->_state;
+    return state->bypass;
+}
+
+
+/**
+ * Decode the inbound packet in place and pass it to the outer transport.
+ * Packets that are not valid base85 or base64 are dropped.
+ *
+ * @param cookie the base85 codec state
+ * @param data a pointer to the data
+ * @param len the length of the data
+ */
+static void base85_codec_callback(void* cookie, uint8_t* data, uint16_t len)
+{
+    Base85CodecState* state = (Base85CodecState*)cookie;
+    int32_t outLen;
+
+    if (len == 0)
+    {
+        return;
+    }
+    if (data[0] == BASE85_CODEC_MARKER)
+    {
+        outLen = Thingstream_Base85_decode(data, (const char*)data + 1, (uint16_t)(len - 1));
+    }
+    else
+    {
+        outLen = Thingstream_Base64_decode(data, (const char*)data, len);
+    }
+    if ((outLen >= 0) && (state->callback != NULL))
+    {
+        state->callback(state->cookie, data, (uint16_t)outLen);
+    }
+}
+
+/**
+ * Initialize the transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param version the transport API version
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult base85_codec_init(ThingstreamTransport* self, uint16_t version)
+{
+    Base85CodecState* state = (Base85CodecState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+
+    if (!TRANSPORT_CHECK_VERSION_1(version))
+    {
+        return TRANSPORT_VERSION_MISMATCH;
+    }
+    state->buf = NULL;
+    state->len = 0;
+    state->bypass = false;
+
+    ThingstreamTransportResult tRes;
+    tRes = inner->register_callback(inner, base85_codec_callback, state);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return tRes;
+    }
+    return Thingstream_Base64Codec_initInner(inner, version, state->callback,
+                                             state->cookie, &state->bypass);
+}
+
+/**
+ * Shutdown the transport (i.e. the opposite of initialize).
+ *
+ * @param self the #ThingstreamTransport instance
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult base85_codec_shutdown(ThingstreamTransport* self)
+{
+    Base85CodecState* state = (Base85CodecState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    return inner->shutdown(inner);
+}
+
+/**
+ * Return the tail of the inner transport's buffer, large enough for the
+ * raw data whose marker and base85 encoding fill the whole buffer, or the whole
+ * buffer when the codec is bypassed.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param buffer where to write the buffer pointer
+ * @param len where the write the buffer length
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult base85_codec_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len)
+{
+    Base85CodecState* state = (Base85CodecState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    ThingstreamTransportResult tRes;
+    uint16_t rawLen;
+
+    if (inner->get_buffer == NULL)
+    {
+        return TRANSPORT_ERROR;
+    }
+    if (state->bypass)
+    {
+        return inner->get_buffer(inner, buffer, len);
+    }
+    tRes = inner->get_buffer(inner, &state->buf, &state->len);
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        rawLen = (state->len > 0) ? (uint16_t)BASE85_DECODED_LEN(state->len - 1u) : 0;
+        *buffer = state->buf + state->len - rawLen;
+        *len = rawLen;
+    }
+    return tRes;
+}
+
+/**
+ * Encode the data into the inner transport's buffer and send it, or send
+ * it unchanged when the codec is bypassed.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param flags an indication of the type of the data, zero is normal.
+ * @param data a pointer to the data
+ * @param len the length of the raw data
+ * @param millis the maximum number of milliseconds to run
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult base85_codec_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis)
+{
+    Base85CodecState* state = (Base85CodecState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    uint32_t encodedLen = 1 + BASE85_ENCODED_LEN((uint32_t)len);
+
+    if (state->bypass)
+    {
+        return inner->send(inner, flags, data, len, millis);
+    }
+    if (state->buf == NULL)
+    {
+        if ((inner->get_buffer == NULL)
+            || (inner->get_buffer(inner, &state->buf, &state->len) != TRANSPORT_SUCCESS))
+        {
+            return TRANSPORT_ERROR;
+        }
+    }
+    if (encodedLen > state->len)
+    {
+        return TRANSPORT_ILLEGAL_ARGUMENT;
+    }
+
+    /* Data in the buffer is normally at the tail, from get_buffer(). Data
+     * elsewhere in the buffer is moved to the tail so that the output of
+     * the in place conversion cannot overtake it.
+     */
+    if ((data >= state->buf) && (data < state->buf + state->len)
+        && (data < state->buf + encodedLen - len))
+    {
+        uint8_t* tail = state->buf + state->len - len;
+        memmove(tail, data, len);
+        data = tail;
+    }
+    state->buf[0] = BASE85_CODEC_MARKER;
+    (void)Thingstream_Base85_encode((char*)state->buf + 1, data, len);
+    return inner->send(inner, flags, state->buf, (uint16_t)encodedLen, millis);
+}
+
+/**
+ * Register a callback function that will be called when this transport
+ * has data to send to its next outermost ThingstreamTransport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param callback the callback function
+ * @param cookie a opaque value passed to the callback function
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult base85_codec_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie)
+{
+    Base85CodecState* state = (Base85CodecState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    state->callback = callback;
+    state->cookie = cookie;
+    if (state->bypass)
+    {
+        return inner->register_callback(inner, callback, cookie);
+    }
+    return TRANSPORT_SUCCESS;
+}
+
+/**
+ * Allow the inner transport to run for at most the given number of
+ * milliseconds.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param millis the maximum number of milliseconds to run (a value of zero
+ *        processes all pending operations).
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult base85_codec_run(ThingstreamTransport* self, uint32_t millis)
+{
+    Base85CodecState* state = (Base85CodecState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    return inner->run(inner, millis);
+}
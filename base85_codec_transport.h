@@ -0,0 +1,75 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Base85 codec implemented as a ThingstreamTransport instance
+ */
+
+#ifndef INC_BASE85_CODEC_TRANSPORT_H_
+#define INC_BASE85_CODEC_TRANSPORT_H_
+
+#include <stdbool.h>
+#include "transport_api.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * The first character of a base85 packet, which is not in the base64
+ * alphabet.
+ */
+#define BASE85_CODEC_MARKER '!'
+
+/**
+ * Create a base85 codec instance that forces base85 encoding. This is a
+ * debug option for trying the denser encoding against a gateway known to
+ * accept it: it may be used in place of the base64 codec transport to fit
+ * 4 bytes in 5 characters rather than 3 in 4, e.g. 115 rather than 108
+ * bytes in a #THINGSTREAM_USSD_BUFFER_LEN USSD frame. About one character
+ * in 85 is '|', which takes two septets on air.
+ *
+ * Nothing is negotiated with the gateway and there is no fallback: every
+ * outbound packet is #BASE85_CODEC_MARKER followed by base85 text, and a
+ * gateway that does not accept base85 will drop them all. Inbound packets
+ * may be base85 (with the marker) or base64.
+ *
+ * As with the base64 codec, if the modem transport is using UDP when the
+ * stack is initialised the codec becomes a pass-through.
+ *
+ * @param inner the #ThingstreamTransport instance the codec should wrap
+ * @return the new #ThingstreamTransport instance
+ */
+extern ThingstreamTransport* Thingstream_createForcedBase85CodecTransport(ThingstreamTransport* inner);
+
+/**
+ * Return whether the codec has been bypassed because the inner transports
+ * accept binary data. This is only meaningful once the stack has been
+ * initialised.
+ *
+ * @param self this instance of base85 codec transport
+ * @return true if data is passed through without base85 encoding
+ */
+extern bool Thingstream_Base85Codec_isBypassed(ThingstreamTransport* self);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_BASE85_CODEC_TRANSPORT_H_ */
@@ -0,0 +1,247 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Streaming of long messages as a sequence of chunk messages
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "client_stream.h"
+
+/** The id of the next stream to be published */
+static uint8_t nextStreamId;
+
+/**
+ * The StreamReceiverState structure is used to store the state of the
+ * stream being received.
+ */
+typedef struct StreamReceiverState_s
+{
+    /** The routine given the data, or NULL */
+    ThingstreamStreamReceiver_t receiver;
+    /** Cookie passed to the receiver */
+    void* cookie;
+    /** The topic that carries the streams */
+    ThingstreamTopic topic;
+    /** A stream is being received */
+    bool receiving;
+    /** The id of the stream being received */
+    uint8_t id;
+    /** The offset of the next chunk expected */
+    uint32_t expected;
+    /** The length of the stream, or 0 if it is not known */
+    uint32_t total;
+} StreamReceiverState;
+
+/** Instance of StreamReceiverState */
+static StreamReceiverState _stream_receiver_state;
+
+/**
+ * Write a 24-bit big-endian value.
+ */
+static void put24(uint8_t* p, uint32_t value)
+{
+    p[0] = (uint8_t)(value >> 16);
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)value;
+}
+
+/**
+ * Read a 24-bit big-endian value.
+ */
+static uint32_t get24(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+}
+
+/**
+ * Publish one chunk whose data is already in the buffer after the header.
+ */
+static ThingstreamClientResult publishChunk(ThingstreamClient* client, ThingstreamTopic topic, ThingstreamQualityOfService_t qos, uint8_t flags, uint32_t offset, uint32_t len, uint8_t* buffer, uint16_t chunkLen)
+{
+    buffer[0] = flags;
+    put24(&buffer[1], offset);
+    put24(&buffer[4], len);
+    return Thingstream_Client_publish(client, topic, qos, false, buffer,
+                                      (uint16_t)(CLIENT_STREAM_HEADER_LEN + chunkLen));
+}
+
+ThingstreamClientResult Thingstream_ClientStream_publish(ThingstreamClient* client, ThingstreamTopic topic, ThingstreamQualityOfService_t qos, ThingstreamStreamReader_t reader, void* cookie, uint32_t len, uint8_t* buffer, uint16_t bufSize)
+{
+    ThingstreamClientResult cr = CLIENT_SUCCESS;
+    uint16_t chunkMax;
+    uint32_t offset = 0;
+    uint8_t flags;
+    bool last = false;
+
+    if ((reader == NULL) || (buffer == NULL)
+        || (bufSize <= CLIENT_STREAM_HEADER_LEN) || (len > CLIENT_STREAM_MAX_LEN))
+    {
+        return CLIENT_ILLEGAL_ARGUMENT;
+    }
+    chunkMax = (uint16_t)(bufSize - CLIENT_STREAM_HEADER_LEN);
+    flags = CLIENT_STREAM_FIRST | (nextStreamId & CLIENT_STREAM_ID_MASK);
+    nextStreamId++;
+
+    while (!last)
+    {
+        uint16_t want = chunkMax;
+        int32_t got = 0;
+
+        if ((len != 0) && (len - offset < want))
+        {
+            want = (uint16_t)(len - offset);
+        }
+        if (want > 0)
+        {
+            got = reader(cookie, &buffer[CLIENT_STREAM_HEADER_LEN], want);
+        }
+
+        /* With a known length the stream ends when it has all been read,
+         * otherwise when the reader has no more.
+         */
+        if ((got < 0) || (got > want)
+            || ((len != 0) && (got == 0) && (offset < len))
+            || (offset + (uint32_t)got > CLIENT_STREAM_MAX_LEN))
+        {
+            flags |= CLIENT_STREAM_LAST | CLIENT_STREAM_ABORT;
+            (void)publishChunk(client, topic, qos, flags, offset, len, buffer, 0);
+            return CLIENT_INFORMATION_NOT_AVAILABLE;
+        }
+        if ((len != 0) ? (offset + (uint32_t)got == len) : (got == 0))
+        {
+            flags |= CLIENT_STREAM_LAST;
+            last = true;
+        }
+
+        cr = publishChunk(client, topic, qos, flags, offset, len, buffer, (uint16_t)got);
+        if (cr != CLIENT_SUCCESS)
+        {
+            return cr;
+        }
+        offset += (uint32_t)got;
+        flags &= (uint8_t)~CLIENT_STREAM_FIRST;
+    }
+    return cr;
+}
+
+
+/**
+ * Tell the receiver that the stream in progress is abandoned.
+ */
+static void abortReceive(StreamReceiverState* state)
+{
+    state->receiving = false;
+    state->receiver(state->cookie, CLIENT_STREAM_LAST | CLIENT_STREAM_ABORT,
+                    state->expected, state->total, NULL, 0);
+}
+
+void Thingstream_ClientStream_setReceiver(ThingstreamTopic topic, ThingstreamStreamReceiver_t receiver, void* cookie)
+{
+    StreamReceiverState* state = &_stream_receiver_state;
+
+    if (state->receiving)
+    {
+        abortReceive(state);
+    }
+    state->receiver = receiver;
+    state->cookie = cookie;
+    state->topic = topic;
+}
+
+bool Thingstream_ClientStream_deliver(ThingstreamTopic topic, ThingstreamQualityOfService_t qos, const uint8_t* payload, uint16_t payloadlen)
+{
+    StreamReceiverState* state = &_stream_receiver_state;
+    uint8_t flags;
+    uint8_t id;
+    uint32_t offset;
+    uint32_t total;
+    uint16_t len;
+
+    (void)qos;
+    if ((state->receiver == NULL)
+        || (topic.topicType != state->topic.topicType)
+        || (topic.topicId != state->topic.topicId))
+    {
+        return false;
+    }
+    if (payloadlen < CLIENT_STREAM_HEADER_LEN)
+    {
+        return true;
+    }
+    flags = payload[0] & (CLIENT_STREAM_FIRST | CLIENT_STREAM_LAST | CLIENT_STREAM_ABORT);
+    id = payload[0] & CLIENT_STREAM_ID_MASK;
+    offset = get24(&payload[1]);
+    total = get24(&payload[4]);
+    len = (uint16_t)(payloadlen - CLIENT_STREAM_HEADER_LEN);
+
+    if (state->receiving && (id == state->id))
+    {
+        /* A chunk that has already been passed on is a duplicate */
+        if ((offset < state->expected) && (offset + len <= state->expected))
+        {
+            return true;
+        }
+    }
+    else if ((flags & CLIENT_STREAM_FIRST) == 0)
+    {
+        /* The end of a stream whose start was missed, or the start of the
+         * next stream was missed; drop the chunks until the next one
+         * starts.
+         */
+        if (state->receiving)
+        {
+            abortReceive(state);
+        }
+        return true;
+    }
+
+    if (flags & CLIENT_STREAM_FIRST)
+    {
+        if (state->receiving)
+        {
+            abortReceive(state);
+        }
+        if ((offset != 0) || (flags & CLIENT_STREAM_ABORT))
+        {
+            return true;
+        }
+        state->receiving = true;
+        state->id = id;
+        state->expected = 0;
+        state->total = total;
+    }
+
+    if ((flags & CLIENT_STREAM_ABORT) || (offset != state->expected)
+        || ((state->total != 0)
+            && ((offset + len > state->total)
+                || ((flags & CLIENT_STREAM_LAST) && (offset + len != state->total)))))
+    {
+        abortReceive(state);
+        return true;
+    }
+    state->expected += len;
+    if (flags & CLIENT_STREAM_LAST)
+    {
+        state->receiving = false;
+    }
+    state->receiver(state->cookie, flags, offset, state->total,
+                    &payload[CLIENT_STREAM_HEADER_LEN], len);
+    return true;
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Streaming of long messages as a sequence of chunk publishes
+ *
+ * A long message given to Thingstream_Client_publish() must be held whole,
+ * and the protocol transport needs a buffer that holds all of it to
+ * fragment it. A stream is instead published as a sequence of messages
+ * (chunks) that each fit in one datagram, read from the application as
+ * they are sent, so that only one chunk is held at a time.
+ *
+ * Each chunk starts with a #CLIENT_STREAM_HEADER_LEN byte header:
+ *  - byte 0: #CLIENT_STREAM_FIRST, #CLIENT_STREAM_LAST and
+ *    #CLIENT_STREAM_ABORT flags, and a 5-bit stream id in the low bits
+ *  - bytes 1 to 3: the offset of the chunk in the stream (big-endian)
+ *  - bytes 4 to 6: the length of the stream (big-endian), or 0 if it was
+ *    not known when the stream started
+ *
+ * The receiver (e.g. a gateway) joins the chunks with the same stream id
+ * in offset order.
+ *
+ * Streams sent to the device in the same form can be received a chunk at a
+ * time: Thingstream_ClientStream_setReceiver() names the topic that
+ * carries them, and Thingstream_Application_subscribeCallback() passes
+ * each message to Thingstream_ClientStream_deliver(). The data is then
+ * given to the receiver as each chunk arrives, so a large message (e.g. a
+ * firmware image written to flash) never has to be held whole.
+ */
+
+#ifndef INC_CLIENT_STREAM_H
+#define INC_CLIENT_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "client_api.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * The length of the header at the start of each chunk.
+ * @hideinitializer
+ */
+#define CLIENT_STREAM_HEADER_LEN 7
+
+/**
+ * The longest stream.
+ * @hideinitializer
+ */
+#define CLIENT_STREAM_MAX_LEN 0xFFFFFFu
+
+/**
+ * @name Chunk flags
+ * The flags in byte 0 of the chunk header.
+ * @{
+ */
+/** The chunk is the first of the stream */
+#define CLIENT_STREAM_FIRST     0x80
+/** The chunk is the last of the stream */
+#define CLIENT_STREAM_LAST      0x40
+/** The stream was abandoned, the chunk is empty and is also the last */
+#define CLIENT_STREAM_ABORT     0x20
+/** The mask of the stream id */
+#define CLIENT_STREAM_ID_MASK   0x1F
+/** @} */
+
+/**
+ * Type of the routine that supplies the data of a stream.
+ *
+ * @param cookie the cookie passed to Thingstream_ClientStream_publish()
+ * @param buf where to write the next data of the stream
+ * @param len the most data to write
+ * @return the length of the data written (less than len only at the end of
+ *   the stream), 0 at the end of the stream, or -1 on error
+ */
+typedef int32_t (*ThingstreamStreamReader_t)(void* cookie, uint8_t* buf, uint16_t len);
+
+/**
+ * Publish a stream read from the application, one chunk at a time.
+ *
+ * Each chunk is published with Thingstream_Client_publish(), so it is
+ * sent before the next is read (and at QoS 1 acknowledged). The buffer
+ * holds one chunk including its header, so it should be no larger than
+ * the largest publish that is sent in one datagram.
+ *
+ * If the length of the stream is not known in advance (len is 0) the data
+ * is read until the reader returns 0, and an empty last chunk is
+ * published. If the reader fails, or ends before the given length, an
+ * empty chunk with #CLIENT_STREAM_ABORT is published so that the receiver
+ * can discard what it has.
+ *
+ * @param client the client instance
+ * @param topic the topic to publish to
+ * @param qos the quality of service of each chunk
+ * @param reader the routine that supplies the data
+ * @param cookie an opaque value passed to the reader
+ * @param len the length of the stream, or 0 if it is not known
+ * @param buffer the buffer for one chunk
+ * @param bufSize the size of the buffer, more than
+ *   #CLIENT_STREAM_HEADER_LEN
+ * @return #CLIENT_SUCCESS if the whole stream was published,
+ *   #CLIENT_INFORMATION_NOT_AVAILABLE if the reader failed, else the
+ *   result of the Thingstream_Client_publish() that failed
+ */
+extern ThingstreamClientResult Thingstream_ClientStream_publish(ThingstreamClient* client, ThingstreamTopic topic, ThingstreamQualityOfService_t qos, ThingstreamStreamReader_t reader, void* cookie, uint32_t len, uint8_t* buffer, uint16_t bufSize);
+
+/**
+ * Type of the routine that is given the data of a received stream.
+ *
+ * Each chunk is passed on in order, with #CLIENT_STREAM_FIRST set on the
+ * first and #CLIENT_STREAM_LAST on the last. If the stream is abandoned,
+ * by the sender or because a chunk was lost, the routine is called once
+ * with #CLIENT_STREAM_ABORT and #CLIENT_STREAM_LAST and no data, and
+ * whatever was received should be discarded.
+ *
+ * @param cookie the cookie passed to Thingstream_ClientStream_setReceiver()
+ * @param flags the #CLIENT_STREAM_FIRST, #CLIENT_STREAM_LAST and
+ *   #CLIENT_STREAM_ABORT flags
+ * @param offset the offset of the data in the stream
+ * @param total the length of the stream, or 0 if it is not known
+ * @param data the data of the chunk
+ * @param len the length of the data, possibly 0
+ */
+typedef void (*ThingstreamStreamReceiver_t)(void* cookie, uint8_t flags, uint32_t offset, uint32_t total, const uint8_t* data, uint16_t len);
+
+/**
+ * Set the routine that is given the streams received on a topic.
+ * Any stream in progress is abandoned.
+ *
+ * @param topic the topic that carries the streams
+ * @param receiver the routine to be given the data, or NULL to stop
+ *   receiving streams
+ * @param cookie an opaque value passed to the receiver
+ */
+extern void Thingstream_ClientStream_setReceiver(ThingstreamTopic topic, ThingstreamStreamReceiver_t receiver, void* cookie);
+
+/**
+ * Pass a received message to the stream receiver.
+ * This is intended to be called first from
+ * Thingstream_Application_subscribeCallback(), which should do nothing
+ * more with the message if it returns true.
+ *
+ * A repeated chunk (e.g. a QoS 1 duplicate) is ignored, and a chunk that
+ * does not follow the last one received abandons the stream.
+ *
+ * @param topic the topic of the message
+ * @param qos the quality of service of the message
+ * @param payload the payload of the message
+ * @param payloadlen the length of the payload
+ * @return true if the message was on the stream topic (whether or not it
+ *   was a valid chunk), false if it is for the application
+ */
+extern bool Thingstream_ClientStream_deliver(ThingstreamTopic topic, ThingstreamQualityOfService_t qos, const uint8_t* payload, uint16_t payloadlen);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_CLIENT_STREAM_H */
@@ -0,0 +1,1055 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief 3GPP TS 27.010 multiplexer (basic option)
+ *
+ * Each frame is F9 address control length info FCS F9. The FCS of UIH
+ * frames covers the address, control and length; for other frames it
+ * also covers the info field. The FCS is the ones complement of a
+ * reflected CRC-8 (polynomial x^8 + x^2 + x + 1), calculated one byte at a
+ * time from crcTable.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "cmux_transport.h"
+#include "modem_transport.h"
+#include "client_platform.h"
+#include "thingstream_util.h"
+
+/** The flag that starts and ends each frame */
+#define CMUX_FLAG           0xF9
+
+/** The extension bit of the address and length fields */
+#define CMUX_EA             0x01
+
+/** The command/response bit of the address field */
+#define CMUX_CR             0x02
+
+/** The poll/final bit of the control field */
+#define CMUX_PF             0x10
+
+/** Control field values, without the poll/final bit */
+#define CMUX_SABM           0x2F
+#define CMUX_UA             0x63
+#define CMUX_DM             0x0F
+#define CMUX_DISC           0x43
+#define CMUX_UIH            0xEF
+
+/** Multiplexer control channel message types (command bit set) */
+#define CMUX_MSG_CLD        0xC3
+#define CMUX_MSG_MSC        0xE3
+
+/** V.24 signals sent in MSC: RTC, RTR and DV set */
+#define CMUX_V24_SIGNALS    0x8D
+
+/** The multiplexer control channel */
+#define DLCI_MUX            0
+/** The channel carrying the modem transport's traffic */
+#define DLCI_DATA           1
+/** The channel used by Thingstream_Cmux_sendLine() */
+#define DLCI_CONTROL        2
+
+/** The space needed for a frame header and trailer */
+#define FRAME_OVERHEAD      7
+
+/** The space to send one frame */
+#define TX_LEN              (CMUX_FRAME_SIZE + FRAME_OVERHEAD)
+
+/** The longest line collected from the control channel */
+#define CONTROL_LINE_LEN    64
+
+/** The longest reply to a multiplexer control message */
+#define MUX_REPLY_LEN       8
+
+/** The time to wait for the reply to AT+CMUX */
+#define CMUX_AT_REPLY_MS    2000
+
+/** The time to wait for the modem to switch after AT+CMUX */
+#define CMUX_SWITCH_MS      100
+
+/** The time to wait for UA after each SABM */
+#define CMUX_SABM_REPLY_MS  1000
+
+/** The number of times each SABM is sent */
+#define CMUX_SABM_TRIES     3
+
+/** The time allowed to start the multiplexer */
+#define CMUX_START_MS       (CMUX_AT_REPLY_MS + CMUX_SWITCH_MS \
+                             + CMUX_SABM_TRIES * CMUX_SABM_REPLY_MS * 3)
+
+/** The time to wait before trying again after a failed restart, doubled
+ * after each further failure up to #CMUX_RESTART_MAX_MS */
+#define CMUX_RESTART_MIN_MS 5000
+
+/** The longest time to wait before trying again after a failed restart */
+#define CMUX_RESTART_MAX_MS 60000
+
+#define CMUX_STR(x)         #x
+#define CMUX_XSTR(x)        CMUX_STR(x)
+
+/** The command to start the multiplexer, basic option, UIH frames */
+static const char cmuxCommand[] = "AT+CMUX=0,0,," CMUX_XSTR(CMUX_FRAME_SIZE) "\r";
+
+/**
+ * The commands that reset the modem, which then leaves multiplexer mode.
+ * The first line of Thingstream_Modem_forceResetString is also checked.
+ */
+static const char* const resetCommands[] = {
+    "AT+CFUN=1,1",
+    "AT+CFUN=15",
+    "AT+CFUN=16",
+};
+
+#define RESET_COMMANDS (sizeof(resetCommands) / sizeof(resetCommands[0]))
+
+/** CRC table for the FCS (reflected polynomial 0xE0) */
+static const uint8_t crcTable[256] = {
+    0x00,0x91,0xE3,0x72,0x07,0x96,0xE4,0x75, 0x0E,0x9F,0xED,0x7C,0x09,0x98,0xEA,0x7B,
+    0x1C,0x8D,0xFF,0x6E,0x1B,0x8A,0xF8,0x69, 0x12,0x83,0xF1,0x60,0x15,0x84,0xF6,0x67,
+    0x38,0xA9,0xDB,0x4A,0x3F,0xAE,0xDC,0x4D, 0x36,0xA7,0xD5,0x44,0x31,0xA0,0xD2,0x43,
+    0x24,0xB5,0xC7,0x56,0x23,0xB2,0xC0,0x51, 0x2A,0xBB,0xC9,0x58,0x2D,0xBC,0xCE,0x5F,
+    0x70,0xE1,0x93,0x02,0x77,0xE6,0x94,0x05, 0x7E,0xEF,0x9D,0x0C,0x79,0xE8,0x9A,0x0B,
+    0x6C,0xFD,0x8F,0x1E,0x6B,0xFA,0x88,0x19, 0x62,0xF3,0x81,0x10,0x65,0xF4,0x86,0x17,
+    0x48,0xD9,0xAB,0x3A,0x4F,0xDE,0xAC,0x3D, 0x46,0xD7,0xA5,0x34,0x41,0xD0,0xA2,0x33,
+    0x54,0xC5,0xB7,0x26,0x53,0xC2,0xB0,0x21, 0x5A,0xCB,0xB9,0x28,0x5D,0xCC,0xBE,0x2F,
+    0xE0,0x71,0x03,0x92,0xE7,0x76,0x04,0x95, 0xEE,0x7F,0x0D,0x9C,0xE9,0x78,0x0A,0x9B,
+    0xFC,0x6D,0x1F,0x8E,0xFB,0x6A,0x18,0x89, 0xF2,0x63,0x11,0x80,0xF5,0x64,0x16,0x87,
+    0xD8,0x49,0x3B,0xAA,0xDF,0x4E,0x3C,0xAD, 0xD6,0x47,0x35,0xA4,0xD1,0x40,0x32,0xA3,
+    0xC4,0x55,0x27,0xB6,0xC3,0x52,0x20,0xB1, 0xCA,0x5B,0x29,0xB8,0xCD,0x5C,0x2E,0xBF,
+    0x90,0x01,0x73,0xE2,0x97,0x06,0x74,0xE5, 0x9E,0x0F,0x7D,0xEC,0x99,0x08,0x7A,0xEB,
+    0x8C,0x1D,0x6F,0xFE,0x8B,0x1A,0x68,0xF9, 0x82,0x13,0x61,0xF0,0x85,0x14,0x66,0xF7,
+    0xA8,0x39,0x4B,0xDA,0xAF,0x3E,0x4C,0xDD, 0xA6,0x37,0x45,0xD4,0xA1,0x30,0x42,0xD3,
+    0xB4,0x25,0x57,0xC6,0xB3,0x22,0x50,0xC1, 0xBA,0x2B,0x59,0xC8,0xBD,0x2C,0x5E,0xCF
+};
+
+/** The states of the inbound frame parser */
+typedef enum
+{
+    RX_HUNT,            /**< waiting for an opening flag */
+    RX_ADDRESS,         /**< waiting for the address (or further flags) */
+    RX_CONTROL,         /**< waiting for the control field */
+    RX_LENGTH,          /**< waiting for the first length byte */
+    RX_LENGTH2,         /**< waiting for the second length byte */
+    RX_INFO,            /**< collecting the info field */
+    RX_FCS,             /**< waiting for the FCS */
+    RX_CLOSE            /**< waiting for the closing flag */
+} CmuxRxState;
+
+/**
+ * The CmuxState structure is used to store state for the CMUX transport.
+ */
+typedef struct CmuxState_s
+{
+    /** The inner (serial or ring buffer) transport */
+    ThingstreamTransport* inner;
+    /** The callback registered by the outer transport */
+    ThingstreamTransportCallback_t callback;
+    /** Cookie associated with the registered callback */
+    void* cookie;
+    /** Frames are built here, then the rest holds the inbound info field */
+    uint8_t* buffer;
+    /** The space for the inbound info field (or the reply to AT+CMUX) */
+    uint16_t rxSize;
+    /** The multiplexer is running */
+    bool started;
+    /** The modem has left multiplexer mode (it was reset, or closed the
+     * multiplexer with DISC or CLD), start it again before the next send */
+    volatile bool restart;
+    /** A restart has failed, the next is not tried before restartAt */
+    bool restartHeld;
+    /** The time from which the next restart may be tried */
+    uint32_t restartAt;
+    /** The time to wait after the next failed restart */
+    uint32_t restartBackoffMs;
+    /** Modem output is collected as text, before the multiplexer starts */
+    volatile bool rawMode;
+    /** The number of bytes of text collected in rawMode */
+    volatile uint16_t rawLen;
+
+    /** The inbound frame parser state */
+    CmuxRxState rxState;
+    uint8_t rxAddress;
+    uint8_t rxControl;
+    uint8_t rxFcs;
+    uint16_t rxLen;
+    uint16_t rxCount;
+
+    /** Bit mask of the channels for which UA has been received */
+    volatile uint8_t opened;
+    /** Bit mask of the channels for which DM has been received */
+    volatile uint8_t refused;
+    /** Bit mask of the channels for which DISC is to be acknowledged */
+    volatile uint8_t disconnected;
+
+    /** The reply to a multiplexer control message from the modem */
+    uint8_t muxReply[MUX_REPLY_LEN];
+    /** The length of muxReply, or zero if there is no reply to send */
+    volatile uint8_t muxReplyLen;
+
+    /** The current line received on the control channel */
+    char controlLine[CONTROL_LINE_LEN];
+    uint16_t controlLen;
+    /** The current line is longer than CONTROL_LINE_LEN and is discarded */
+    bool controlOverflow;
+    /** A final result has been received on the control channel */
+    volatile bool controlDone;
+    /** The final result was OK */
+    volatile bool controlOk;
+} CmuxState;
+
+/** Instance of CmuxState */
+static CmuxState _cmux_transport_state;
+
+static ThingstreamTransportResult cmux_init(ThingstreamTransport* self, uint16_t version);
+static ThingstreamTransportResult cmux_shutdown(ThingstreamTransport* self);
+static ThingstreamTransportResult cmux_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len);
+static ThingstreamTransportResult cmux_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis);
+static ThingstreamTransportResult cmux_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie);
+static ThingstreamTransportResult cmux_run(ThingstreamTransport* self, uint32_t millis);
+
+/** Instance of ThingstreamTransport for the CMUX transport */
+static const ThingstreamTransport _cmux_transport_instance = {
+    (ThingstreamTransportState_t*)&_cmux_transport_state,
+    cmux_init,
+    cmux_shutdown,
+    cmux_get_buffer,
+    NULL, /* This slot no longer used */
+    cmux_send,
+    cmux_register_callback,
+    NULL, /* This slot no longer used */
+    cmux_run
+};
+
+
+ThingstreamTransport* Thingstream_createCmuxTransport(ThingstreamTransport* inner, uint8_t* buffer, uint16_t bufSize)
+{
+    ThingstreamTransport* self = (ThingstreamTransport*)&_cmux_transport_instance;
+    CmuxState* state = (CmuxState*)self->_state;
+
+    if ((inner == NULL) || (buffer == NULL) || (bufSize < CMUX_BUFFER_LEN))
+    {
+        return NULL;
+    }
+    memset(state, 0, sizeof(*state));
+    state->inner = inner;
+    state->buffer = buffer;
+    state->rxSize = bufSize - TX_LEN;
+    return self;
+}
+
+
+/**
+ * Update the CRC with the bytes.
+ */
+static uint8_t crcUpdate(uint8_t crc, const uint8_t* data, uint16_t len)
+{
+    while (len-- > 0)
+    {
+        crc = crcTable[crc ^ *data++];
+    }
+    return crc;
+}
+
+/**
+ * Return where the info field of a frame of the given length is placed in
+ * the transmit area, so that it can be written there before buildFrame().
+ */
+static uint8_t* frameInfo(CmuxState* state, uint16_t len)
+{
+    return &state->buffer[(len <= 127) ? 4 : 5];
+}
+
+/**
+ * Build a frame in the transmit area of the buffer.
+ *
+ * @param state the CMUX state
+ * @param dlci the channel
+ * @param control the control field
+ * @param info the info field, which may already be in place at frameInfo()
+ * @param len the length of the info field, at most #CMUX_FRAME_SIZE
+ * @return the length of the frame
+ */
+static uint16_t buildFrame(CmuxState* state, uint8_t dlci, uint8_t control, const uint8_t* info, uint16_t len)
+{
+    uint8_t* frame = state->buffer;
+    uint16_t headerLen;
+    uint8_t crc;
+
+    frame[0] = CMUX_FLAG;
+    frame[1] = (uint8_t)((dlci << 2) | CMUX_CR | CMUX_EA);
+    frame[2] = control;
+    if (len <= 127)
+    {
+        frame[3] = (uint8_t)((len << 1) | CMUX_EA);
+        headerLen = 3;
+    }
+    else
+    {
+        frame[3] = (uint8_t)(len << 1);
+        frame[4] = (uint8_t)(len >> 7);
+        headerLen = 4;
+    }
+    if ((len > 0) && (info != &frame[1 + headerLen]))
+    {
+        memcpy(&frame[1 + headerLen], info, len);
+    }
+
+    crc = crcUpdate(0xFF, &frame[1], headerLen);
+    if ((control & ~CMUX_PF) != CMUX_UIH)
+    {
+        crc = crcUpdate(crc, info, len);
+    }
+    frame[1 + headerLen + len] = (uint8_t)(0xFF - crc);
+    frame[2 + headerLen + len] = CMUX_FLAG;
+    return (uint16_t)(3 + headerLen + len);
+}
+
+/**
+ * Return the number of milliseconds until the limit (zero if passed).
+ */
+static uint32_t remaining(uint32_t limit)
+{
+    uint32_t now = Thingstream_Platform_getTimeMillis();
+    return TIME_COMPARE(limit, >, now) ? limit - now : 0;
+}
+
+/**
+ * Build a frame and send it to the inner transport.
+ */
+static ThingstreamTransportResult sendFrame(CmuxState* state, uint16_t flags, uint8_t dlci, uint8_t control, const uint8_t* info, uint16_t len, uint32_t limit)
+{
+    ThingstreamTransport* inner = state->inner;
+    uint16_t frameLen = buildFrame(state, dlci, control, info, len);
+    return inner->send(inner, flags, state->buffer, frameLen, remaining(limit));
+}
+
+/**
+ * Run the inner transport, then send any reply to the modem's
+ * multiplexer control messages and acknowledge any DISC.
+ */
+static ThingstreamTransportResult runInner(CmuxState* state, uint32_t millis)
+{
+    ThingstreamTransport* inner = state->inner;
+    ThingstreamTransportResult tRes = inner->run(inner, millis);
+    uint8_t disconnected = state->disconnected;
+    uint8_t replyLen = state->muxReplyLen;
+    uint8_t dlci;
+
+    state->disconnected = 0;
+    for (dlci = DLCI_MUX; disconnected != 0; ++dlci, disconnected >>= 1)
+    {
+        if ((disconnected & 1) != 0)
+        {
+            (void)sendFrame(state, 0, dlci, CMUX_UA | CMUX_PF, NULL, 0,
+                            Thingstream_Platform_getTimeMillis() + CMUX_SABM_REPLY_MS);
+        }
+    }
+    if (replyLen > 0)
+    {
+        uint8_t reply[MUX_REPLY_LEN];
+        memcpy(reply, state->muxReply, replyLen);
+        state->muxReplyLen = 0;
+        (void)sendFrame(state, 0, DLCI_MUX, CMUX_UIH, reply, replyLen,
+                        Thingstream_Platform_getTimeMillis() + CMUX_SABM_REPLY_MS);
+    }
+    return tRes;
+}
+
+/**
+ * Run the inner transport until the flag is set or the limit is reached.
+ *
+ * @return true if the flag was set
+ */
+static bool runInnerUntil(CmuxState* state, volatile bool* flag, uint32_t limit)
+{
+    for (;;)
+    {
+        if ((flag != NULL) && *flag)
+        {
+            return true;
+        }
+        uint32_t millis = remaining(limit);
+        if (millis == 0)
+        {
+            return false;
+        }
+        (void)runInner(state, millis);
+    }
+}
+
+/**
+ * Return true if the text contains the pattern.
+ */
+static bool contains(const uint8_t* text, uint16_t len, const char* pattern)
+{
+    uint16_t patternLen = (uint16_t)strlen(pattern);
+    uint16_t i;
+    for (i = 0; i + patternLen <= len; ++i)
+    {
+        if (memcmp(&text[i], pattern, patternLen) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Send AT+CMUX and wait for the modem's reply.
+ *
+ * @return true if the modem replied OK
+ */
+static bool requestMux(CmuxState* state, uint32_t limit)
+{
+    uint8_t* text = &state->buffer[TX_LEN];
+    uint32_t replyLimit = Thingstream_Platform_getTimeMillis() + CMUX_AT_REPLY_MS;
+    ThingstreamTransport* inner = state->inner;
+    bool ok = false;
+
+    if (TIME_COMPARE(replyLimit, >, limit))
+    {
+        replyLimit = limit;
+    }
+    state->rawLen = 0;
+    state->rawMode = true;
+    if (inner->send(inner, 0, (uint8_t*)cmuxCommand, sizeof(cmuxCommand) - 1,
+                    remaining(replyLimit)) == TRANSPORT_SUCCESS)
+    {
+        for (;;)
+        {
+            uint16_t len = state->rawLen;
+            if (contains(text, len, "\nOK\r"))
+            {
+                ok = true;
+                break;
+            }
+            uint32_t millis = remaining(replyLimit);
+            if ((millis == 0) || contains(text, len, "ERROR"))
+            {
+                break;
+            }
+            (void)inner->run(inner, millis);
+        }
+    }
+    state->rawMode = false;
+    return ok;
+}
+
+/**
+ * Open a channel with SABM and wait for UA.
+ *
+ * @return true if the channel is open
+ */
+static bool openChannel(CmuxState* state, uint8_t dlci, uint32_t limit)
+{
+    uint8_t bit = (uint8_t)(1u << dlci);
+    int tries;
+
+    state->opened &= ~bit;
+    state->refused &= ~bit;
+    for (tries = 0; tries < CMUX_SABM_TRIES; ++tries)
+    {
+        uint32_t replyLimit = Thingstream_Platform_getTimeMillis() + CMUX_SABM_REPLY_MS;
+        if (TIME_COMPARE(replyLimit, >, limit))
+        {
+            replyLimit = limit;
+        }
+        if (sendFrame(state, 0, dlci, CMUX_SABM | CMUX_PF, NULL, 0, replyLimit) != TRANSPORT_SUCCESS)
+        {
+            return false;
+        }
+        while (((state->opened | state->refused) & bit) == 0)
+        {
+            uint32_t millis = remaining(replyLimit);
+            if (millis == 0)
+            {
+                break;
+            }
+            (void)runInner(state, millis);
+        }
+        if ((state->opened & bit) != 0)
+        {
+            return true;
+        }
+        if (((state->refused & bit) != 0) || (remaining(limit) == 0))
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+/**
+ * Switch the modem to multiplexer mode and open the data and control
+ * channels.
+ *
+ * @param state the CMUX state
+ * @param limit the time limit
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult startMux(CmuxState* state, uint32_t limit)
+{
+    static const uint8_t channels[] = { DLCI_MUX, DLCI_DATA, DLCI_CONTROL };
+    size_t i;
+
+    state->rxState = RX_HUNT;
+    state->muxReplyLen = 0;
+    state->disconnected = 0;
+    state->restart = false;
+
+    /* If AT+CMUX fails the modem may still be multiplexing from before
+     * this processor was reset, so try to open the channels anyway.
+     */
+    if (requestMux(state, limit))
+    {
+        uint32_t ready = Thingstream_Platform_getTimeMillis() + CMUX_SWITCH_MS;
+        (void)runInnerUntil(state, NULL, TIME_COMPARE(ready, <, limit) ? ready : limit);
+    }
+    state->rxState = RX_HUNT;
+
+    for (i = 0; i < sizeof(channels); ++i)
+    {
+        if (!openChannel(state, channels[i], limit))
+        {
+            return TRANSPORT_INIT_AT_FAILURE;
+        }
+    }
+    for (i = 1; i < sizeof(channels); ++i)
+    {
+        uint8_t msc[4];
+        msc[0] = CMUX_MSG_MSC;
+        msc[1] = (2 << 1) | CMUX_EA;
+        msc[2] = (uint8_t)((channels[i] << 2) | CMUX_CR | CMUX_EA);
+        msc[3] = CMUX_V24_SIGNALS;
+        (void)sendFrame(state, 0, DLCI_MUX, CMUX_UIH, msc, sizeof(msc), limit);
+    }
+    state->controlLen = 0;
+    state->controlOverflow = false;
+    state->started = true;
+    return TRANSPORT_SUCCESS;
+}
+
+/**
+ * Start the multiplexer again if the modem has left multiplexer mode,
+ * within the time limit of the send. After a failed restart the sends
+ * fail at once until the backoff time has passed.
+ *
+ * @param state the CMUX state
+ * @param limit the time limit of the send
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult checkRestart(CmuxState* state, uint32_t limit)
+{
+    ThingstreamTransportResult tRes;
+    uint32_t now = Thingstream_Platform_getTimeMillis();
+    uint32_t startLimit = now + CMUX_START_MS;
+
+    if (!state->restart)
+    {
+        return TRANSPORT_SUCCESS;
+    }
+    if (state->restartHeld && TIME_COMPARE(now, <, state->restartAt))
+    {
+        return TRANSPORT_INIT_AT_FAILURE;
+    }
+    if (TIME_COMPARE(limit, <, startLimit))
+    {
+        startLimit = limit;
+    }
+    tRes = startMux(state, startLimit);
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        state->restartHeld = false;
+        state->restartBackoffMs = CMUX_RESTART_MIN_MS;
+    }
+    else
+    {
+        /* Try again on a send after the backoff time */
+        state->restart = true;
+        state->restartHeld = true;
+        state->restartAt = Thingstream_Platform_getTimeMillis() + state->restartBackoffMs;
+        if (state->restartBackoffMs < CMUX_RESTART_MAX_MS / 2)
+        {
+            state->restartBackoffMs *= 2;
+        }
+        else
+        {
+            state->restartBackoffMs = CMUX_RESTART_MAX_MS;
+        }
+    }
+    return tRes;
+}
+
+/**
+ * Check whether the data sent on the data channel is a command that resets
+ * the modem.
+ *
+ * @param data the data sent
+ * @param len the length of the data
+ * @return true if the data resets the modem
+ */
+static bool isReset(const uint8_t* data, uint16_t len)
+{
+    const char* force = Thingstream_Modem_forceResetString;
+    size_t forceLen;
+    size_t i;
+
+    if (*force == '?')
+    {
+        ++force;
+    }
+    forceLen = strcspn(force, "\n");
+    if ((forceLen > 0) && (*force != '~') && (len >= forceLen)
+        && (memcmp(data, force, forceLen) == 0))
+    {
+        return true;
+    }
+    for (i = 0; i < RESET_COMMANDS; ++i)
+    {
+        const char* command = resetCommands[i];
+        if ((len >= strlen(command)) && (memcmp(data, command, strlen(command)) == 0))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+ThingstreamTransportResult Thingstream_Cmux_sendLine(ThingstreamTransport* self, const char* line, uint32_t millis)
+{
+    CmuxState* state = (CmuxState*)self->_state;
+    uint32_t limit = Thingstream_Platform_getTimeMillis() + millis;
+    size_t len = strlen(line);
+    ThingstreamTransportResult tRes;
+    uint8_t* info;
+
+    if (!state->started)
+    {
+        return TRANSPORT_ERROR;
+    }
+    if (len >= CMUX_FRAME_SIZE)
+    {
+        return TRANSPORT_ILLEGAL_ARGUMENT;
+    }
+    tRes = checkRestart(state, limit);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return tRes;
+    }
+
+    /* The line is built in place in the transmit area */
+    info = frameInfo(state, (uint16_t)(len + 1));
+    memcpy(info, line, len);
+    info[len++] = '\r';
+
+    state->controlDone = false;
+    state->controlOk = false;
+    tRes = sendFrame(state, 0, DLCI_CONTROL, CMUX_UIH, info, (uint16_t)len, limit);
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        if (!runInnerUntil(state, &state->controlDone, limit))
+        {
+            tRes = TRANSPORT_SEND_TIMEOUT;
+        }
+        else if (!state->controlOk)
+        {
+            tRes = TRANSPORT_MODEM_ERROR;
+        }
+    }
+    return tRes;
+}
+
+
+/**
+ * Collect the text received on the control channel into lines, pass each
+ * line to the application and note the final result. A line too long for
+ * controlLine is discarded whole rather than passed on truncated.
+ */
+static void controlData(CmuxState* state, const uint8_t* data, uint16_t len)
+{
+    while (len-- > 0)
+    {
+        char ch = (char)*data++;
+        if ((ch == '\r') || (ch == '\n'))
+        {
+            uint16_t lineLen = state->controlLen;
+            const char* line = state->controlLine;
+            bool overflow = state->controlOverflow;
+            state->controlLen = 0;
+            state->controlOverflow = false;
+            if ((lineLen == 0) || overflow)
+            {
+                continue;
+            }
+            Thingstream_Application_modemCallback(line, lineLen);
+            if ((lineLen == 2) && (memcmp(line, "OK", 2) == 0))
+            {
+                state->controlOk = true;
+                state->controlDone = true;
+            }
+            else if (((lineLen == 5) && (memcmp(line, "ERROR", 5) == 0))
+                     || ((lineLen >= 10) && (memcmp(line, "+CME ERROR", 10) == 0)))
+            {
+                state->controlDone = true;
+            }
+        }
+        else if (state->controlLen < CONTROL_LINE_LEN)
+        {
+            state->controlLine[state->controlLen++] = ch;
+        }
+        else
+        {
+            state->controlOverflow = true;
+        }
+    }
+}
+
+/**
+ * Act on a complete inbound frame.
+ */
+static void dispatchFrame(CmuxState* state)
+{
+    uint8_t dlci = state->rxAddress >> 2;
+    uint8_t control = state->rxControl & ~CMUX_PF;
+    uint8_t* info = &state->buffer[TX_LEN];
+    uint16_t len = state->rxLen;
+
+    if (dlci > DLCI_CONTROL)
+    {
+        return;
+    }
+    switch (control)
+    {
+    case CMUX_UA:
+        state->opened |= (uint8_t)(1u << dlci);
+        break;
+
+    case CMUX_DM:
+        state->refused |= (uint8_t)(1u << dlci);
+        state->opened &= (uint8_t)~(1u << dlci);
+        break;
+
+    case CMUX_DISC:
+        /* The modem has closed a channel (or, on DLCI 0, the whole
+         * multiplexer), acknowledge it and start again before the next send
+         */
+        state->opened &= (uint8_t)~(1u << dlci);
+        state->disconnected |= (uint8_t)(1u << dlci);
+        if (state->started)
+        {
+            state->restart = true;
+        }
+        break;
+
+    case CMUX_UIH:
+        if (dlci == DLCI_DATA)
+        {
+            if ((state->callback != NULL) && (len > 0))
+            {
+                state->callback(state->cookie, info, len);
+            }
+        }
+        else if (dlci == DLCI_CONTROL)
+        {
+            controlData(state, info, len);
+        }
+        else if ((len >= 2) && ((info[0] & CMUX_CR) != 0)
+                 && (len <= MUX_REPLY_LEN) && (state->muxReplyLen == 0))
+        {
+            /* Acknowledge a command from the modem by returning it as a
+             * response (e.g. MSC, which carries the modem's V.24 signals)
+             */
+            memcpy(state->muxReply, info, len);
+            state->muxReply[0] &= ~CMUX_CR;
+            state->muxReplyLen = (uint8_t)len;
+            if ((info[0] == CMUX_MSG_CLD) && state->started)
+            {
+                /* The modem is closing down the multiplexer */
+                state->restart = true;
+            }
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * Feed one byte to the inbound frame parser.
+ */
+static void parseByte(CmuxState* state, uint8_t b)
+{
+    switch (state->rxState)
+    {
+    case RX_HUNT:
+        if (b == CMUX_FLAG)
+        {
+            state->rxState = RX_ADDRESS;
+        }
+        break;
+
+    case RX_ADDRESS:
+        if (b != CMUX_FLAG)
+        {
+            state->rxAddress = b;
+            state->rxFcs = crcTable[0xFF ^ b];
+            state->rxState = ((b & CMUX_EA) != 0) ? RX_CONTROL : RX_HUNT;
+        }
+        break;
+
+    case RX_CONTROL:
+        state->rxControl = b;
+        state->rxFcs = crcTable[state->rxFcs ^ b];
+        state->rxState = RX_LENGTH;
+        break;
+
+    case RX_LENGTH:
+        state->rxFcs = crcTable[state->rxFcs ^ b];
+        state->rxLen = b >> 1;
+        state->rxCount = 0;
+        if ((b & CMUX_EA) == 0)
+        {
+            state->rxState = RX_LENGTH2;
+        }
+        else
+        {
+            state->rxState = (state->rxLen > 0) ? RX_INFO : RX_FCS;
+        }
+        break;
+
+    case RX_LENGTH2:
+        state->rxFcs = crcTable[state->rxFcs ^ b];
+        state->rxLen |= (uint16_t)b << 7;
+        state->rxState = (state->rxLen > 0) ? RX_INFO : RX_FCS;
+        break;
+
+    case RX_INFO:
+        if (state->rxCount < state->rxSize)
+        {
+            state->buffer[TX_LEN + state->rxCount] = b;
+        }
+        if (++state->rxCount == state->rxLen)
+        {
+            state->rxState = RX_FCS;
+        }
+        break;
+
+    case RX_FCS:
+        if ((state->rxControl & ~CMUX_PF) != CMUX_UIH)
+        {
+            uint16_t len = (state->rxLen < state->rxSize) ? state->rxLen : state->rxSize;
+            state->rxFcs = crcUpdate(state->rxFcs, &state->buffer[TX_LEN], len);
+        }
+        /* The FCS is valid if the CRC over it leaves this constant */
+        state->rxFcs = crcTable[state->rxFcs ^ b];
+        state->rxState = (state->rxFcs == 0xCF) ? RX_CLOSE : RX_HUNT;
+        break;
+
+    case RX_CLOSE:
+        if (b == CMUX_FLAG)
+        {
+            if (state->rxLen <= state->rxSize)
+            {
+                dispatchFrame(state);
+            }
+            /* The closing flag may also open the next frame */
+            state->rxState = RX_ADDRESS;
+        }
+        else
+        {
+            state->rxState = RX_HUNT;
+        }
+        break;
+    }
+}
+
+/**
+ * Callback from the inner transport with modem output.
+ *
+ * @param cookie the CMUX state
+ * @param data the modem output
+ * @param len the length of the modem output
+ */
+static void cmux_callback(void* cookie, uint8_t* data, uint16_t len)
+{
+    CmuxState* state = (CmuxState*)cookie;
+    if (state->rawMode)
+    {
+        uint16_t used = state->rawLen;
+        uint16_t room = state->rxSize - used;
+        if (len > room)
+        {
+            len = room;
+        }
+        memcpy(&state->buffer[TX_LEN + used], data, len);
+        state->rawLen = used + len;
+    }
+    else
+    {
+        while (len-- > 0)
+        {
+            parseByte(state, *data++);
+        }
+    }
+}
+
+/**
+ * Initialize the transport and start the multiplexer.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param version the transport API version
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult cmux_init(ThingstreamTransport* self, uint16_t version)
+{
+    CmuxState* state = (CmuxState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    ThingstreamTransportResult tRes;
+
+    if (!TRANSPORT_CHECK_VERSION_1(version))
+    {
+        return TRANSPORT_VERSION_MISMATCH;
+    }
+    state->started = false;
+    state->restart = false;
+    state->restartHeld = false;
+    state->restartBackoffMs = CMUX_RESTART_MIN_MS;
+    tRes = inner->register_callback(inner, cmux_callback, state);
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        tRes = inner->init(inner, version);
+    }
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        tRes = startMux(state, Thingstream_Platform_getTimeMillis() + CMUX_START_MS);
+    }
+    return tRes;
+}
+
+/**
+ * Close the multiplexer and shutdown the inner transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult cmux_shutdown(ThingstreamTransport* self)
+{
+    CmuxState* state = (CmuxState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    if (state->started && !state->restart)
+    {
+        static const uint8_t cld[] = { CMUX_MSG_CLD, CMUX_EA };
+        (void)sendFrame(state, 0, DLCI_MUX, CMUX_UIH, cld, sizeof(cld),
+                        Thingstream_Platform_getTimeMillis() + CMUX_SABM_REPLY_MS);
+    }
+    state->started = false;
+    return inner->shutdown(inner);
+}
+
+/**
+ * Pass the buffer request to the inner transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param buffer where to write the buffer pointer
+ * @param len where the write the buffer length
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult cmux_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len)
+{
+    CmuxState* state = (CmuxState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    if (inner->get_buffer == NULL)
+    {
+        return TRANSPORT_ERROR;
+    }
+    return inner->get_buffer(inner, buffer, len);
+}
+
+/**
+ * Send the data on the data channel, split into frames of at most
+ * #CMUX_FRAME_SIZE bytes. The multiplexer is started again first if the
+ * modem has left it, and is marked to be started again if the data is a
+ * command that resets the modem.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param flags an indication of the type of the data, zero is normal.
+ * @param data a pointer to the data
+ * @param len the length of the raw data
+ * @param millis the maximum number of milliseconds to run
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult cmux_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis)
+{
+    CmuxState* state = (CmuxState*)self->_state;
+    uint32_t limit = Thingstream_Platform_getTimeMillis() + millis;
+    ThingstreamTransportResult tRes = TRANSPORT_SUCCESS;
+
+    if (!state->started)
+    {
+        return TRANSPORT_ERROR;
+    }
+    tRes = checkRestart(state, limit);
+    if ((tRes == TRANSPORT_SUCCESS) && isReset(data, len))
+    {
+        state->restart = true;
+    }
+    while ((len > 0) && (tRes == TRANSPORT_SUCCESS))
+    {
+        uint16_t chunk = (len > CMUX_FRAME_SIZE) ? CMUX_FRAME_SIZE : len;
+        tRes = sendFrame(state, flags, DLCI_DATA, CMUX_UIH, data, chunk, limit);
+        data += chunk;
+        len -= chunk;
+    }
+    return tRes;
+}
+
+/**
+ * Register a callback function that will be called when this transport
+ * has data to send to its next outermost ThingstreamTransport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param callback the callback function
+ * @param cookie a opaque value passed to the callback function
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult cmux_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie)
+{
+    CmuxState* state = (CmuxState*)self->_state;
+    state->callback = callback;
+    state->cookie = cookie;
+    return TRANSPORT_SUCCESS;
+}
+
+/**
+ * Allow the inner transport to run for at most the given number of
+ * milliseconds.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param millis the maximum number of milliseconds to run (a value of zero
+ *        processes all pending operations).
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult cmux_run(ThingstreamTransport* self, uint32_t millis)
+{
+    CmuxState* state = (CmuxState*)self->_state;
+    return runInner(state, millis);
+}
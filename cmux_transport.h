@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief ThingstreamTransport implementation of the 3GPP TS 27.010
+ * multiplexer (CMUX, basic option) between the serial transport and the
+ * modem transport.
+ */
+
+#ifndef INC_CMUX_TRANSPORT_H
+#define INC_CMUX_TRANSPORT_H
+
+#include "transport_api.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * The maximum information field size (N1) requested from the modem.
+ * @hideinitializer
+ */
+#ifndef CMUX_FRAME_SIZE
+#define CMUX_FRAME_SIZE 127
+#endif
+
+/**
+ * Recommended buffer size for Thingstream_createCmuxTransport(), enough
+ * for one outbound and one inbound frame.
+ * @hideinitializer
+ */
+#define CMUX_BUFFER_LEN (2 * (CMUX_FRAME_SIZE + 7))
+
+/**
+ * Create an instance of the CMUX transport.
+ *
+ * When initialised this transport switches the modem into multiplexer
+ * mode with AT+CMUX=0 and opens two virtual channels: DLCI 1 carries all
+ * the traffic of the modem transport (AT commands and socket data) and
+ * DLCI 2 is reserved for the application's status queries made with
+ * Thingstream_Cmux_sendLine(). A status query then does not wait behind
+ * socket traffic on the data channel, and cannot be confused with it.
+ *
+ * The modem must support the basic option of 27.010. If the modem leaves
+ * multiplexer mode, because it is reset (AT+CFUN=1,1 or the first line of
+ * #Thingstream_Modem_forceResetString is sent) or closes the multiplexer
+ * with DISC or CLD, the multiplexer is started again before the next send,
+ * within that send's time limit. If that fails the sends fail at once for
+ * a backoff time, from 5 seconds doubling to a minute, before the next
+ * attempt.
+ *
+ * @param inner the inner (serial or ring buffer) #ThingstreamTransport
+ * @param buffer a buffer for frames
+ * @param bufSize the size of the buffer, we suggest #CMUX_BUFFER_LEN
+ * @return the #ThingstreamTransport instance
+ */
+extern ThingstreamTransport* Thingstream_createCmuxTransport(ThingstreamTransport* inner, uint8_t* buffer, uint16_t bufSize);
+
+/**
+ * Send the line to the modem on the control channel and wait for an OK
+ * response. Each line of the response is passed to
+ * Thingstream_Application_modemCallback().
+ *
+ * @param self this instance of CMUX transport
+ * @param line a null-terminated line to send to the modem ("\r" will be added)
+ * @param millis the maximum number of milliseconds to run
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+extern ThingstreamTransportResult Thingstream_Cmux_sendLine(ThingstreamTransport* self, const char* line, uint32_t millis);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_CMUX_TRANSPORT_H */
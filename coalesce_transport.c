@@ -0,0 +1,404 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Coalescing of MQTT-SN packets implemented as a
+ * ThingstreamTransport instance
+ *
+ * The protocol transport adds its header and trailer around the data in
+ * its own buffer, so the packets being held are kept in a separate buffer
+ * and copied into the protocol transport's buffer to be sent.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "coalesce_transport.h"
+#include "client_platform.h"
+
+/** The MQTT-SN PUBLISH message type */
+#define MQTTSN_PUBLISH          0x0C
+
+/** The MQTT-SN length byte that introduces a 3-byte length */
+#define MQTTSN_LONG_LENGTH      0x01
+
+/** The time allowed to send the held packets from the run routine */
+#define FLUSH_MS                5000
+
+/**
+ * The CoalesceState structure is used to store state for the coalesce
+ * transport.
+ */
+typedef struct CoalesceState_s
+{
+    /** The inner transport */
+    ThingstreamTransport* inner;
+    /** The callback registered by the outer transport */
+    ThingstreamTransportCallback_t callback;
+    /** Cookie associated with the registered callback */
+    void* cookie;
+    /** The buffer holding the packets */
+    uint8_t* buf;
+    /** The length of the buffer */
+    uint16_t len;
+    /** The longest datagram */
+    uint16_t maxLen;
+    /** The length of the packets being held */
+    uint16_t used;
+    /** The longest time a packet is held */
+    uint32_t windowMs;
+    /** The time at which the held packets are sent */
+    uint32_t flushAt;
+} CoalesceState;
+
+/** Instance of CoalesceState */
+static CoalesceState _coalesce_transport_state;
+
+static ThingstreamTransportResult coalesce_init(ThingstreamTransport* self, uint16_t version);
+static ThingstreamTransportResult coalesce_shutdown(ThingstreamTransport* self);
+static ThingstreamTransportResult coalesce_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len);
+static ThingstreamTransportResult coalesce_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis);
+static ThingstreamTransportResult coalesce_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie);
+static ThingstreamTransportResult coalesce_run(ThingstreamTransport* self, uint32_t millis);
+
+/** Instance of ThingstreamTransport for the coalesce transport */
+static const ThingstreamTransport _coalesce_transport_instance = {
+    (ThingstreamTransportState_t*)&_coalesce_transport_state,
+    coalesce_init,
+    coalesce_shutdown,
+    coalesce_get_buffer,
+    NULL, /* This slot no longer used */
+    coalesce_send,
+    coalesce_register_callback,
+    NULL, /* This slot no longer used */
+    coalesce_run
+};
+
+
+ThingstreamTransport* Thingstream_createCoalesceTransport(ThingstreamTransport* inner, uint8_t* buffer, uint16_t len, uint16_t maxLen, uint32_t windowMs)
+{
+    ThingstreamTransport* self = (ThingstreamTransport*)&_coalesce_transport_instance;
+    CoalesceState* state = (CoalesceState*)self->_state;
+
+    if ((inner == NULL) || (buffer == NULL) || (maxLen == 0) || (maxLen > len))
+    {
+        return NULL;
+    }
+    memset(state, 0, sizeof(*state));
+    state->inner = inner;
+    state->buf = buffer;
+    state->len = len;
+    state->maxLen = maxLen;
+    state->windowMs = windowMs;
+    return self;
+}
+
+
+/**
+ * Send the packets being held as one datagram.
+ *
+ * @param state the coalesce state
+ * @param flags the flags to send with
+ * @param millis the maximum number of milliseconds to run
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult flushHeld(CoalesceState* state, uint16_t flags, uint32_t millis)
+{
+    ThingstreamTransport* inner = state->inner;
+    ThingstreamTransportResult tRes;
+    uint8_t* innerBuf;
+    uint16_t innerLen;
+    uint16_t used = state->used;
+
+    if (used == 0)
+    {
+        return TRANSPORT_SUCCESS;
+    }
+    state->used = 0;
+    tRes = coalesce_get_buffer((ThingstreamTransport*)&_coalesce_transport_instance,
+                               &innerBuf, &innerLen);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return tRes;
+    }
+    if (used > innerLen)
+    {
+        return TRANSPORT_ILLEGAL_ARGUMENT;
+    }
+    memcpy(innerBuf, state->buf, used);
+    return inner->send(inner, flags, innerBuf, used, millis);
+}
+
+
+ThingstreamTransportResult Thingstream_Coalesce_flush(ThingstreamTransport* self, uint32_t millis)
+{
+    CoalesceState* state = (CoalesceState*)self->_state;
+    return flushHeld(state, 0, millis);
+}
+
+
+/**
+ * Return the length of the MQTT-SN packet at the start of the data.
+ *
+ * @param data a pointer to the data
+ * @param len the length of the data
+ * @return the length of the packet, or 0 if it is not valid
+ */
+static uint16_t packetLength(const uint8_t* data, uint16_t len)
+{
+    uint16_t packetLen;
+
+    if (len < 2)
+    {
+        return 0;
+    }
+    if (data[0] == MQTTSN_LONG_LENGTH)
+    {
+        packetLen = (len < 4) ? 0 : (uint16_t)((data[1] << 8) | data[2]);
+    }
+    else
+    {
+        packetLen = data[0];
+    }
+    return ((packetLen < 2) || (packetLen > len)) ? 0 : packetLen;
+}
+
+/**
+ * Pass a received datagram to the outer transport, one packet at a time
+ * if it holds several.
+ *
+ * @param cookie the coalesce state
+ * @param data a pointer to the data
+ * @param len the length of the data
+ */
+static void coalesce_callback(void* cookie, uint8_t* data, uint16_t len)
+{
+    CoalesceState* state = (CoalesceState*)cookie;
+    uint16_t offset = 0;
+    uint16_t packetLen;
+
+    if (state->callback == NULL)
+    {
+        return;
+    }
+
+    /* Anything that is not wholly a sequence of packets is passed on
+     * unchanged.
+     */
+    packetLen = packetLength(data, len);
+    while ((packetLen != 0) && (offset + packetLen < len))
+    {
+        offset += packetLen;
+        packetLen = packetLength(data + offset, (uint16_t)(len - offset));
+    }
+    if ((packetLen == 0) || (offset == 0))
+    {
+        state->callback(state->cookie, data, len);
+        return;
+    }
+
+    offset = 0;
+    while (offset < len)
+    {
+        packetLen = packetLength(data + offset, (uint16_t)(len - offset));
+        state->callback(state->cookie, data + offset, packetLen);
+        offset += packetLen;
+    }
+}
+
+/**
+ * Initialize the transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param version the transport API version
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult coalesce_init(ThingstreamTransport* self, uint16_t version)
+{
+    CoalesceState* state = (CoalesceState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    ThingstreamTransportResult tRes;
+
+    if (!TRANSPORT_CHECK_VERSION_1(version))
+    {
+        return TRANSPORT_VERSION_MISMATCH;
+    }
+    state->used = 0;
+    tRes = inner->register_callback(inner, coalesce_callback, state);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return tRes;
+    }
+    return inner->init(inner, version);
+}
+
+/**
+ * Shutdown the transport (i.e. the opposite of initialize), first sending
+ * any packets being held.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult coalesce_shutdown(ThingstreamTransport* self)
+{
+    CoalesceState* state = (CoalesceState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    (void)flushHeld(state, 0, FLUSH_MS);
+    return inner->shutdown(inner);
+}
+
+/**
+ * Pass the buffer request to the inner transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param buffer where to write the buffer pointer
+ * @param len where the write the buffer length
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult coalesce_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len)
+{
+    CoalesceState* state = (CoalesceState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    if (inner->get_buffer == NULL)
+    {
+        return TRANSPORT_ERROR;
+    }
+    return inner->get_buffer(inner, buffer, len);
+}
+
+/**
+ * Hold a PUBLISH packet to be sent with others, or send the packet with
+ * those being held.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param flags an indication of the type of the data, zero is normal.
+ * @param data a pointer to the data
+ * @param len the length of the raw data
+ * @param millis the maximum number of milliseconds to run
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult coalesce_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis)
+{
+    CoalesceState* state = (CoalesceState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    ThingstreamTransportResult tRes;
+    uint8_t* innerBuf;
+    uint16_t innerLen;
+    uint16_t maxLen;
+    bool hold;
+
+    tRes = coalesce_get_buffer(self, &innerBuf, &innerLen);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return tRes;
+    }
+    maxLen = (state->maxLen < innerLen) ? state->maxLen : innerLen;
+    hold = (flags == 0) && (len <= maxLen) && (packetLength(data, len) != 0)
+        && (data[(data[0] == MQTTSN_LONG_LENGTH) ? 3 : 1] == MQTTSN_PUBLISH);
+
+    if ((state->used == 0) && !hold)
+    {
+        return inner->send(inner, flags, data, len, millis);
+    }
+
+    if (state->used + len <= maxLen)
+    {
+        memcpy(state->buf + state->used, data, len);
+        if (state->used == 0)
+        {
+            state->flushAt = Thingstream_Platform_getTimeMillis() + state->windowMs;
+        }
+        state->used = (uint16_t)(state->used + len);
+    }
+    else
+    {
+        /* The packet does not fit, so the held packets are sent first.
+         * The packet is in the inner transport's buffer where the held
+         * packets must go, so the two are exchanged.
+         */
+        uint16_t used = state->used;
+        uint16_t n = (used > len) ? used : len;
+        uint16_t i;
+
+        if ((len > state->len) || (len > innerLen))
+        {
+            return TRANSPORT_ILLEGAL_ARGUMENT;
+        }
+        memmove(innerBuf, data, len);
+        for (i = 0; i < n; ++i)
+        {
+            uint8_t b = innerBuf[i];
+            innerBuf[i] = state->buf[i];
+            state->buf[i] = b;
+        }
+        state->used = 0;
+        tRes = inner->send(inner, 0, innerBuf, used, millis);
+        if (tRes != TRANSPORT_SUCCESS)
+        {
+            return tRes;
+        }
+        state->used = len;
+        state->flushAt = Thingstream_Platform_getTimeMillis() + state->windowMs;
+    }
+    return hold ? TRANSPORT_SUCCESS : flushHeld(state, flags, millis);
+}
+
+/**
+ * Register a callback function that will be called when this transport
+ * has data to send to its next outermost ThingstreamTransport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param callback the callback function
+ * @param cookie a opaque value passed to the callback function
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult coalesce_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie)
+{
+    CoalesceState* state = (CoalesceState*)self->_state;
+    state->callback = callback;
+    state->cookie = cookie;
+    return TRANSPORT_SUCCESS;
+}
+
+/**
+ * Allow the inner transport to run for at most the given number of
+ * milliseconds, then send the held packets if they have been held long
+ * enough.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param millis the maximum number of milliseconds to run (a value of zero
+ *        processes all pending operations).
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult coalesce_run(ThingstreamTransport* self, uint32_t millis)
+{
+    CoalesceState* state = (CoalesceState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    ThingstreamTransportResult tRes;
+
+    if ((state->used > 0)
+        && TIME_COMPARE(Thingstream_Platform_getTimeMillis(), >=, state->flushAt))
+    {
+        tRes = flushHeld(state, 0, FLUSH_MS);
+        if (tRes != TRANSPORT_SUCCESS)
+        {
+            return tRes;
+        }
+    }
+    return inner->run(inner, millis);
+}
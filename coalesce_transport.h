@@ -0,0 +1,76 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Coalescing of several MQTT-SN packets into one datagram
+ *
+ * The coalesce transport sits between the client (or the publish window
+ * transport) and the protocol transport. PUBLISH packets are held for a
+ * short time, and the packets held are sent together as one datagram when
+ * the time is up, when the next packet would make the datagram too long,
+ * or with the next packet that is not a PUBLISH. A datagram received with
+ * several packets in it is passed on one packet at a time, so each
+ * acknowledgement is matched on its own.
+ *
+ * Coalescing saves most when the publishes do not wait for their
+ * acknowledgements, i.e. at QoS -1 or 0, or at QoS 1 through
+ * Thingstream_PublishWindow_publish(). A QoS 1
+ * Thingstream_Client_publish() is held for up to the coalescing time
+ * before it is sent.
+ */
+
+#ifndef INC_COALESCE_TRANSPORT_H
+#define INC_COALESCE_TRANSPORT_H
+
+#include <stdint.h>
+
+#include "transport_api.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * Create a coalesce transport instance.
+ *
+ * @param inner the inner transport instance (e.g. the protocol transport)
+ * @param buffer a buffer to hold the packets, at least as long as the
+ *   buffer of the inner transport
+ * @param len the length of the buffer
+ * @param maxLen the longest datagram to build (e.g. the MTU less the
+ *   protocol and encoding overheads)
+ * @param windowMs the longest time a packet is held
+ * @return the instance, or NULL if an argument is not valid
+ */
+extern ThingstreamTransport* Thingstream_createCoalesceTransport(ThingstreamTransport* inner, uint8_t* buffer, uint16_t len, uint16_t maxLen, uint32_t windowMs);
+
+/**
+ * Send the packets that are being held now.
+ *
+ * @param self the coalesce transport instance
+ * @param millis the maximum number of milliseconds to run
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+extern ThingstreamTransportResult Thingstream_Coalesce_flush(ThingstreamTransport* self, uint32_t millis);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_COALESCE_TRANSPORT_H */
@@ -0,0 +1,494 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Compression of MQTT-SN PUBLISH payloads implemented as a
+ * ThingstreamTransport instance
+ *
+ * The outer transport builds each packet in this transport's buffer, and
+ * the PUBLISH payload is compressed into the inner transport's buffer,
+ * behind room for the longest PUBLISH header, so the codec never works in
+ * place. The header is then written in front of the payload.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "compress_transport.h"
+#include "platform_cycles.h"
+
+/** The first byte of a compressed payload */
+#define COMPRESS_MARKER         0x00
+
+/** The MQTT-SN PUBLISH message type */
+#define MQTTSN_PUBLISH          0x0C
+
+/** The MQTT-SN length byte that introduces a 3-byte length */
+#define MQTTSN_LONG_LENGTH      0x01
+
+/** The length of a PUBLISH header with a 1-byte length */
+#define SHORT_PUBLISH_HEADER_LEN 7
+
+/** The length of a PUBLISH header with a 3-byte length */
+#define LONG_PUBLISH_HEADER_LEN 9
+
+/** The PUBLISH header fields after the message type (flags, topic, msgId) */
+#define PUBLISH_FIELDS_LEN      5
+
+/**
+ * The CompressState structure is used to store state for the compress
+ * transport.
+ */
+typedef struct CompressState_s
+{
+    /** The inner transport */
+    ThingstreamTransport* inner;
+    /** The callback registered by the outer transport */
+    ThingstreamTransportCallback_t callback;
+    /** Cookie associated with the registered callback */
+    void* cookie;
+    /** The buffer for the uncompressed packets */
+    uint8_t* buf;
+    /** The length of the buffer */
+    uint16_t len;
+    /** The size of the window as a number of bits */
+    uint8_t windowBits;
+    /** The statistics */
+    ThingstreamCompressStats stats;
+} CompressState;
+
+/** Instance of CompressState */
+static CompressState _compress_transport_state;
+
+static ThingstreamTransportResult compress_init(ThingstreamTransport* self, uint16_t version);
+static ThingstreamTransportResult compress_shutdown(ThingstreamTransport* self);
+static ThingstreamTransportResult compress_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len);
+static ThingstreamTransportResult compress_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis);
+static ThingstreamTransportResult compress_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie);
+static ThingstreamTransportResult compress_run(ThingstreamTransport* self, uint32_t millis);
+
+/** Instance of ThingstreamTransport for the compress transport */
+static const ThingstreamTransport _compress_transport_instance = {
+    (ThingstreamTransportState_t*)&_compress_transport_state,
+    compress_init,
+    compress_shutdown,
+    compress_get_buffer,
+    NULL, /* This slot no longer used */
+    compress_send,
+    compress_register_callback,
+    NULL, /* This slot no longer used */
+    compress_run
+};
+
+
+ThingstreamTransport* Thingstream_createCompressTransport(ThingstreamTransport* inner, uint8_t windowBits, uint8_t* buffer, uint16_t len)
+{
+    ThingstreamTransport* self = (ThingstreamTransport*)&_compress_transport_instance;
+    CompressState* state = (CompressState*)self->_state;
+
+    if ((inner == NULL) || (buffer == NULL) || (len == 0)
+        || (windowBits < LZSS_MIN_WINDOW_BITS)
+        || (windowBits > LZSS_MAX_WINDOW_BITS))
+    {
+        return NULL;
+    }
+    memset(state, 0, sizeof(*state));
+    state->inner = inner;
+    state->buf = buffer;
+    state->len = len;
+    state->windowBits = windowBits;
+    return self;
+}
+
+
+void Thingstream_Compress_getStats(ThingstreamTransport* self, ThingstreamCompressStats* stats)
+{
+    CompressState* state = (CompressState*)self->_state;
+    *stats = state->stats;
+}
+
+
+void Thingstream_Compress_resetStats(ThingstreamTransport* self)
+{
+    CompressState* state = (CompressState*)self->_state;
+    memset(&state->stats, 0, sizeof(state->stats));
+}
+
+
+/**
+ * Return the length of the header if the packet is a PUBLISH, else zero.
+ *
+ * @param data the packet
+ * @param len the length of the packet
+ * @return the length of the PUBLISH header, or zero
+ */
+static uint16_t publishHeaderLen(const uint8_t* data, uint16_t len)
+{
+    if ((len >= LONG_PUBLISH_HEADER_LEN) && (data[0] == MQTTSN_LONG_LENGTH)
+        && (data[3] == MQTTSN_PUBLISH))
+    {
+        return LONG_PUBLISH_HEADER_LEN;
+    }
+    if ((len >= SHORT_PUBLISH_HEADER_LEN) && (data[0] != MQTTSN_LONG_LENGTH)
+        && (data[1] == MQTTSN_PUBLISH))
+    {
+        return SHORT_PUBLISH_HEADER_LEN;
+    }
+    return 0;
+}
+
+/**
+ * Write a PUBLISH header in front of the payload, which starts
+ * #LONG_PUBLISH_HEADER_LEN bytes into the buffer, moving the payload down
+ * if the header is shorter.
+ *
+ * @param buf the buffer
+ * @param fields the header fields after the message type
+ * @param payloadLen the length of the payload
+ * @return the length of the packet, which starts at buf
+ */
+static uint16_t buildPublish(uint8_t* buf, const uint8_t* fields, uint16_t payloadLen)
+{
+    uint32_t packetLen = SHORT_PUBLISH_HEADER_LEN + (uint32_t)payloadLen;
+    uint8_t* p = buf;
+
+    if (packetLen > 0xFF)
+    {
+        packetLen = LONG_PUBLISH_HEADER_LEN + (uint32_t)payloadLen;
+        *p++ = MQTTSN_LONG_LENGTH;
+        *p++ = (uint8_t)(packetLen >> 8);
+    }
+    else
+    {
+        memmove(buf + SHORT_PUBLISH_HEADER_LEN, buf + LONG_PUBLISH_HEADER_LEN, payloadLen);
+    }
+    *p++ = (uint8_t)packetLen;
+    *p++ = MQTTSN_PUBLISH;
+    memcpy(p, fields, PUBLISH_FIELDS_LEN);
+    return (uint16_t)packetLen;
+}
+
+/**
+ * Restore the payload of a received PUBLISH packet, if it is compressed
+ * or marked, and pass the packet to the outer transport.
+ *
+ * @param cookie the compress state
+ * @param data a pointer to the data
+ * @param len the length of the data
+ */
+static void compress_callback(void* cookie, uint8_t* data, uint16_t len)
+{
+    CompressState* state = (CompressState*)cookie;
+    uint16_t headerLen;
+    uint8_t fields[PUBLISH_FIELDS_LEN];
+    const uint8_t* payload;
+    uint16_t payloadLen;
+    uint8_t* out;
+    uint16_t outLen;
+    int32_t n;
+
+    if (state->callback == NULL)
+    {
+        return;
+    }
+    headerLen = publishHeaderLen(data, len);
+    if ((headerLen == 0) || (len < headerLen + 2)
+        || (data[headerLen] != COMPRESS_MARKER)
+        || (state->len <= LONG_PUBLISH_HEADER_LEN))
+    {
+        state->callback(state->cookie, data, len);
+        return;
+    }
+
+    memcpy(fields, data + headerLen - PUBLISH_FIELDS_LEN, PUBLISH_FIELDS_LEN);
+    payload = data + headerLen;
+    payloadLen = (uint16_t)(len - headerLen);
+    out = state->buf + LONG_PUBLISH_HEADER_LEN;
+    outLen = (uint16_t)(state->len - LONG_PUBLISH_HEADER_LEN);
+
+    if (payload[1] == COMPRESS_STORED)
+    {
+        n = payloadLen - 2;
+        if (n > outLen)
+        {
+            n = -1;
+        }
+        else
+        {
+            memmove(out, payload + 2, (size_t)n);
+        }
+    }
+    else if (payloadLen > COMPRESS_HEADER_LEN)
+    {
+        uint16_t rawLen = (uint16_t)((payload[2] << 8) | payload[3]);
+        n = Thingstream_Lzss_decode(out, outLen,
+                                    payload + COMPRESS_HEADER_LEN,
+                                    (uint16_t)(payloadLen - COMPRESS_HEADER_LEN),
+                                    payload[1]);
+        if (n != (int32_t)rawLen)
+        {
+            n = -1;
+        }
+        else
+        {
+            ++state->stats.decompressed;
+        }
+    }
+    else
+    {
+        n = -1;
+    }
+    if (n < 0)
+    {
+        ++state->stats.decodeErrors;
+        return;
+    }
+    state->callback(state->cookie, state->buf,
+                    buildPublish(state->buf, fields, (uint16_t)n));
+}
+
+/**
+ * Initialize the transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param version the transport API version
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult compress_init(ThingstreamTransport* self, uint16_t version)
+{
+    CompressState* state = (CompressState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    ThingstreamTransportResult tRes;
+
+    if (!TRANSPORT_CHECK_VERSION_1(version))
+    {
+        return TRANSPORT_VERSION_MISMATCH;
+    }
+    tRes = inner->register_callback(inner, compress_callback, state);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return tRes;
+    }
+    return inner->init(inner, version);
+}
+
+/**
+ * Shutdown the transport (i.e. the opposite of initialize).
+ *
+ * @param self the #ThingstreamTransport instance
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult compress_shutdown(ThingstreamTransport* self)
+{
+    CompressState* state = (CompressState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    return inner->shutdown(inner);
+}
+
+/**
+ * Return this transport's buffer, shorter than the inner transport's
+ * buffer by the room that a marked payload and a longer PUBLISH header
+ * may need.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param buffer where to write the buffer pointer
+ * @param len where the write the buffer length
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult compress_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len)
+{
+    CompressState* state = (CompressState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    ThingstreamTransportResult tRes;
+    uint8_t* innerBuf;
+    uint16_t innerLen;
+
+    if (inner->get_buffer == NULL)
+    {
+        return TRANSPORT_ERROR;
+    }
+    tRes = inner->get_buffer(inner, &innerBuf, &innerLen);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return tRes;
+    }
+    if (innerLen <= COMPRESS_HEADER_LEN)
+    {
+        return TRANSPORT_ERROR;
+    }
+    innerLen -= COMPRESS_HEADER_LEN;
+    *buffer = state->buf;
+    *len = (state->len < innerLen) ? state->len : innerLen;
+    return TRANSPORT_SUCCESS;
+}
+
+/**
+ * Compress the payload of a PUBLISH packet into the inner transport's
+ * buffer and send the packet rebuilt around it, or send the packet
+ * unchanged if it is not a PUBLISH.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param flags an indication of the type of the data, zero is normal.
+ * @param data a pointer to the data
+ * @param len the length of the raw data
+ * @param millis the maximum number of milliseconds to run
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult compress_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis)
+{
+    CompressState* state = (CompressState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    ThingstreamCompressStats* stats = &state->stats;
+    ThingstreamTransportResult tRes;
+    uint8_t* innerBuf;
+    uint16_t innerLen;
+    uint16_t headerLen;
+    uint16_t sendLen = len;
+    uint32_t cycles = 0;
+
+    if (inner->get_buffer == NULL)
+    {
+        return TRANSPORT_ERROR;
+    }
+    tRes = inner->get_buffer(inner, &innerBuf, &innerLen);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return tRes;
+    }
+    if (len > innerLen)
+    {
+        return TRANSPORT_ILLEGAL_ARGUMENT;
+    }
+
+    headerLen = publishHeaderLen(data, len);
+    if (headerLen == 0)
+    {
+        memmove(innerBuf, data, len);
+    }
+    else
+    {
+        uint8_t fields[PUBLISH_FIELDS_LEN];
+        const uint8_t* payload = data + headerLen;
+        uint16_t payloadLen = (uint16_t)(len - headerLen);
+        uint8_t* out = innerBuf + LONG_PUBLISH_HEADER_LEN;
+        uint16_t outLen;
+        int32_t n = -1;
+
+        if (innerLen <= LONG_PUBLISH_HEADER_LEN + 2)
+        {
+            return TRANSPORT_ILLEGAL_ARGUMENT;
+        }
+        outLen = (uint16_t)(innerLen - LONG_PUBLISH_HEADER_LEN);
+        memcpy(fields, data + headerLen - PUBLISH_FIELDS_LEN, PUBLISH_FIELDS_LEN);
+
+        /* Compression must save at least one byte to be worthwhile, and
+         * cannot work in place, so a payload that is already in the inner
+         * transport's buffer is not compressed.
+         */
+        if ((payloadLen > COMPRESS_HEADER_LEN + 1)
+            && ((data + len <= innerBuf) || (data >= innerBuf + innerLen)))
+        {
+            uint16_t limit = (uint16_t)(payloadLen - COMPRESS_HEADER_LEN - 1);
+            uint32_t start = Platform_getCycleCount();
+            if (limit > outLen - COMPRESS_HEADER_LEN)
+            {
+                limit = (uint16_t)(outLen - COMPRESS_HEADER_LEN);
+            }
+            n = Thingstream_Lzss_encode(out + COMPRESS_HEADER_LEN, limit,
+                                        payload, payloadLen, state->windowBits);
+            cycles = Platform_getCycleCount() - start;
+        }
+        if (n > 0)
+        {
+            out[0] = COMPRESS_MARKER;
+            out[1] = state->windowBits;
+            out[2] = (uint8_t)(payloadLen >> 8);
+            out[3] = (uint8_t)payloadLen;
+            payloadLen = (uint16_t)(n + COMPRESS_HEADER_LEN);
+            ++stats->compressed;
+        }
+        else if ((payloadLen > 0) && (payload[0] == COMPRESS_MARKER))
+        {
+            /* Mark the payload so the receiver does not decompress it */
+            if (payloadLen + 2 > outLen)
+            {
+                return TRANSPORT_ILLEGAL_ARGUMENT;
+            }
+            memmove(out + 2, payload, payloadLen);
+            out[0] = COMPRESS_MARKER;
+            out[1] = COMPRESS_STORED;
+            payloadLen += 2;
+        }
+        else
+        {
+            if (payloadLen > outLen)
+            {
+                return TRANSPORT_ILLEGAL_ARGUMENT;
+            }
+            memmove(out, payload, payloadLen);
+        }
+        sendLen = buildPublish(innerBuf, fields, payloadLen);
+    }
+
+    ++stats->messages;
+    stats->bytesIn += len;
+    stats->bytesOut += sendLen;
+    stats->cycles += cycles;
+    if (cycles > stats->maxCycles)
+    {
+        stats->maxCycles = cycles;
+    }
+    stats->lastRawLen = len;
+    stats->lastSentLen = sendLen;
+    stats->lastCycles = cycles;
+
+    return inner->send(inner, flags, innerBuf, sendLen, millis);
+}
+
+/**
+ * Register a callback function that will be called when this transport
+ * has data to send to its next outermost ThingstreamTransport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param callback the callback function
+ * @param cookie a opaque value passed to the callback function
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult compress_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie)
+{
+    CompressState* state = (CompressState*)self->_state;
+    state->callback = callback;
+    state->cookie = cookie;
+    return TRANSPORT_SUCCESS;
+}
+
+/**
+ * Allow the inner transport to run for at most the given number of
+ * milliseconds.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param millis the maximum number of milliseconds to run (a value of zero
+ *        processes all pending operations).
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult compress_run(ThingstreamTransport* self, uint32_t millis)
+{
+    CompressState* state = (CompressState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    return inner->run(inner, millis);
+}
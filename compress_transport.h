@@ -0,0 +1,135 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Compression of MQTT-SN PUBLISH payloads with LZSS
+ *
+ * The compress transport sits between the client and the protocol
+ * transport. The payload of each PUBLISH packet is compressed on its own
+ * with Thingstream_Lzss_encode() and the packet is rebuilt around the
+ * payload
+ * <pre>
+ *   0x00  windowBits  length(2 bytes, big-endian)  compressed payload
+ * </pre>
+ * so the protocol transport and the server still see a valid PUBLISH
+ * packet. A payload that would not get shorter is sent unchanged, unless
+ * it starts with 0x00, when it is sent as
+ * <pre>
+ *   0x00  0x00  payload
+ * </pre>
+ * Other packets are sent unchanged. Received PUBLISH payloads in either
+ * form are restored, so the application that subscribes to the topic (and
+ * any other subscriber) must restore them in the same way.
+ */
+
+#ifndef INC_COMPRESS_TRANSPORT_H
+#define INC_COMPRESS_TRANSPORT_H
+
+#include <stdint.h>
+
+#include "transport_api.h"
+#include "lzss_codec.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * The length of the header in front of a compressed payload.
+ * @hideinitializer
+ */
+#define COMPRESS_HEADER_LEN 4
+
+/**
+ * The windowBits value of a payload that is sent unchanged after the
+ * 0x00 marker.
+ * @hideinitializer
+ */
+#define COMPRESS_STORED     0
+
+/**
+ * The statistics gathered by the compress transport.
+ */
+typedef struct ThingstreamCompressStats_s
+{
+    /** The number of packets sent */
+    uint32_t messages;
+    /** The number of PUBLISH packets sent with a compressed payload */
+    uint32_t compressed;
+    /** The number of bytes in the packets before compression */
+    uint32_t bytesIn;
+    /** The number of bytes sent, including the compression headers */
+    uint32_t bytesOut;
+    /** The number of processor cycles spent compressing */
+    uint32_t cycles;
+    /** The longest time to compress one packet, in processor cycles */
+    uint32_t maxCycles;
+    /** The length of the last packet before compression */
+    uint16_t lastRawLen;
+    /** The length of the last packet as sent */
+    uint16_t lastSentLen;
+    /** The processor cycles spent compressing the last packet */
+    uint32_t lastCycles;
+    /** The number of PUBLISH packets received with a compressed payload */
+    uint32_t decompressed;
+    /** The number of compressed payloads received that were not valid */
+    uint32_t decodeErrors;
+} ThingstreamCompressStats;
+
+/**
+ * Create a compress transport instance.
+ *
+ * The outer transport builds its packets in the given buffer, and received
+ * payloads are decompressed into it.
+ *
+ * @param inner the inner transport instance (e.g. the protocol transport)
+ * @param windowBits the size of the LZSS window as a number of bits, from
+ *   #LZSS_MIN_WINDOW_BITS (256 bytes) to #LZSS_MAX_WINDOW_BITS (2K bytes)
+ * @param buffer a buffer for the packets, at least as long as the buffer
+ *   of the inner transport
+ * @param len the length of the buffer
+ * @return the instance, or NULL if an argument is not valid
+ */
+extern ThingstreamTransport* Thingstream_createCompressTransport(ThingstreamTransport* inner, uint8_t windowBits, uint8_t* buffer, uint16_t len);
+
+/**
+ * Copy the statistics gathered since the transport was created or
+ * Thingstream_Compress_resetStats() was called.
+ *
+ * The compression ratio is bytesIn / bytesOut, and the per-packet cost is
+ * cycles / messages. The cycle counts are zero unless
+ * Platform_initCycleCounter() has been called.
+ *
+ * @param self this instance of compress transport
+ * @param stats where to copy the statistics
+ */
+extern void Thingstream_Compress_getStats(ThingstreamTransport* self, ThingstreamCompressStats* stats);
+
+/**
+ * Clear the statistics.
+ *
+ * @param self this instance of compress transport
+ */
+extern void Thingstream_Compress_resetStats(ThingstreamTransport* self);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_COMPRESS_TRANSPORT_H */
@@ -1,5 +1,5 @@
 /*
- * Copyright 2023-2024 Thingstream AG
+ * Copyright 2023-2026 Thingstream AG
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -39,6 +39,67 @@
 static uint8_t modemBuf[MODEM_BUFFER_LEN];
 /* ------------------------------------------------------ */
 
+/* ------ Setup buffers for modem socket transport ------ */
+#if (defined(MODEM_SOCKET_TRANSPARENT) && (MODEM_SOCKET_TRANSPARENT > 0))
+/* Define a buffer for use with the
+ * Thingstream_createModemSocketTransport() routine.
+ * It holds a socket command line until it ends.
+ */
+#ifndef MODEM_SOCKET_BUFFER_SIZE
+#define MODEM_SOCKET_BUFFER_SIZE MODEM_SOCKET_BUFFER_LEN
+#endif
+static uint8_t socketBuf[MODEM_SOCKET_BUFFER_SIZE];
+
+/* A buffer for datagrams received while the modem is in transparent
+ * mode, see Thingstream_ModemSocket_setTransparent().
+ */
+static uint8_t linkBuf[MODEM_UDP_BUFFER_LEN];
+#endif /* MODEM_SOCKET_TRANSPARENT */
+/* ------------------------------------------------------ */
+
+#if (defined(MODEM_USE_CMUX) && (MODEM_USE_CMUX > 0))
+/* ------------- Setup buffer for CMUX transport -------- */
+/* Define a buffer for use with the
+ * Thingstream_createCmuxTransport() routine.
+ * The modem must support 27.010 multiplexing (AT+CMUX).
+ */
+#ifndef CMUX_BUFFER_SIZE
+#define CMUX_BUFFER_SIZE CMUX_BUFFER_LEN
+#endif
+static uint8_t cmuxBuf[CMUX_BUFFER_SIZE];
+
+/* Saved 'CMUX transport', used to query the modem's signal quality
+ * on the control channel without waiting for the data channel.
+ */
+static ThingstreamTransport *cmux_transport;
+/* ------------------------------------------------------ */
+#endif /* MODEM_USE_CMUX */
+
+#if (defined(SIGNAL_SCHEDULER) && (SIGNAL_SCHEDULER > 0))
+/* ----------- Setup buffer for signal scheduler -------- */
+/* Define a buffer for use with the
+ * Thingstream_SignalScheduler_init() routine.
+ * It holds the publishes deferred while the signal is weak.
+ */
+#ifndef SIGNAL_SCHEDULER_BUFFER_SIZE
+#define SIGNAL_SCHEDULER_BUFFER_SIZE 256
+#endif
+static uint8_t schedulerBuf[SIGNAL_SCHEDULER_BUFFER_SIZE];
+
+/* The lowest AT+CSQ strength at which deferred publishes are sent */
+#ifndef SIGNAL_SCHEDULER_MIN_CSQ
+#define SIGNAL_SCHEDULER_MIN_CSQ 10
+#endif
+/* ------------------------------------------------------ */
+#endif /* SIGNAL_SCHEDULER */
+
+#if (defined(MODEM_STATS) && (MODEM_STATS > 0))
+/* Saved 'modem stats transport', used to report the modem's health
+ * after each publish.
+ */
+static ThingstreamTransport *stats_transport;
+#endif /* MODEM_STATS */
+
 /* ------------ Setup buffer for uart data  ------------ */
 /* Some targets need a buffer to store data read from the
  * modem before it can be processed by the SDK, e.g. if
@@ -99,6 +160,41 @@ void Platform_delayMillis(uint32_t millis)
     }
 }
 
+#if (defined(MODEM_STATS) && (MODEM_STATS > 0))
+/**
+ * Print a summary of the modem's health.
+ */
+static void report_modem_stats(void)
+{
+    static ThingstreamModemStats stats;
+    uint8_t i;
+
+    Thingstream_ModemStats_get(stats_transport, modem_transport, &stats);
+    Thingstream_Util_printf("modem: resets %d, registrations %d (last %dms), "
+                            "socket reopens %d, bytes %d/%d\n",
+                            (int)stats.forcedResets,
+                            (int)stats.registrations,
+                            (int)stats.lastRegistrationMs,
+                            (int)stats.socketReopens,
+                            (int)stats.bytesOut,
+                            (int)stats.bytesIn);
+    for (i = 0; i < stats.commandCount; ++i)
+    {
+        const ThingstreamModemCommandStats* command = &stats.commands[i];
+        Thingstream_Util_printf("  %s: %d sent, %d errors, max %dms\n",
+                                command->name, (int)command->count,
+                                (int)command->errors,
+                                (int)command->maxMs);
+    }
+    for (i = 0; i < stats.cmeCount; ++i)
+    {
+        Thingstream_Util_printf("  +CME ERROR %d: %d\n",
+                                (int)stats.cmeErrors[i].code,
+                                (int)stats.cmeErrors[i].count);
+    }
+}
+#endif /* MODEM_STATS */
+
 /**
  * Callback for receiving messages.
  * This will be called from within Thingstream_Client_run()
@@ -193,11 +289,45 @@ static void publish_and_get_messages(ThingstreamTransport *transport)
         static const char msg[] = "Hello, connect, send and receive";
 
         last_publish = now;
+#if (defined(SIGNAL_SCHEDULER) && (SIGNAL_SCHEDULER > 0))
+        /* The message is not urgent, it may wait for a better signal
+         * until half way to the next one.
+         */
+        result = Thingstream_SignalScheduler_publish(client, publish_topic,
+                                    ThingstreamQOS1, false,
+                                    (uint8_t*)msg, sizeof(msg)-1,
+                                    publish_interval*1000/2);
+#else
         result = Thingstream_Client_publish(client, publish_topic,
                                     ThingstreamQOS1, false,
                                     (uint8_t*)msg, sizeof(msg)-1);
+#endif /* SIGNAL_SCHEDULER */
         CHECK_CLIENT_SUCCESS("publish", result, disconnect);
+
+#if (defined(MODEM_USE_CMUX) && (MODEM_USE_CMUX > 0))
+        /* The +CSQ response is passed to
+         * Thingstream_Application_modemCallback()
+         */
+        (void) Thingstream_Cmux_sendLine(cmux_transport, "AT+CSQ", 1000);
+#endif /* MODEM_USE_CMUX */
+
+#if (defined(MODEM_STATS) && (MODEM_STATS > 0))
+        report_modem_stats();
+#endif /* MODEM_STATS */
+    }
+
+#if (defined(SIGNAL_SCHEDULER) && (SIGNAL_SCHEDULER > 0))
+    /* Send the deferred publishes once the signal allows */
+    if (Thingstream_SignalScheduler_pending() > 0)
+    {
+        result = Thingstream_SignalScheduler_run(client);
+        if ((result != CLIENT_SUCCESS)
+            || (Thingstream_SignalScheduler_pending() == 0))
+        {
+            CHECK_CLIENT_SUCCESS("deferred publish", result, disconnect);
+        }
     }
+#endif /* SIGNAL_SCHEDULER */
 
     /* As the client is in a Connected state, the server will send
      * any messages without further prompting.
@@ -243,6 +373,16 @@ ThingstreamClientResult run_example(ThingstreamTransport *transport,
                                                         sizeof(ringBuffer));
     CHECK("ring_buffer", transport != NULL);
 
+#if (defined(MODEM_USE_CMUX) && (MODEM_USE_CMUX > 0))
+    /* Carry the modem traffic on one CMUX channel, leaving another
+     * free for the application's status queries.
+     */
+    transport = Thingstream_createCmuxTransport(transport, cmuxBuf,
+                                                sizeof(cmuxBuf));
+    CHECK("cmux", transport != NULL);
+    cmux_transport = transport;
+#endif /* MODEM_USE_CMUX */
+
 #if (defined(DEBUG_LOG_MODEM) && (DEBUG_LOG_MODEM > 0))
     transport = Thingstream_createModemLogger(transport,
                                               Thingstream_Util_printf,
@@ -250,6 +390,27 @@ ThingstreamClientResult run_example(ThingstreamTransport *transport,
     CHECK("log_modem", transport != NULL);
 #endif /* DEBUG_LOG_MODEM */
 
+#if (defined(MODEM_STATS) && (MODEM_STATS > 0))
+    /* Gather the modem's health and error statistics. */
+    transport = Thingstream_createModemStatsTransport(transport);
+    CHECK("modem_stats", transport != NULL);
+    stats_transport = transport;
+#endif /* MODEM_STATS */
+
+#if (defined(MODEM_SOCKET_TRANSPARENT) && (MODEM_SOCKET_TRANSPARENT > 0))
+    transport = Thingstream_createModemSocketTransport(transport,
+                                                       modem_init,
+                                                       socketBuf,
+                                                       sizeof(socketBuf));
+    CHECK("modem_socket", transport != NULL);
+
+    /* The connected session exchanges datagrams without AT commands
+     * once the modem transport has opened its socket.
+     */
+    (void) Thingstream_ModemSocket_setTransparent(transport, linkBuf,
+                                                  sizeof(linkBuf), 0);
+#endif /* MODEM_SOCKET_TRANSPARENT */
+
     transport = Thingstream_createModemTransport(transport,
                                                  modem_flags,
                                                  modemBuf, sizeof(modemBuf),
@@ -261,7 +422,13 @@ ThingstreamClientResult run_example(ThingstreamTransport *transport,
      */
      modem_transport = transport;
 
-    /* Base 64 encoding is optional when using UDP. */
+#if (defined(SIGNAL_SCHEDULER) && (SIGNAL_SCHEDULER > 0))
+    Thingstream_SignalScheduler_init(modem_transport, schedulerBuf,
+                                     sizeof(schedulerBuf),
+                                     SIGNAL_SCHEDULER_MIN_CSQ);
+#endif /* SIGNAL_SCHEDULER */
+
+    /* Base 64 encoding is bypassed at init when the modem uses UDP. */
     transport = Thingstream_createBase64CodecTransport(transport);
     CHECK("base64", transport != NULL);
 
@@ -1,5 +1,5 @@
 /*
- * Copyright 2021-2024 Thingstream AG
+ * Copyright 2021-2026 Thingstream AG
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -140,7 +140,7 @@ ThingstreamClientResult run_example(ThingstreamTransport *transport,
 
     /* ------------- Continue with stack creation ---------- */
 
-    /* Base 64 encoding is optional when using UDP. */
+    /* Base 64 encoding is bypassed at init when the modem uses UDP. */
     transport = Thingstream_createBase64CodecTransport(transport);
     CHECK("base64", transport != NULL);
 
@@ -1,5 +1,5 @@
 /*
- * Copyright 2021-2024 Thingstream AG
+ * Copyright 2021-2026 Thingstream AG
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -22,6 +22,9 @@
 #include <string.h>
 
 #include "run_example.h"
+#if defined(ECHO_COMPRESS)
+#include "platform_cycles.h"
+#endif
 
 
 /* --------- Setup buffer for modem transport ---------- */
@@ -53,6 +56,28 @@ static uint8_t modemBuf[MODEM_BUFFER_LEN];
  */
 static ThingstreamTransport *modem_transport;
 
+#if defined(USSD_BATCH)
+/* ------------ Setup USSD session batching ------------- */
+/* The time to keep a USSD session open after an exchange, so that the
+ * subscribe, publish and echo share one session.
+ */
+#ifndef USSD_BATCH_LINGER_MS
+#define USSD_BATCH_LINGER_MS 10000
+#endif
+/* ------------------------------------------------------ */
+#endif /* USSD_BATCH */
+
+#if defined(ECHO_COMPRESS)
+/* ------------ Setup payload compression --------------- */
+/* The LZSS window as a number of bits, from 8 (256 bytes) to 11 (2K). */
+#ifndef COMPRESS_WINDOW_BITS
+#define COMPRESS_WINDOW_BITS 10
+#endif
+static uint8_t compressBuf[MODEM_BUFFER_LEN];
+static ThingstreamTransport *compress_transport;
+/* ------------------------------------------------------ */
+#endif /* ECHO_COMPRESS */
+
 
 /* Specify topic name. Will be used for publish and subscription. */
 #define EXAMPLE_TOPIC "test/thingstream/echo"
@@ -116,13 +141,39 @@ ThingstreamClientResult run_example(ThingstreamTransport *transport,
      */
     modem_transport = transport;
 
-    /* Base 64 encoding is optional when using UDP. */
+#if defined(USSD_BATCH)
+    /* Keep the USSD session open across the exchanges of the test. */
+    transport = Thingstream_createUssdBatchTransport(transport,
+                                                     USSD_BATCH_LINGER_MS);
+    CHECK("ussd_batch", transport != NULL);
+#endif /* USSD_BATCH */
+
+#if (defined(DEBUG_FORCE_BASE85) && (DEBUG_FORCE_BASE85 > 0))
+    /* Base 85 fits more in each USSD frame. It is not negotiated, so only
+     * use this against a gateway known to accept it.
+     */
+    transport = Thingstream_createForcedBase85CodecTransport(transport);
+    CHECK("base85", transport != NULL);
+#else
+    /* Base 64 encoding is bypassed at init when the modem uses UDP. */
     transport = Thingstream_createBase64CodecTransport(transport);
     CHECK("base64", transport != NULL);
+#endif /* DEBUG_FORCE_BASE85 */
 
     transport = Thingstream_createProtocolTransport(transport, NULL, 0);
     CHECK("thingstream", transport != NULL);
 
+#if defined(ECHO_COMPRESS)
+    /* Compress each PUBLISH payload; the echo is restored on receipt. */
+    transport = Thingstream_createCompressTransport(transport,
+                                                    COMPRESS_WINDOW_BITS,
+                                                    compressBuf,
+                                                    sizeof(compressBuf));
+    CHECK("compress", transport != NULL);
+    compress_transport = transport;
+    (void)Platform_initCycleCounter();
+#endif /* ECHO_COMPRESS */
+
 #if (defined(DEBUG_LOG_CLIENT) && (DEBUG_LOG_CLIENT > 0))
     transport = Thingstream_createClientLogger(transport,
                                                Thingstream_Util_printf,
@@ -172,6 +223,16 @@ ThingstreamClientResult run_example(ThingstreamTransport *transport,
     }
     while (TIME_COMPARE(now, <, limit) && !msg_received);
 
+#if defined(ECHO_COMPRESS)
+    ThingstreamCompressStats stats;
+    Thingstream_Compress_getStats(compress_transport, &stats);
+    Thingstream_Util_printf("Compressed %d of %d packets, %d bytes to %d,"
+                            " %d cycles per packet\n",
+                            (int)stats.compressed, (int)stats.messages,
+                            (int)stats.bytesIn, (int)stats.bytesOut,
+                            (int)(stats.messages ? stats.cycles / stats.messages : 0));
+#endif /* ECHO_COMPRESS */
+
     ThingstreamClientResult cr;
 disconnect:
     cr = Thingstream_Client_disconnect(client, 0);
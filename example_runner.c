@@ -1,5 +1,5 @@
 /*
- * Copyright 2019-2022 Thingstream AG
+ * Copyright 2019-2026 Thingstream AG
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -26,6 +26,23 @@
 /** Optional modem flags to pass to Thingstream_createModemTransport() */
 static uint32_t modem_flags;
 
+/** The time allowed for the modem to boot and report its model */
+#ifndef MODEM_DETECT_MILLIS
+#define MODEM_DETECT_MILLIS 30000
+#endif
+
+/*
+ * Define MODEM_ATTACH to 1 to try the operator used before the reset,
+ * see Thingstream_ModemDetect_attach(). It needs Platform_storageRead()
+ * and Platform_storageWrite() to be overridden with non-volatile storage
+ * to keep the operator across the reset.
+ */
+
+/** The time allowed for the modem to try the last known operator */
+#ifndef MODEM_ATTACH_MILLIS
+#define MODEM_ATTACH_MILLIS 60000
+#endif
+
 /*
  * Run Thingstream example.
  */
@@ -50,6 +67,26 @@ void runApplication()
     }
     else
     {
-        (void)run_example(transport, UDP_MODEM_INIT, modem_flags);
+        ThingstreamModemUdpInit* modem_init = UDP_MODEM_INIT;
+
+        /* If UDP_MODEM_INIT is Thingstream_ModemDetectInit, ask the modem
+         * which model it is and use the matching initialisation routine.
+         * A modem fixed at build time is used as it is, without talking
+         * to the modem before the stack is initialised.
+         */
+        if (modem_init == Thingstream_ModemDetectInit)
+        {
+            transport = Thingstream_createModemDetectTransport(transport);
+            modem_init = Thingstream_ModemDetect_select(transport, modem_init,
+                                                        MODEM_DETECT_MILLIS);
+
+#if (defined(MODEM_ATTACH) && (MODEM_ATTACH > 0))
+            /* Try the operator used before the reset, rather than a full
+             * operator search
+             */
+            (void)Thingstream_ModemDetect_attach(transport, MODEM_ATTACH_MILLIS);
+#endif /* MODEM_ATTACH */
+        }
+        (void)run_example(transport, modem_init, modem_flags);
     }
 }
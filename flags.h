@@ -1,5 +1,5 @@
 /*
- * Copyright 2021-2022 Thingstream AG
+ * Copyright 2021-2026 Thingstream AG
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -27,6 +27,8 @@
 /* Specify the modem initialisation routine to be passed
  * to Thingstream_createModemTransport().
  * Default is USSD.
+ * Use Thingstream_ModemDetectInit to detect the fitted modem at
+ * startup (see modem_detect.h).
  */
 #define UDP_MODEM_INIT Thingstream_UssdInit
 
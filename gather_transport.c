@@ -0,0 +1,286 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Scatter-gather publish implemented with a ThingstreamTransport
+ * instance
+ *
+ * The client builds a PUBLISH packet at the start of the buffer returned
+ * by get_buffer() and copies the payload in after the header. The payload
+ * given to Thingstream_Client_publish() is the unused tail of the same
+ * buffer, so that the client's copy cannot overlap its destination, and
+ * this transport gathers the segments over the copied bytes as each
+ * PUBLISH packet is sent. The client's copy of those stand-in bytes is
+ * wasted work, so this saves the application's staging buffer but not the
+ * copy, and halves the longest payload. Gathering at send time means that
+ * a retransmission is correct even if the buffer was used for other
+ * packets while waiting for the acknowledgement.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "gather_transport.h"
+
+/** The MQTT-SN PUBLISH message type */
+#define MQTTSN_PUBLISH          0x0C
+
+/** The MQTT-SN length byte that introduces a 3-byte length */
+#define MQTTSN_LONG_LENGTH      0x01
+
+/**
+ * The offset of the payload in the buffer. The client builds the PUBLISH
+ * header with a 3-byte length and, when the packet is short, sends it from
+ * the last length byte.
+ */
+#define PUBLISH_PAYLOAD_OFFSET  9
+
+/** The length of a PUBLISH header with a 1-byte length */
+#define SHORT_PUBLISH_HEADER_LEN 7
+
+/**
+ * The GatherState structure is used to store state for the gather
+ * transport.
+ */
+typedef struct GatherState_s
+{
+    /** The inner transport */
+    ThingstreamTransport* inner;
+    /** The segments of the publish in progress, or NULL */
+    const ThingstreamSegment* segments;
+    /** The number of segments */
+    uint8_t count;
+    /** The total length of the segments */
+    uint16_t payloadLen;
+} GatherState;
+
+/** Instance of GatherState */
+static GatherState _gather_transport_state;
+
+static ThingstreamTransportResult gather_init(ThingstreamTransport* self, uint16_t version);
+static ThingstreamTransportResult gather_shutdown(ThingstreamTransport* self);
+static ThingstreamTransportResult gather_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len);
+static ThingstreamTransportResult gather_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis);
+static ThingstreamTransportResult gather_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie);
+static ThingstreamTransportResult gather_run(ThingstreamTransport* self, uint32_t millis);
+
+/** Instance of ThingstreamTransport for the gather transport */
+static const ThingstreamTransport _gather_transport_instance = {
+    (ThingstreamTransportState_t*)&_gather_transport_state,
+    gather_init,
+    gather_shutdown,
+    gather_get_buffer,
+    NULL, /* This slot no longer used */
+    gather_send,
+    gather_register_callback,
+    NULL, /* This slot no longer used */
+    gather_run
+};
+
+
+ThingstreamTransport* Thingstream_createGatherTransport(ThingstreamTransport* inner)
+{
+    ThingstreamTransport* self = (ThingstreamTransport*)&_gather_transport_instance;
+    GatherState* state = (GatherState*)self->_state;
+
+    if (inner == NULL)
+    {
+        return NULL;
+    }
+    memset(state, 0, sizeof(*state));
+    state->inner = inner;
+    return self;
+}
+
+
+ThingstreamClientResult Thingstream_Client_publishv(ThingstreamClient* client, ThingstreamTopic topic, ThingstreamQualityOfService_t qos, bool retained, const ThingstreamSegment* segments, uint8_t count)
+{
+    ThingstreamTransport* self = (ThingstreamTransport*)&_gather_transport_instance;
+    GatherState* state = (GatherState*)self->_state;
+    ThingstreamTransportResult tRes;
+    ThingstreamClientResult cRes;
+    uint32_t payloadLen = 0;
+    uint8_t* buf;
+    uint16_t bufLen;
+    uint8_t i;
+
+    if ((state->inner == NULL) || (state->segments != NULL)
+        || ((segments == NULL) && (count > 0)))
+    {
+        return CLIENT_ILLEGAL_ARGUMENT;
+    }
+    for (i = 0; i < count; ++i)
+    {
+        payloadLen += segments[i].len;
+    }
+    if (payloadLen > UINT16_MAX)
+    {
+        return CLIENT_PUBLISH_TOO_LONG;
+    }
+    if (count == 1)
+    {
+        /* Nothing to gather, the client copies the only segment */
+        return Thingstream_Client_publish(client, topic, qos, retained,
+                                          (uint8_t*)segments[0].data,
+                                          segments[0].len);
+    }
+    tRes = gather_get_buffer(self, &buf, &bufLen);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return (ThingstreamClientResult)tRes;
+    }
+
+    /* The client copies the payload it is given to the buffer at
+     * PUBLISH_PAYLOAD_OFFSET, and memcpy() must not be given overlapping
+     * memory. It is given the tail of the buffer, beyond the packet, whose
+     * bytes are then replaced by the segments in gather_send(). The payload
+     * and its stand-in must both fit, which halves the longest payload.
+     */
+    if (PUBLISH_PAYLOAD_OFFSET + 2 * payloadLen > bufLen)
+    {
+        return CLIENT_PUBLISH_TOO_LONG;
+    }
+    state->segments = segments;
+    state->count = count;
+    state->payloadLen = (uint16_t)payloadLen;
+    cRes = Thingstream_Client_publish(client, topic, qos, retained,
+                                      buf + bufLen - payloadLen,
+                                      (uint16_t)payloadLen);
+    state->segments = NULL;
+    return cRes;
+}
+
+
+/**
+ * Initialize the transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param version the transport API version
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult gather_init(ThingstreamTransport* self, uint16_t version)
+{
+    GatherState* state = (GatherState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+
+    if (!TRANSPORT_CHECK_VERSION_1(version))
+    {
+        return TRANSPORT_VERSION_MISMATCH;
+    }
+    state->segments = NULL;
+    return inner->init(inner, version);
+}
+
+/**
+ * Shutdown the transport (i.e. the opposite of initialize).
+ *
+ * @param self the #ThingstreamTransport instance
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult gather_shutdown(ThingstreamTransport* self)
+{
+    GatherState* state = (GatherState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    return inner->shutdown(inner);
+}
+
+/**
+ * Pass the buffer request to the inner transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param buffer where to write the buffer pointer
+ * @param len where the write the buffer length
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult gather_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len)
+{
+    GatherState* state = (GatherState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    if (inner->get_buffer == NULL)
+    {
+        return TRANSPORT_ERROR;
+    }
+    return inner->get_buffer(inner, buffer, len);
+}
+
+/**
+ * Gather the segments into the payload of a PUBLISH packet from
+ * Thingstream_Client_publishv(), then send the data to the inner
+ * transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param flags an indication of the type of the data, zero is normal.
+ * @param data a pointer to the data
+ * @param len the length of the raw data
+ * @param millis the maximum number of milliseconds to run
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult gather_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis)
+{
+    GatherState* state = (GatherState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+
+    if ((state->segments != NULL) && (len >= 2))
+    {
+        uint8_t type = (data[0] == MQTTSN_LONG_LENGTH) ? data[3] : data[1];
+        if ((type == MQTTSN_PUBLISH) && (len >= state->payloadLen + SHORT_PUBLISH_HEADER_LEN))
+        {
+            /* The payload is the end of the packet */
+            uint8_t* p = data + len - state->payloadLen;
+            uint8_t i;
+            for (i = 0; i < state->count; ++i)
+            {
+                memcpy(p, state->segments[i].data, state->segments[i].len);
+                p += state->segments[i].len;
+            }
+        }
+    }
+    return inner->send(inner, flags, data, len, millis);
+}
+
+/**
+ * Register a callback function that will be called when this transport
+ * has data to send to its next outermost ThingstreamTransport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param callback the callback function
+ * @param cookie a opaque value passed to the callback function
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult gather_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie)
+{
+    GatherState* state = (GatherState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    return inner->register_callback(inner, callback, cookie);
+}
+
+/**
+ * Allow the inner transport to run for at most the given number of
+ * milliseconds.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param millis the maximum number of milliseconds to run (a value of zero
+ *        processes all pending operations).
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult gather_run(ThingstreamTransport* self, uint32_t millis)
+{
+    GatherState* state = (GatherState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    return inner->run(inner, millis);
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Scatter-gather publish of a payload held in several segments
+ *
+ * Thingstream_Client_publishv() publishes a payload that is made up of
+ * several separate pieces of memory (e.g. a header, a sensor structure and
+ * a trailer) without first joining them in an application buffer. What is
+ * saved is that staging buffer, not any copying: the client still copies
+ * a payload of the full length into the packet, taken from the unused end
+ * of the transport buffer, and the gather transport then copies the
+ * segments over it as the packet is sent. Because the stand-in payload
+ * and the packet share the transport buffer, a payload of more than one
+ * segment may be at most (buffer length - 9) / 2 bytes long, half the
+ * longest payload of Thingstream_Client_publish().
+ */
+
+#ifndef INC_GATHER_TRANSPORT_H
+#define INC_GATHER_TRANSPORT_H
+
+#include <stdint.h>
+
+#include "client_api.h"
+#include "transport_api.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * A segment of the payload passed to Thingstream_Client_publishv().
+ */
+typedef struct ThingstreamSegment_s
+{
+    /** The data of the segment */
+    const uint8_t* data;
+    /** The length of the data */
+    uint16_t len;
+} ThingstreamSegment;
+
+/**
+ * Create a gather transport instance.
+ * This must be the transport passed to Thingstream_createClient(), i.e.
+ * created last, outside any client logger.
+ *
+ * @param inner the inner transport instance (e.g. the client logger or
+ *   protocol transport)
+ * @return the instance
+ */
+extern ThingstreamTransport* Thingstream_createGatherTransport(ThingstreamTransport* inner);
+
+/**
+ * Publish a message whose payload is the concatenation of the given
+ * segments.
+ * The client must have been created on the gather transport. Apart from
+ * the payload the behaviour and results are those of
+ * Thingstream_Client_publish().
+ *
+ * @param client the client instance
+ * @param topic the topic to publish to
+ * @param qos the quality of service
+ * @param retained true if the server should retain the message
+ * @param segments the segments of the payload
+ * @param count the number of segments
+ * @return the #ThingstreamClientResult of the publish, or
+ *   #CLIENT_PUBLISH_TOO_LONG if the payload of several segments is longer
+ *   than (buffer length - 9) / 2 bytes
+ */
+extern ThingstreamClientResult Thingstream_Client_publishv(ThingstreamClient* client, ThingstreamTopic topic, ThingstreamQualityOfService_t qos, bool retained, const ThingstreamSegment* segments, uint8_t count);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_GATHER_TRANSPORT_H */
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Benchmark of the bulk hex codec against a per-character codec
+ *
+ * This example does not use the modem. It times the conversion of a
+ * socket sized payload to and from hex, first with a conventional
+ * table lookup / per-character branch codec and then with
+ * Thingstream_Hex_encode() and Thingstream_Hex_decode(), and reports the
+ * throughput of each.
+ */
+
+#include <string.h>
+
+#include "run_example.h"
+#include "hex_codec.h"
+#include "platform_cycles.h"
+
+/** The size of the payload converted in each round */
+#ifndef BENCH_PAYLOAD_LEN
+#define BENCH_PAYLOAD_LEN 512
+#endif
+
+/** The number of rounds timed for each codec */
+#ifndef BENCH_ROUNDS
+#define BENCH_ROUNDS 200
+#endif
+
+static uint8_t payload[BENCH_PAYLOAD_LEN];
+static char hexText[2 * BENCH_PAYLOAD_LEN];
+static uint8_t decoded[BENCH_PAYLOAD_LEN];
+
+/**
+ * Reference encoder: one table lookup per nibble.
+ */
+static char* scalarEncode(char* buf, const uint8_t* data, uint16_t len)
+{
+    static const char hexDigits[] = "0123456789ABCDEF";
+    while (len-- > 0)
+    {
+        uint8_t b = *data++;
+        *buf++ = hexDigits[b >> 4];
+        *buf++ = hexDigits[b & 0xf];
+    }
+    return buf;
+}
+
+/**
+ * Reference decoder: branches on the class of each character.
+ */
+static int32_t scalarDecode(uint8_t* buf, const char* hex, uint16_t hexLen)
+{
+    uint16_t i;
+    if ((hexLen & 1) != 0)
+    {
+        return -1;
+    }
+    for (i = 0; i < hexLen; ++i)
+    {
+        char ch = hex[i];
+        uint8_t value;
+        if ((ch >= '0') && (ch <= '9'))
+            value = ch - '0';
+        else if ((ch >= 'A') && (ch <= 'F'))
+            value = ch - 'A' + 10;
+        else if ((ch >= 'a') && (ch <= 'f'))
+            value = ch - 'a' + 10;
+        else
+            return -1;
+        if ((i & 1) == 0)
+            buf[i / 2] = value << 4;
+        else
+            buf[i / 2] |= value;
+    }
+    return hexLen / 2;
+}
+
+typedef enum { ENCODE_SCALAR, ENCODE_BULK, DECODE_SCALAR, DECODE_BULK } BenchCase;
+
+static const char* const benchNames[] = {
+    "encode scalar", "encode bulk", "decode scalar", "decode bulk"
+};
+
+/**
+ * Time one codec and print its throughput.
+ *
+ * @param which the codec to time
+ * @param haveCycles true if the cycle counter is running
+ */
+static void bench(BenchCase which, bool haveCycles)
+{
+    uint32_t startMs = Thingstream_Platform_getTimeMillis();
+    uint32_t startCycles = Platform_getCycleCount();
+    uint16_t round;
+
+    for (round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        switch (which)
+        {
+        case ENCODE_SCALAR:
+            (void)scalarEncode(hexText, payload, sizeof(payload));
+            break;
+        case ENCODE_BULK:
+            (void)Thingstream_Hex_encode(hexText, payload, sizeof(payload));
+            break;
+        case DECODE_SCALAR:
+            (void)scalarDecode(decoded, hexText, sizeof(hexText));
+            break;
+        case DECODE_BULK:
+            (void)Thingstream_Hex_decode(decoded, hexText, sizeof(hexText));
+            break;
+        }
+    }
+
+    uint32_t cycles = Platform_getCycleCount() - startCycles;
+    uint32_t millis = Thingstream_Platform_getTimeMillis() - startMs;
+    uint32_t bytes = (uint32_t)BENCH_ROUNDS * BENCH_PAYLOAD_LEN;
+
+    if (haveCycles && (cycles > 0))
+    {
+        /* bytes per cycle, reported in thousandths */
+        Thingstream_Util_printf("%s: %d payload bytes, %d cycles, %d.%03d bytes/cycle\n",
+                                benchNames[which], bytes, cycles,
+                                (int)(bytes / cycles),
+                                (int)(((uint64_t)(bytes % cycles) * 1000) / cycles));
+    }
+    else
+    {
+        Thingstream_Util_printf("%s: %d payload bytes, %d ms\n",
+                                benchNames[which], bytes, millis);
+    }
+}
+
+/**
+ * Run the hex codec benchmark. The transport is not used.
+ */
+ThingstreamClientResult run_example(ThingstreamTransport *transport,
+                        ThingstreamModemUdpInit *modem_init,
+                        uint16_t modem_flags)
+{
+    ThingstreamClientResult result = CLIENT_ILLEGAL_ARGUMENT;
+    uint32_t seed = 12345;
+    uint16_t i;
+
+    UNUSED(transport);
+    UNUSED(modem_init);
+    UNUSED(modem_flags);
+
+    for (i = 0; i < sizeof(payload); ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        payload[i] = (uint8_t)(seed >> 16);
+    }
+
+    bool haveCycles = Platform_initCycleCounter();
+
+    /* Check that both codecs agree before timing them */
+    (void)scalarEncode(hexText, payload, sizeof(payload));
+    memset(decoded, 0, sizeof(decoded));
+    CHECK("bulk decode",
+          (Thingstream_Hex_decode(decoded, hexText, sizeof(hexText)) == sizeof(payload))
+          && (memcmp(decoded, payload, sizeof(payload)) == 0));
+    memset(hexText, 0, sizeof(hexText));
+    (void)Thingstream_Hex_encode(hexText, payload, sizeof(payload));
+    memset(decoded, 0, sizeof(decoded));
+    CHECK("bulk encode",
+          (scalarDecode(decoded, hexText, sizeof(hexText)) == sizeof(payload))
+          && (memcmp(decoded, payload, sizeof(payload)) == 0));
+
+    bench(ENCODE_SCALAR, haveCycles);
+    bench(ENCODE_BULK, haveCycles);
+    bench(DECODE_SCALAR, haveCycles);
+    bench(DECODE_BULK, haveCycles);
+
+    result = CLIENT_SUCCESS;
+
+error:
+    return result;
+}
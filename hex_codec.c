@@ -0,0 +1,279 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Bulk conversion of binary data to and from hex text
+ *
+ * The portable code treats a 32-bit word as four byte lanes (SWAR). A hex
+ * digit is produced from a nibble n as n + '0' + 7 * (n > 9), where the
+ * comparison is taken from bit 4 of n + 6, so no lane can carry into the
+ * next. Decoding takes the low nibble of each character and adds 9 for
+ * letters (bit 6 set). Characters are validated by lane-wise range checks
+ * and any failure is reported once at the end, keeping the loops free of
+ * per-character branches.
+ */
+
+#include <stddef.h>
+
+#include "hex_codec.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/** A 32-bit word with each byte lane set to one */
+#define LANES_1         0x01010101u
+
+/** A 32-bit word with the top bit of each byte lane set */
+#define LANES_80        0x80808080u
+
+/**
+ * For each byte lane of c below 0x80, set the top bit if the lane is >= m.
+ */
+#define LANES_GE(c, m)  ((c) + (0x80u - (m)) * LANES_1)
+
+/**
+ * For each byte lane of c below 0x80, set the top bit if the lane is <= n.
+ */
+#define LANES_LE(c, n)  ((0x80u + (n)) * LANES_1 - (c))
+
+/**
+ * Convert each byte lane (0 to 15) to its upper case hex digit.
+ */
+static inline uint32_t nibblesToHex(uint32_t n)
+{
+    uint32_t letter = ((n + 0x06u * LANES_1) >> 4) & LANES_1;
+    return n + '0' * LANES_1 + letter * 7u;
+}
+
+/**
+ * Return a non-zero value if any byte lane of c is not a hex digit.
+ * A lane with its top bit set may disturb the other lanes' checks, but
+ * the word is then reported as invalid regardless.
+ */
+static inline uint32_t hexInvalid(uint32_t c)
+{
+    uint32_t lower = c | (0x20u * LANES_1);
+    uint32_t digit = LANES_GE(c, '0') & LANES_LE(c, '9');
+    uint32_t alpha = LANES_GE(lower, 'a') & LANES_LE(lower, 'f');
+    return (~(digit | alpha) | c) & LANES_80;
+}
+
+/**
+ * Convert each byte lane holding a hex digit to its value, and pack
+ * lanes 0,1 into the low byte and lanes 2,3 into the third byte.
+ */
+static inline uint32_t hexToBytes(uint32_t c)
+{
+    uint32_t v = (c & (0x0fu * LANES_1)) + ((c >> 6) & LANES_1) * 9u;
+    return (v << 4) | (v >> 8);
+}
+
+#if defined(__SSE2__)
+
+static inline __m128i sse2NibblesToHex(__m128i n)
+{
+    __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(n, _mm_set1_epi8(9)),
+                                   _mm_set1_epi8(7));
+    return _mm_add_epi8(n, _mm_add_epi8(_mm_set1_epi8('0'), letter));
+}
+
+/**
+ * Convert 16 hex characters to their values, clearing lanes of *pOk
+ * that are not hex digits.
+ */
+static inline __m128i sse2HexValues(__m128i c, __m128i* pOk)
+{
+    __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                                  _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+    __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                  _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    *pOk = _mm_and_si128(*pOk, _mm_or_si128(digit, alpha));
+    return _mm_add_epi8(_mm_and_si128(c, _mm_set1_epi8(0x0f)),
+                        _mm_and_si128(alpha, _mm_set1_epi8(9)));
+}
+
+/**
+ * Pack pairs of hex values into bytes, leaving each in the low byte of
+ * a 16-bit lane.
+ */
+static inline __m128i sse2PackPairs(__m128i v)
+{
+    __m128i pair = _mm_or_si128(_mm_slli_epi16(v, 4), _mm_srli_epi16(v, 8));
+    return _mm_and_si128(pair, _mm_set1_epi16(0x00ff));
+}
+
+#elif defined(__ARM_NEON)
+
+static inline uint8x16_t neonNibblesToHex(uint8x16_t n)
+{
+    uint8x16_t letter = vandq_u8(vcgtq_u8(n, vdupq_n_u8(9)), vdupq_n_u8(7));
+    return vaddq_u8(n, vaddq_u8(vdupq_n_u8('0'), letter));
+}
+
+/**
+ * Convert 16 hex characters to their values, clearing lanes of *pOk
+ * that are not hex digits.
+ */
+static inline uint8x16_t neonHexValues(uint8x16_t c, uint8x16_t* pOk)
+{
+    uint8x16_t lower = vorrq_u8(c, vdupq_n_u8(0x20));
+    uint8x16_t digit = vandq_u8(vcgeq_u8(c, vdupq_n_u8('0')),
+                                vcleq_u8(c, vdupq_n_u8('9')));
+    uint8x16_t alpha = vandq_u8(vcgeq_u8(lower, vdupq_n_u8('a')),
+                                vcleq_u8(lower, vdupq_n_u8('f')));
+    *pOk = vandq_u8(*pOk, vorrq_u8(digit, alpha));
+    return vaddq_u8(vandq_u8(c, vdupq_n_u8(0x0f)),
+                    vandq_u8(alpha, vdupq_n_u8(9)));
+}
+
+#endif /* __ARM_NEON */
+
+
+char *Thingstream_Hex_encode(char *buf, const uint8_t *data, uint16_t len)
+{
+#if defined(__SSE2__)
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    while (len >= 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)data);
+        __m128i hi = sse2NibblesToHex(_mm_and_si128(_mm_srli_epi16(x, 4), mask));
+        __m128i lo = sse2NibblesToHex(_mm_and_si128(x, mask));
+        _mm_storeu_si128((__m128i*)buf, _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i*)(buf + 16), _mm_unpackhi_epi8(hi, lo));
+        data += 16;
+        buf += 32;
+        len -= 16;
+    }
+#elif defined(__ARM_NEON)
+    while (len >= 16)
+    {
+        uint8x16_t x = vld1q_u8(data);
+        uint8x16x2_t hex;
+        hex.val[0] = neonNibblesToHex(vshrq_n_u8(x, 4));
+        hex.val[1] = neonNibblesToHex(vandq_u8(x, vdupq_n_u8(0x0f)));
+        vst2q_u8((uint8_t*)buf, hex);
+        data += 16;
+        buf += 32;
+        len -= 16;
+    }
+#endif /* __ARM_NEON */
+
+    while (len >= 4)
+    {
+        uint32_t w = (uint32_t)data[0]
+                   | ((uint32_t)data[1] << 8)
+                   | ((uint32_t)data[2] << 16)
+                   | ((uint32_t)data[3] << 24);
+        uint32_t hi = nibblesToHex((w >> 4) & (0x0fu * LANES_1));
+        uint32_t lo = nibblesToHex(w & (0x0fu * LANES_1));
+        buf[0] = (char)hi;
+        buf[1] = (char)lo;
+        buf[2] = (char)(hi >> 8);
+        buf[3] = (char)(lo >> 8);
+        buf[4] = (char)(hi >> 16);
+        buf[5] = (char)(lo >> 16);
+        buf[6] = (char)(hi >> 24);
+        buf[7] = (char)(lo >> 24);
+        data += 4;
+        buf += 8;
+        len -= 4;
+    }
+    while (len > 0)
+    {
+        uint32_t b = *data++;
+        *buf++ = (char)nibblesToHex(b >> 4);
+        *buf++ = (char)nibblesToHex(b & 0x0fu);
+        len--;
+    }
+    return buf;
+}
+
+
+int32_t Thingstream_Hex_decode(uint8_t *buf, const char *hex, uint16_t hexLen)
+{
+    const uint8_t* in = (const uint8_t*)hex;
+    uint8_t* out = buf;
+    uint32_t bad = 0;
+
+    if ((hexLen & 1) != 0)
+    {
+        return -1;
+    }
+
+    /* Each block is loaded before its output is stored, and the output
+     * never moves ahead of the input, so in place decoding is safe.
+     */
+#if defined(__SSE2__)
+    __m128i ok = _mm_set1_epi8(-1);
+    while (hexLen >= 32)
+    {
+        __m128i a = sse2HexValues(_mm_loadu_si128((const __m128i*)in), &ok);
+        __m128i b = sse2HexValues(_mm_loadu_si128((const __m128i*)(in + 16)), &ok);
+        _mm_storeu_si128((__m128i*)out,
+                         _mm_packus_epi16(sse2PackPairs(a), sse2PackPairs(b)));
+        in += 32;
+        out += 16;
+        hexLen -= 32;
+    }
+    bad = (uint32_t)(_mm_movemask_epi8(ok) ^ 0xffff);
+#elif defined(__ARM_NEON)
+    uint8x16_t ok = vdupq_n_u8(0xff);
+    while (hexLen >= 32)
+    {
+        uint8x16x2_t c = vld2q_u8(in);
+        uint8x16_t hi = neonHexValues(c.val[0], &ok);
+        uint8x16_t lo = neonHexValues(c.val[1], &ok);
+        vst1q_u8(out, vorrq_u8(vshlq_n_u8(hi, 4), lo));
+        in += 32;
+        out += 16;
+        hexLen -= 32;
+    }
+    uint64x2_t ok64 = vreinterpretq_u64_u8(ok);
+    bad = ((vgetq_lane_u64(ok64, 0) & vgetq_lane_u64(ok64, 1)) != UINT64_MAX);
+#endif /* __ARM_NEON */
+
+    while (hexLen >= 4)
+    {
+        uint32_t c = (uint32_t)in[0]
+                   | ((uint32_t)in[1] << 8)
+                   | ((uint32_t)in[2] << 16)
+                   | ((uint32_t)in[3] << 24);
+        uint32_t pair = hexToBytes(c);
+        bad |= hexInvalid(c);
+        out[0] = (uint8_t)pair;
+        out[1] = (uint8_t)(pair >> 16);
+        in += 4;
+        out += 2;
+        hexLen -= 4;
+    }
+    if (hexLen > 0)
+    {
+        uint32_t c = (uint32_t)in[0] | ((uint32_t)in[1] << 8);
+        bad |= hexInvalid(c) & 0x8080u;
+        *out++ = (uint8_t)hexToBytes(c);
+    }
+
+    if (bad != 0)
+    {
+        return -1;
+    }
+    return (int32_t)(out - buf);
+}
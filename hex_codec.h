@@ -0,0 +1,65 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Bulk conversion of binary data to and from hex text
+ *
+ * Unlike Thingstream_Util_sprintfHex() and Thingstream_Util_parseHex(),
+ * which convert a single number, these routines convert whole payloads.
+ * They work on 32-bit words without per-character branches, and use SSE2
+ * or NEON when built for a host that has them.
+ */
+
+#ifndef INC_HEX_CODEC_H
+#define INC_HEX_CODEC_H
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * Convert binary data to upper case hex text.
+ * Note that the result is not 0-terminated.
+ * @param buf buffer to receive the text, at least 2 * len bytes. It must
+ *    not overlap the data.
+ * @param data the binary data
+ * @param len the length of the binary data
+ * @return a pointer to just after the last byte of the conversion.
+ */
+extern char *Thingstream_Hex_encode(char *buf, const uint8_t *data, uint16_t len);
+
+/**
+ * Convert hex text (upper or lower case) to binary data.
+ * The conversion may be done in place by passing the same address as buf
+ * and hex.
+ * @param buf buffer to receive the binary data, at least hexLen / 2 bytes
+ * @param hex the hex text
+ * @param hexLen the length of the hex text
+ * @return the length of the binary data, or -1 if hexLen is odd or the
+ *    text contains a character that is not a hex digit.
+ */
+extern int32_t Thingstream_Hex_decode(uint8_t *buf, const char *hex, uint16_t hexLen);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_HEX_CODEC_H */
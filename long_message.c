@@ -1,5 +1,5 @@
 /*
- * Copyright 2021-2024 Thingstream AG
+ * Copyright 2021-2026 Thingstream AG
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -38,11 +38,13 @@
 static uint8_t modemBuf[MODEM_BUFFER_LEN];
 /* ------------------------------------------------------ */
 
+#if !defined(LONG_MESSAGE_STREAM)
 /* ------ Setup buffer for protocol transport  ---------- */
 /* Must be large enough to hold the entire message to be
  * published plus an overhead for the protocol header.
  */
 static uint8_t protocolBuf[MODEM_BUFFER_LEN*2];
+#endif /* !LONG_MESSAGE_STREAM */
 
 /* ------------- Setup buffer for uart data  ------------ */
 /* Some targets need a buffer to store data read from the
@@ -61,8 +63,81 @@ static uint8_t protocolBuf[MODEM_BUFFER_LEN*2];
 static ThingstreamTransport *modem_transport;
 
 
+/* Define MODEM_MTU_PROBE_TOPIC as a predefined topic id that nothing
+ * subscribes to, to find the datagram size for the operator on the
+ * first boot and fragment long messages at that size on later boots.
+ * This needs non-volatile storage, see platform_storage.h.
+ */
+#if defined(MODEM_MTU_PROBE_TOPIC)
+/* The largest probe that the modem buffer can send as one datagram,
+ * allowing for base64 and the MQTT-SN header.
+ */
+#define MTU_PROBE_PAYLOAD \
+    ((MODEM_BUFFER_LEN - MODEM__RESERVED_BUFFER) * 3 / 4 - 9)
+#endif /* MODEM_MTU_PROBE_TOPIC */
+
+#if defined(LONG_MESSAGE_STREAM)
+/* The long message is streamed in chunks that each fit in one
+ * datagram, allowing for base64 and the MQTT-SN header, so
+ * neither the message nor a protocol buffer is needed.
+ */
+#define MESSAGE_LEN (MODEM_BUFFER_LEN*3/2)
+static uint8_t chunkBuf[(MODEM_BUFFER_LEN - MODEM__RESERVED_BUFFER) * 3 / 4 - 9];
+#define PROBE_BUFFER chunkBuf
+
+/**
+ * Supply the next part of the long message: 'a..z' repeated.
+ */
+static int32_t readMessage(void* cookie, uint8_t* buf, uint16_t len)
+{
+    uint32_t* pOffset = (uint32_t*)cookie;
+    uint16_t i;
+    for (i = 0; i < len; ++i)
+    {
+        buf[i] = 'a' + (*pOffset)++ % 26;
+    }
+    return len;
+}
+
+/* Whether the stream being received matches the message so far */
+static bool messageValid;
+
+/**
+ * Check each part of a long message streamed back to the device on
+ * the self topic as it arrives, so it is never held whole either.
+ */
+static void checkMessage(void* cookie, uint8_t flags, uint32_t offset,
+                         uint32_t total, const uint8_t* data, uint16_t len)
+{
+    bool* pValid = (bool*)cookie;
+    uint16_t i;
+    UNUSED(total);
+    if (flags & CLIENT_STREAM_FIRST)
+    {
+        *pValid = true;
+    }
+    for (i = 0; i < len; ++i)
+    {
+        if (data[i] != 'a' + (offset + i) % 26)
+        {
+            *pValid = false;
+        }
+    }
+    if (flags & CLIENT_STREAM_ABORT)
+    {
+        Thingstream_Util_printf("Stream abandoned at %d\n", (int)offset);
+    }
+    else if (flags & CLIENT_STREAM_LAST)
+    {
+        Thingstream_Util_printf("Stream of %d bytes received, %s\n",
+                                (int)(offset + len), *pValid ? "valid" : "INVALID");
+    }
+}
+#else
 /* Create a buffer to store the long message to publish */
 static uint8_t message[MODEM_BUFFER_LEN*3/2];
+#define PROBE_BUFFER message
+#endif /* LONG_MESSAGE_STREAM */
 
 /**
  * Create the Thingstream Client stack and publish a message
@@ -72,6 +147,10 @@ static uint8_t message[MODEM_BUFFER_LEN*3/2];
  * maximum transmission unit (MTU) and so a buffer must be
  * provided to Thingstream_createProtocolTransport() to allow
  * the message to be fragmented by the SDK for transmission.
+ *
+ * If LONG_MESSAGE_STREAM is defined the message is instead
+ * published with Thingstream_ClientStream_publish(), so only
+ * one datagram's worth of it is held at a time.
  */
 ThingstreamClientResult run_example(ThingstreamTransport *transport,
                         ThingstreamModemUdpInit *modem_init,
@@ -105,13 +184,27 @@ ThingstreamClientResult run_example(ThingstreamTransport *transport,
      */
     modem_transport = transport;
 
-    /* Base 64 encoding is optional when using UDP. */
+#if defined(MODEM_MTU_PROBE_TOPIC)
+    /* Fragment long messages at the datagram size that was found
+     * to be delivered for this operator, if it is known.
+     */
+    uint16_t mss = Thingstream_ModemMtu_apply(modem_transport);
+#endif /* MODEM_MTU_PROBE_TOPIC */
+
+    /* Base 64 encoding is bypassed at init when the modem uses UDP. */
     transport = Thingstream_createBase64CodecTransport(transport);
     CHECK("base64", transport != NULL);
+#if defined(MODEM_MTU_PROBE_TOPIC)
+    ThingstreamTransport* base64_transport = transport;
+#endif /* MODEM_MTU_PROBE_TOPIC */
 
+#if defined(LONG_MESSAGE_STREAM)
+    transport = Thingstream_createProtocolTransport(transport, NULL, 0);
+#else
     transport = Thingstream_createProtocolTransport(transport,
                                                     protocolBuf,
                                                     sizeof(protocolBuf));
+#endif /* LONG_MESSAGE_STREAM */
     CHECK("thingstream", transport != NULL);
 
 #if (defined(DEBUG_LOG_CLIENT) && (DEBUG_LOG_CLIENT > 0))
@@ -130,6 +223,38 @@ ThingstreamClientResult run_example(ThingstreamTransport *transport,
 
     /* ----------- Stack created ---------------------------- */
 
+#if defined(MODEM_MTU_PROBE_TOPIC)
+    if (mss == 0)
+    {
+        /* Find the datagram size for this operator, it is used
+         * from the next boot. The probe publishes need a connection.
+         */
+        result = Thingstream_Client_connect(client, true, 60, NULL);
+        CHECK_CLIENT_SUCCESS("connect", result, shutdown);
+
+        mss = Thingstream_ModemMtu_probe(client,
+                (ThingstreamTopic)MAKE_PREDEFINED_TOPIC(MODEM_MTU_PROBE_TOPIC),
+                !Thingstream_Base64Codec_isBypassed(base64_transport),
+                PROBE_BUFFER, MTU_PROBE_PAYLOAD);
+        Thingstream_Util_printf("Datagram size found %d\n", (int)mss);
+
+        result = Thingstream_Client_disconnect(client, 0);
+        CHECK_CLIENT_SUCCESS("disconnect", result, shutdown);
+    }
+#endif /* MODEM_MTU_PROBE_TOPIC */
+
+#if defined(LONG_MESSAGE_STREAM)
+    /* Stream the message on the predefined topic using QoS -1,
+     * one chunk per publish, generating it as it is sent.
+     */
+    uint32_t offset = 0;
+    Thingstream_ClientStream_setReceiver(Thingstream_PredefinedSelfTopic,
+                                         checkMessage, &messageValid);
+    result = Thingstream_ClientStream_publish(client, Thingstream_PredefinedSelfTopic,
+                                    ThingstreamQOSM1, readMessage, &offset,
+                                    MESSAGE_LEN, chunkBuf, sizeof(chunkBuf));
+    CHECK_CLIENT_SUCCESS("publish stream", result, shutdown);
+#else
     /* Prepare the long message to be published: 'a..z' repeated */
     int i;
     for (i = 0; i < (int)sizeof(message); ++i)
@@ -144,6 +269,7 @@ ThingstreamClientResult run_example(ThingstreamTransport *transport,
                                     ThingstreamQOSM1, false,
                                     message, sizeof(message));
     CHECK_CLIENT_SUCCESS("publish", result, shutdown);
+#endif /* LONG_MESSAGE_STREAM */
 
     ThingstreamClientResult cr;
 shutdown:
@@ -173,5 +299,11 @@ void Thingstream_Application_registerCallback (const char *topicName, Thingstrea
 }
 void Thingstream_Application_subscribeCallback (ThingstreamTopic topic, ThingstreamQualityOfService_t qos, uint8_t *payload, uint16_t payloadlen)
 {
+#if defined(LONG_MESSAGE_STREAM)
+    if (Thingstream_ClientStream_deliver(topic, qos, payload, payloadlen))
+    {
+        return;
+    }
+#endif /* LONG_MESSAGE_STREAM */
     UNUSED(topic); UNUSED(qos); UNUSED(payload); UNUSED(payloadlen);
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright 2021-2024 Thingstream AG
+ * Copyright 2021-2026 Thingstream AG
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -23,6 +23,9 @@
 #include <string.h>
 
 #include "run_example.h"
+#if defined(MODEM_PSM_TAU_SEC)
+#include "platform_delay.h"
+#endif /* MODEM_PSM_TAU_SEC */
 
 
 /* --------- Setup buffer for modem transport ---------- */
@@ -48,6 +51,24 @@ static uint8_t modemBuf[MODEM_BUFFER_LEN];
 #endif
 /* ------------------------------------------------------ */
 
+/* ------------- Optional Power Saving Mode ------------ */
+/* Define MODEM_PSM_TAU_SEC to ask the network for 3GPP Power
+ * Saving Mode, so that an LTE-M or NB-IoT modem can sleep
+ * between publishes without losing its registration.
+ */
+#if defined(MODEM_PSM_TAU_SEC)
+#ifndef MODEM_PSM_ACTIVE_SEC
+#define MODEM_PSM_ACTIVE_SEC 30
+#endif
+/* The time to stay idle after the publish, long enough for the
+ * modem to enter PSM, before waking it to ask for messages again.
+ */
+#ifndef MODEM_PSM_SLEEP_SEC
+#define MODEM_PSM_SLEEP_SEC (MODEM_PSM_ACTIVE_SEC + 30)
+#endif
+#endif /* MODEM_PSM_TAU_SEC */
+/* ------------------------------------------------------ */
+
 /* Saved 'modem transport' setup when Thingstream stack is created.
  * This is required if the application needs to speak directly to
  * the modem using Thingstream_Modem_sendLine().
@@ -74,6 +95,26 @@ void Thingstream_Application_subscribeCallback(ThingstreamTopic topic,
     }
 }
 
+#if defined(MODEM_PSM_TAU_SEC)
+/**
+ * Default (dummy) implementation to delay for the given number of milliseconds.
+ * A better implementation would wait for interrupts or put the processor into
+ * a low power sleep mode.
+ *
+ * @param millis the time to delay
+ */
+__attribute__((weak))
+void Platform_delayMillis(uint32_t millis)
+{
+    uint32_t now = Thingstream_Platform_getTimeMillis();
+    uint32_t when = now + millis;
+    while ((int32_t)(when - now) > 0)
+    {
+        now = Thingstream_Platform_getTimeMillis();
+    }
+}
+#endif /* MODEM_PSM_TAU_SEC */
+
 /**
  * Create the Thingstream Client stack, publish at QoS -1,
  * retrieve any messages using 'ping'; re-establishing the
@@ -122,7 +163,7 @@ ThingstreamClientResult run_example(ThingstreamTransport *transport,
      */
     modem_transport = transport;
 
-    /* Base 64 encoding is optional when using UDP. */
+    /* Base 64 encoding is bypassed at init when the modem uses UDP. */
     transport = Thingstream_createBase64CodecTransport(transport);
     CHECK("base64", transport != NULL);
 
@@ -143,6 +184,16 @@ ThingstreamClientResult run_example(ThingstreamTransport *transport,
     result = Thingstream_Client_init(client);
     CHECK_CLIENT_SUCCESS("client init", result, destroy);
 
+#if defined(MODEM_PSM_TAU_SEC)
+    /* The network may grant different timers, they are reported
+     * through Thingstream_Application_modemCallback() below.
+     */
+    result = Thingstream_ModemPsm_request(modem_transport,
+                                          MODEM_PSM_TAU_SEC,
+                                          MODEM_PSM_ACTIVE_SEC, 5000);
+    Thingstream_Util_printf("PSM request returned %d\n", (int)result);
+#endif /* MODEM_PSM_TAU_SEC */
+
     /* ----------- Stack created ---------------------------- */
 
     /* Publish data then retrieve any messages waiting on the
@@ -217,6 +268,32 @@ ThingstreamClientResult run_example(ThingstreamTransport *transport,
         }
     }
 
+#if defined(MODEM_PSM_TAU_SEC)
+    /* Stay idle until the modem has entered PSM, as an application
+     * would between publishes, without running the client, which would
+     * talk to the modem. A modem that needs a pin to wake it (e.g.
+     * PWR_ON on SARA-R4 or PSM_EINT on BG95) must be woken by the
+     * platform here.
+     */
+    Thingstream_Util_printf("Idle while the modem sleeps...\n");
+    Platform_delayMillis(MODEM_PSM_SLEEP_SEC * 1000);
+
+    /* On wake bring the modem back without initialising it again,
+     * which would lose the benefit of PSM. Only if it has lost its
+     * registration is the stack initialised again.
+     */
+    ThingstreamTransportResult tRes;
+    tRes = Thingstream_ModemPsm_resume(modem_transport, 30000);
+    Thingstream_Util_printf("PSM resume returned %d\n", (int)tRes);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        result = Thingstream_Client_init(client);
+        CHECK_CLIENT_SUCCESS("client re-init", result, shutdown);
+    }
+    result = Thingstream_Client_ping(client);
+    CHECK_CLIENT_SUCCESS("ping after wake", result, shutdown);
+#endif /* MODEM_PSM_TAU_SEC */
+
     ThingstreamClientResult cr;
 shutdown:
     cr = Thingstream_Client_shutdown(client);
@@ -240,7 +317,11 @@ error:
  */
 void Thingstream_Application_modemCallback (const char *response, uint16_t len)
 {
+#if defined(MODEM_PSM_TAU_SEC)
+    Thingstream_ModemPsm_processLine(response, len);
+#else
     UNUSED(response); UNUSED(len);
+#endif /* MODEM_PSM_TAU_SEC */
 }
 void Thingstream_Application_registerCallback (const char *topicName, ThingstreamTopic topic)
 {
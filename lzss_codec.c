@@ -0,0 +1,191 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief LZSS compression of small payloads
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "lzss_codec.h"
+
+/** The number of bits in the hash of 3 bytes */
+#define HASH_BITS   8
+
+/** The entry in the hash table for no earlier position */
+#define NO_POS      0xFFFF
+
+/** The latest position of each hash of 3 bytes */
+static uint16_t head[1 << HASH_BITS];
+
+/**
+ * Hash the 3 bytes at the given position.
+ */
+static uint8_t hash3(const uint8_t* p)
+{
+    uint32_t v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    return (uint8_t)((v * 2654435761u) >> (32 - HASH_BITS));
+}
+
+int32_t Thingstream_Lzss_encode(uint8_t* out, uint16_t outLen, const uint8_t* data, uint16_t len, uint8_t windowBits)
+{
+    uint32_t window;
+    uint16_t lengthBits;
+    uint16_t maxMatch;
+    uint16_t pos = 0;
+    uint16_t o = 0;
+    uint16_t flagPos = 0;
+    uint8_t bit = 8;
+
+    if ((windowBits < LZSS_MIN_WINDOW_BITS) || (windowBits > LZSS_MAX_WINDOW_BITS))
+    {
+        return -1;
+    }
+    window = 1u << windowBits;
+    lengthBits = (uint16_t)(16 - windowBits);
+    maxMatch = (uint16_t)(LZSS_MIN_MATCH + (1u << lengthBits) - 1);
+    memset(head, 0xFF, sizeof(head));
+
+    while (pos < len)
+    {
+        uint16_t matchLen = 0;
+        uint16_t dist = 0;
+
+        if (bit == 8)
+        {
+            if (o >= outLen)
+            {
+                return -1;
+            }
+            flagPos = o++;
+            out[flagPos] = 0;
+            bit = 0;
+        }
+
+        if (len - pos >= LZSS_MIN_MATCH)
+        {
+            uint8_t h = hash3(&data[pos]);
+            uint16_t cand = head[h];
+            head[h] = pos;
+            if ((cand != NO_POS) && ((uint32_t)(pos - cand) <= window))
+            {
+                uint16_t limit = (uint16_t)(len - pos);
+                uint16_t n = 0;
+                if (limit > maxMatch)
+                {
+                    limit = maxMatch;
+                }
+                while ((n < limit) && (data[cand + n] == data[pos + n]))
+                {
+                    ++n;
+                }
+                if (n >= LZSS_MIN_MATCH)
+                {
+                    matchLen = n;
+                    dist = (uint16_t)(pos - cand);
+                }
+            }
+        }
+
+        if (matchLen > 0)
+        {
+            uint16_t code = (uint16_t)(((dist - 1u) << lengthBits)
+                                       | (matchLen - LZSS_MIN_MATCH));
+            uint16_t i;
+            if (o + 2 > outLen)
+            {
+                return -1;
+            }
+            out[o++] = (uint8_t)(code >> 8);
+            out[o++] = (uint8_t)code;
+            out[flagPos] |= (uint8_t)(1u << bit);
+
+            /* Remember the positions inside the match too */
+            for (i = 1; (i < matchLen) && (len - (pos + i) >= LZSS_MIN_MATCH); ++i)
+            {
+                head[hash3(&data[pos + i])] = (uint16_t)(pos + i);
+            }
+            pos = (uint16_t)(pos + matchLen);
+        }
+        else
+        {
+            if (o >= outLen)
+            {
+                return -1;
+            }
+            out[o++] = data[pos++];
+        }
+        ++bit;
+    }
+    return o;
+}
+
+int32_t Thingstream_Lzss_decode(uint8_t* out, uint16_t outLen, const uint8_t* data, uint16_t len, uint8_t windowBits)
+{
+    uint16_t lengthBits = (uint16_t)(16 - windowBits);
+    uint16_t i = 0;
+    uint16_t o = 0;
+
+    if ((windowBits < LZSS_MIN_WINDOW_BITS) || (windowBits > LZSS_MAX_WINDOW_BITS))
+    {
+        return -1;
+    }
+
+    while (i < len)
+    {
+        uint8_t flags = data[i++];
+        uint8_t bit;
+
+        for (bit = 0; (bit < 8) && (i < len); ++bit)
+        {
+            if (flags & (1u << bit))
+            {
+                uint16_t code;
+                uint16_t dist;
+                uint16_t n;
+                if (len - i < 2)
+                {
+                    return -1;
+                }
+                code = (uint16_t)((data[i] << 8) | data[i + 1]);
+                i += 2;
+                dist = (uint16_t)((code >> lengthBits) + 1);
+                n = (uint16_t)((code & ((1u << lengthBits) - 1)) + LZSS_MIN_MATCH);
+                if ((dist > o) || (n > outLen - o))
+                {
+                    return -1;
+                }
+                /* The copy may overlap itself, e.g. a run of one byte */
+                while (n-- > 0)
+                {
+                    out[o] = out[o - dist];
+                    ++o;
+                }
+            }
+            else
+            {
+                if (o >= outLen)
+                {
+                    return -1;
+                }
+                out[o++] = data[i++];
+            }
+        }
+    }
+    return o;
+}
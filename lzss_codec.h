@@ -0,0 +1,98 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief LZSS compression of small payloads
+ *
+ * The compressed data is a sequence of groups, each a flag byte followed
+ * by eight items (fewer in the last group). Bit i of the flag byte, from
+ * the least significant, is 0 if item i is a literal byte and 1 if it is a
+ * 2-byte big-endian match: the top windowBits bits hold the distance back
+ * less 1, and the rest hold the length less #LZSS_MIN_MATCH.
+ *
+ * The encoder keeps one earlier position for each hash of 3 bytes, so it
+ * needs 512 bytes of static memory and no more than a few comparisons per
+ * byte. Each payload is compressed on its own, so a lost datagram does not
+ * affect the next.
+ */
+
+#ifndef INC_LZSS_CODEC_H
+#define INC_LZSS_CODEC_H
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * The smallest window, 256 bytes, as a number of bits.
+ * @hideinitializer
+ */
+#define LZSS_MIN_WINDOW_BITS 8
+
+/**
+ * The largest window, 2K bytes, as a number of bits.
+ * @hideinitializer
+ */
+#define LZSS_MAX_WINDOW_BITS 11
+
+/**
+ * The shortest match.
+ * @hideinitializer
+ */
+#define LZSS_MIN_MATCH 3
+
+/**
+ * The longest compressed data for data of the given length, i.e. when
+ * nothing matches.
+ * @hideinitializer
+ */
+#define LZSS_MAX_ENCODED_LEN(len) ((len) + ((len) + 7) / 8)
+
+/**
+ * Compress data.
+ * @param out buffer to receive the compressed data
+ * @param outLen the length of the buffer
+ * @param data the data, which must not overlap the buffer
+ * @param len the length of the data
+ * @param windowBits the size of the window as a number of bits, from
+ *    #LZSS_MIN_WINDOW_BITS to #LZSS_MAX_WINDOW_BITS
+ * @return the length of the compressed data, or -1 if it does not fit in
+ *    the buffer
+ */
+extern int32_t Thingstream_Lzss_encode(uint8_t* out, uint16_t outLen, const uint8_t* data, uint16_t len, uint8_t windowBits);
+
+/**
+ * Decompress data.
+ * @param out buffer to receive the data
+ * @param outLen the length of the buffer
+ * @param data the compressed data, which must not overlap the buffer
+ * @param len the length of the compressed data
+ * @param windowBits the size of the window used to compress the data
+ * @return the length of the data, or -1 if the compressed data is not
+ *    valid or the data does not fit in the buffer
+ */
+extern int32_t Thingstream_Lzss_decode(uint8_t* out, uint16_t outLen, const uint8_t* data, uint16_t len, uint8_t windowBits);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_LZSS_CODEC_H */
@@ -0,0 +1,373 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Self test of the adaptive delay transport against a scripted modem
+ *
+ * This example does not use the modem. It sends commands through an
+ * adaptive delay transport whose inner transport is a scripted modem that
+ * echoes each command at once and may give its final result much later. It
+ * checks that the modem is not let sleep while a slow command (AT+COPS=?)
+ * is outstanding, nor while the reply to a socket write is awaited, and
+ * that it is let sleep once the traffic has ended. It then checks that a
+ * late answer to a wake probe does not reach the modem transport as the
+ * result of its next command. It takes several seconds.
+ */
+
+#include <string.h>
+
+#include "run_example.h"
+#include "modem_adaptive_delay_transport.h"
+
+/** The time after which the modem is put to sleep in any case */
+#define TEST_SLEEP_MS       2000
+
+/** The longest time the scripted modem takes to wake */
+#define TEST_MAX_WAKE_MS    100
+
+/** The time the scripted modem takes to give the result of a slow command */
+#define SLOW_COMMAND_MS     1000
+
+/** A command that the modem takes a long time to answer */
+#define SLOW_COMMAND        "AT+COPS=?\r"
+
+/** A socket write, answered at once */
+#define SOCKET_WRITE        "AT+USOST=0,\"10.20.30.40\",1883,2\r"
+
+/** The longest time the scripted modem takes to wake, for the late probe */
+#define LATE_MAX_WAKE_MS    1000
+
+/** The time after which the modem is put to sleep, for the late probe */
+#define LATE_SLEEP_MS       500
+
+/** The time the scripted modem takes to answer the late probe */
+#define LATE_PROBE_MS       200
+
+/** A command answered at once with an information line */
+#define QUICK_COMMAND       "AT+CSQ\r"
+
+/** The number of replies the scripted modem can queue */
+#define MODEM_REPLIES       4
+
+/** The state of the scripted modem */
+static struct
+{
+    ThingstreamTransportCallback_t callback;
+    void* cookie;
+    /** The command line being sent */
+    char line[64];
+    uint16_t lineLen;
+    /** The echo of the last command, delivered at once */
+    uint8_t echo[64];
+    uint16_t echoLen;
+    /** The output the modem has yet to deliver, in order */
+    const char* reply[MODEM_REPLIES];
+    /** The time at which each reply is delivered */
+    uint32_t replyAt[MODEM_REPLIES];
+    uint16_t replies;
+    /** The time the next "AT" probe takes to be answered */
+    uint32_t probeDelay;
+} modem;
+
+/** The output of the adaptive delay transport */
+static uint8_t received[256];
+static uint16_t receivedLen;
+
+/**
+ * Queue a reply from the scripted modem, to be delivered after the delay
+ * and after the replies already queued.
+ */
+static void modemReply(const char* reply, uint32_t delay)
+{
+    uint32_t at = Thingstream_Platform_getTimeMillis() + delay;
+    if (modem.replies == MODEM_REPLIES)
+    {
+        return;
+    }
+    if ((modem.replies > 0) && TIME_COMPARE(at, <, modem.replyAt[modem.replies - 1]))
+    {
+        at = modem.replyAt[modem.replies - 1];
+    }
+    modem.reply[modem.replies] = reply;
+    modem.replyAt[modem.replies] = at;
+    modem.replies++;
+}
+
+/**
+ * Answer a complete command line sent to the scripted modem.
+ */
+static void modemCommand(const char* line, uint16_t len)
+{
+    memcpy(modem.echo, line, len);
+    modem.echoLen = len;
+    if ((len > 8) && (memcmp(line, "AT+COPS=", 8) == 0))
+    {
+        modemReply("\r\n+COPS: (2,\"Test\",\"Test\",\"26201\",7),,(0-4),(0-2)\r\n"
+                   "\r\nOK\r\n", SLOW_COMMAND_MS);
+    }
+    else if ((len > 9) && (memcmp(line, "AT+USOST=", 9) == 0))
+    {
+        modemReply("\r\n+USOST: 0,2\r\n\r\nOK\r\n", 0);
+    }
+    else if ((len == 7) && (memcmp(line, QUICK_COMMAND, 7) == 0))
+    {
+        modemReply("\r\n+CSQ: 20,99\r\n\r\nOK\r\n", 0);
+    }
+    else
+    {
+        /* Only the first probe of a wake is slow */
+        modemReply("\r\nOK\r\n", modem.probeDelay);
+        modem.probeDelay = 0;
+    }
+}
+
+static ThingstreamTransportResult modem_init(ThingstreamTransport* self, uint16_t version)
+{
+    UNUSED(self);
+    UNUSED(version);
+    return TRANSPORT_SUCCESS;
+}
+
+static ThingstreamTransportResult modem_shutdown(ThingstreamTransport* self)
+{
+    UNUSED(self);
+    return TRANSPORT_SUCCESS;
+}
+
+static ThingstreamTransportResult modem_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis)
+{
+    uint16_t i;
+    UNUSED(self);
+    UNUSED(flags);
+    UNUSED(millis);
+
+    for (i = 0; i < len; ++i)
+    {
+        if (modem.lineLen == sizeof(modem.line))
+        {
+            return TRANSPORT_ERROR;
+        }
+        modem.line[modem.lineLen++] = (char)data[i];
+        if (data[i] == '\r')
+        {
+            modemCommand(modem.line, modem.lineLen);
+            modem.lineLen = 0;
+        }
+    }
+    return TRANSPORT_SUCCESS;
+}
+
+static ThingstreamTransportResult modem_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie)
+{
+    UNUSED(self);
+    modem.callback = callback;
+    modem.cookie = cookie;
+    return TRANSPORT_SUCCESS;
+}
+
+static ThingstreamTransportResult modem_run(ThingstreamTransport* self, uint32_t millis)
+{
+    UNUSED(self);
+    UNUSED(millis);
+    if (modem.callback == NULL)
+    {
+        return TRANSPORT_SUCCESS;
+    }
+    if (modem.echoLen > 0)
+    {
+        uint16_t len = modem.echoLen;
+        modem.echoLen = 0;
+        modem.callback(modem.cookie, modem.echo, len);
+    }
+    /* One reply per run, so each is seen on its own */
+    if ((modem.replies > 0)
+        && TIME_COMPARE(Thingstream_Platform_getTimeMillis(), >=, modem.replyAt[0]))
+    {
+        const char* reply = modem.reply[0];
+        uint16_t i;
+        modem.replies--;
+        for (i = 0; i < modem.replies; ++i)
+        {
+            modem.reply[i] = modem.reply[i + 1];
+            modem.replyAt[i] = modem.replyAt[i + 1];
+        }
+        modem.callback(modem.cookie, (uint8_t*)reply, (uint16_t)strlen(reply));
+    }
+    return TRANSPORT_SUCCESS;
+}
+
+static ThingstreamTransport scriptedModem = {
+    NULL,
+    modem_init,
+    modem_shutdown,
+    NULL,
+    NULL,
+    modem_send,
+    modem_register_callback,
+    NULL,
+    modem_run
+};
+
+/**
+ * Collect the output of the adaptive delay transport.
+ */
+static void collect(void* cookie, uint8_t* data, uint16_t len)
+{
+    UNUSED(cookie);
+    if (len > sizeof(received) - receivedLen)
+    {
+        len = sizeof(received) - receivedLen;
+    }
+    memcpy(received + receivedLen, data, len);
+    receivedLen += len;
+}
+
+/**
+ * Return true if the data contains the given string.
+ */
+static bool contains(const uint8_t* data, uint16_t len, const char* str)
+{
+    uint16_t count = (uint16_t)strlen(str);
+    uint16_t i;
+    for (i = 0; i + count <= len; ++i)
+    {
+        if (memcmp(data + i, str, count) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Return the number of times the data contains the given string.
+ */
+static uint16_t count(const uint8_t* data, uint16_t len, const char* str)
+{
+    uint16_t n = 0;
+    uint16_t i;
+    for (i = 0; i + strlen(str) <= len; ++i)
+    {
+        if (memcmp(data + i, str, strlen(str)) == 0)
+        {
+            ++n;
+        }
+    }
+    return n;
+}
+
+/**
+ * Run the transport for the given number of milliseconds.
+ */
+static void runFor(ThingstreamTransport* transport, uint32_t millis)
+{
+    uint32_t limit = Thingstream_Platform_getTimeMillis() + millis;
+    while (TIME_COMPARE(Thingstream_Platform_getTimeMillis(), <, limit))
+    {
+        (void)transport->run(transport, 10);
+    }
+}
+
+/**
+ * Send a command as the modem transport would.
+ */
+static ThingstreamTransportResult command(ThingstreamTransport* transport, const char* line)
+{
+    receivedLen = 0;
+    return transport->send(transport, 0, (uint8_t*)line, (uint16_t)strlen(line), LATE_MAX_WAKE_MS * 2);
+}
+
+/**
+ * Run the adaptive delay transport self test. The transport is not used.
+ */
+ThingstreamClientResult run_example(ThingstreamTransport *transport,
+                        ThingstreamModemUdpInit *modem_init,
+                        uint16_t modem_flags)
+{
+    ThingstreamClientResult result = CLIENT_ILLEGAL_ARGUMENT;
+    ThingstreamTransport* delay;
+    const ThingstreamModemAdaptiveDelayStats* stats;
+
+    UNUSED(transport);
+    UNUSED(modem_init);
+    UNUSED(modem_flags);
+
+    delay = Thingstream_createModemAdaptiveDelayTransport(&scriptedModem,
+                MODEM_SLEEP_DTR, TEST_SLEEP_MS, NULL, TEST_MAX_WAKE_MS);
+    CHECK("create", delay != NULL);
+    (void)delay->register_callback(delay, collect, NULL);
+    CHECK("init", delay->init(delay, TRANSPORT_VERSION_1) == TRANSPORT_SUCCESS);
+    stats = Thingstream_ModemAdaptiveDelay_getStats(delay);
+
+    /* The echo arrives at once, the result much later */
+    CHECK("slow command", command(delay, SLOW_COMMAND) == TRANSPORT_SUCCESS);
+    runFor(delay, SLOW_COMMAND_MS * 3 / 4);
+    CHECK("slow command echo", contains(received, receivedLen, SLOW_COMMAND));
+    CHECK("slow command pending", !contains(received, receivedLen, "OK"));
+    CHECK("awake during slow command", stats->sleeps == 0);
+
+    /* Once the result is in and the traffic has stopped, sleep */
+    runFor(delay, SLOW_COMMAND_MS);
+    CHECK("slow command result", contains(received, receivedLen, "\r\nOK\r\n"));
+    CHECK("slow command response time", stats->responseMs >= SLOW_COMMAND_MS / 8);
+    runFor(delay, SLOW_COMMAND_MS / 2);
+    CHECK("asleep after slow command", stats->sleeps == 1);
+
+    /* The socket write wakes the modem, the probe answer is consumed */
+    CHECK("socket write", command(delay, SOCKET_WRITE) == TRANSPORT_SUCCESS);
+    CHECK("woken", stats->wakes == 1);
+    CHECK("probe consumed", !contains(received, receivedLen, "OK"));
+    runFor(delay, SLOW_COMMAND_MS);
+    CHECK("socket write result", contains(received, receivedLen, "+USOST: 0,2"));
+    CHECK("awake for server reply", stats->sleeps == 1);
+
+    /* The server's reply ends the wait */
+    modemReply("\r\n+UUSORF: 0,2\r\n", 0);
+    runFor(delay, SLOW_COMMAND_MS);
+    CHECK("server reply", contains(received, receivedLen, "+UUSORF: 0,2"));
+    CHECK("asleep after server reply", stats->sleeps == 2);
+
+    /* A new instance whose wakes leave time for a second probe */
+    delay = Thingstream_createModemAdaptiveDelayTransport(&scriptedModem,
+                MODEM_SLEEP_DTR, LATE_SLEEP_MS, NULL, LATE_MAX_WAKE_MS);
+    CHECK("late create", delay != NULL);
+    (void)delay->register_callback(delay, collect, NULL);
+    CHECK("late init", delay->init(delay, TRANSPORT_VERSION_1) == TRANSPORT_SUCCESS);
+    stats = Thingstream_ModemAdaptiveDelay_getStats(delay);
+
+    /* The first wake waits the whole wake time, then probes once */
+    runFor(delay, LATE_SLEEP_MS * 2);
+    CHECK("late asleep", stats->sleeps == 1);
+    CHECK("late first wake", command(delay, QUICK_COMMAND) == TRANSPORT_SUCCESS);
+    CHECK("late first wake probes", stats->wakeRetries == 0);
+    runFor(delay, LATE_SLEEP_MS * 2);
+    CHECK("late asleep again", stats->sleeps == 2);
+
+    /* The first probe is answered after the second has been sent */
+    modem.probeDelay = LATE_PROBE_MS;
+    CHECK("late probe", command(delay, QUICK_COMMAND) == TRANSPORT_SUCCESS);
+    CHECK("late probe retried", stats->wakeRetries == 1);
+    runFor(delay, LATE_PROBE_MS);
+    CHECK("late probe result", contains(received, receivedLen, "+CSQ: 20,99"));
+    CHECK("late probe answers consumed", count(received, receivedLen, "OK") == 1);
+
+    Thingstream_Util_printf("adaptive delay self test passed\n");
+    result = CLIENT_SUCCESS;
+
+error:
+    return result;
+}
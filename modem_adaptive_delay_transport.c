@@ -0,0 +1,731 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief ThingstreamTransport implementation that lets a modem sleep
+ * between bursts of traffic and wakes it before sending.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "modem_adaptive_delay_transport.h"
+#include "client_platform.h"
+
+/** The shortest quiet time that ends a burst of traffic */
+#define MIN_QUIET_MS        50
+
+/** Sleeping pays off if idle periods are this many times the wake latency */
+#define BREAK_EVEN_FACTOR   4
+
+/** The time to wait for the answer to each wake probe, beyond responseMs */
+#define PROBE_REPLY_MS      100
+
+/** The command sent to check that the modem is awake */
+#define WAKE_PROBE          "AT\r"
+
+/** The space for a line of modem output while waking */
+#define WAKE_LINE_LEN       16
+
+/** The space for the start of a line of modem output, enough to hold any
+ * of the finalResults */
+#define RESULT_LINE_LEN     12
+
+/**
+ * The lines that end the modem's response to a command. Those that are
+ * followed by a code are matched as prefixes.
+ */
+static const char* const finalResults[] = {
+    "OK",
+    "ERROR",
+    "+CME ERROR:",
+    "+CMS ERROR:",
+    "SEND OK",
+    "SEND FAIL",
+    "CONNECT",
+    "NO CARRIER",
+};
+
+#define FINAL_RESULTS (sizeof(finalResults) / sizeof(finalResults[0]))
+
+/**
+ * The commands that send a datagram to the server, after which a reply
+ * from the server is expected.
+ */
+static const char* const socketWriteCommands[] = {
+    "AT+USOST=",
+    "AT+USOWR=",
+    "AT+QISEND=",
+    "AT+CASEND=",
+    "AT+CIPSEND=",
+    "AT^SISW=",
+};
+
+#define SOCKET_WRITE_COMMANDS (sizeof(socketWriteCommands) / sizeof(socketWriteCommands[0]))
+
+/**
+ * Update an estimate with a new sample, moving a quarter of the way.
+ */
+#define EWMA(estimate, sample) \
+    ((estimate) = (estimate) - ((estimate) >> 2) + ((sample) >> 2))
+
+/**
+ * The ModemAdaptiveDelayState structure is used to store state for the
+ * adaptive delay transport.
+ */
+typedef struct ModemAdaptiveDelayState_s
+{
+    /** The inner transport */
+    ThingstreamTransport* inner;
+    /** The callback registered by the outer transport */
+    ThingstreamTransportCallback_t callback;
+    /** Cookie associated with the registered callback */
+    void* cookie;
+    /** How the modem is put to sleep */
+    ThingstreamModemSleepControl control;
+    /** The idle time after which the modem is asleep in any case */
+    uint16_t sleepMs;
+    /** The string sent to wake the modem, or NULL */
+    const char* wakeupString;
+    /** The longest time the modem may take to wake */
+    uint16_t maxWakeMs;
+    /** The time of the last traffic in either direction */
+    volatile uint32_t lastActivity;
+    /** The time of the last send */
+    uint32_t lastSend;
+    /** The final result of the last command is awaited */
+    volatile bool awaitingResponse;
+    /** A socket write has completed and the server has not replied yet */
+    volatile bool awaitingServer;
+    /** The number of bytes of the current output line seen */
+    uint8_t resultLineLen;
+    /** The start of the current line of modem output */
+    uint8_t resultLine[RESULT_LINE_LEN];
+    /** The time the modem was put to sleep (or assumed to sleep) */
+    uint32_t sleepStart;
+    /** The modem is asleep */
+    bool asleep;
+    /** Sleep was declined in the current idle period */
+    bool declined;
+    /** A wake is in progress, modem output is checked for the probe answer */
+    volatile bool waking;
+    /** The modem has answered the wake probe */
+    volatile bool wakeAnswered;
+    /** The number of wake probes sent and not answered yet */
+    uint8_t probesUnanswered;
+    /** Every wake probe sent has been answered */
+    volatile bool probesSettled;
+    /** The number of bytes in wakeLine */
+    uint8_t wakeLineLen;
+    /** The current line of modem output while waking */
+    uint8_t wakeLine[WAKE_LINE_LEN];
+    /** The counters */
+    ThingstreamModemAdaptiveDelayStats stats;
+} ModemAdaptiveDelayState;
+
+/** Instance of ModemAdaptiveDelayState */
+static ModemAdaptiveDelayState _modem_adaptive_delay_transport_state;
+
+static ThingstreamTransportResult modem_adaptive_delay_init(ThingstreamTransport* self, uint16_t version);
+static ThingstreamTransportResult modem_adaptive_delay_shutdown(ThingstreamTransport* self);
+static ThingstreamTransportResult modem_adaptive_delay_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len);
+static ThingstreamTransportResult modem_adaptive_delay_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis);
+static ThingstreamTransportResult modem_adaptive_delay_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie);
+static ThingstreamTransportResult modem_adaptive_delay_run(ThingstreamTransport* self, uint32_t millis);
+
+/** Instance of ThingstreamTransport for the adaptive delay transport */
+static const ThingstreamTransport _modem_adaptive_delay_transport_instance = {
+    (ThingstreamTransportState_t*)&_modem_adaptive_delay_transport_state,
+    modem_adaptive_delay_init,
+    modem_adaptive_delay_shutdown,
+    modem_adaptive_delay_get_buffer,
+    NULL, /* This slot no longer used */
+    modem_adaptive_delay_send,
+    modem_adaptive_delay_register_callback,
+    NULL, /* This slot no longer used */
+    modem_adaptive_delay_run
+};
+
+
+ThingstreamTransport* Thingstream_createModemAdaptiveDelayTransport(ThingstreamTransport* inner, ThingstreamModemSleepControl control, uint16_t sleepMs, const char* wakeupString, uint16_t maxWakeMs)
+{
+    ThingstreamTransport* self = (ThingstreamTransport*)&_modem_adaptive_delay_transport_instance;
+    ModemAdaptiveDelayState* state = (ModemAdaptiveDelayState*)self->_state;
+
+    if (inner == NULL)
+    {
+        return NULL;
+    }
+    memset(state, 0, sizeof(*state));
+    state->inner = inner;
+    state->control = control;
+    state->sleepMs = sleepMs;
+    state->wakeupString = wakeupString;
+    state->maxWakeMs = maxWakeMs;
+
+    /* Start from the worst case and learn from there */
+    state->stats.wakeLatencyMs = maxWakeMs;
+    state->stats.responseMs = MIN_QUIET_MS;
+    state->stats.idleGapMs = sleepMs;
+    return self;
+}
+
+
+const ThingstreamModemAdaptiveDelayStats* Thingstream_ModemAdaptiveDelay_getStats(ThingstreamTransport* self)
+{
+    ModemAdaptiveDelayState* state = (ModemAdaptiveDelayState*)self->_state;
+    return &state->stats;
+}
+
+
+/**
+ * Default implementation, the platform does not drive the modem's DTR.
+ *
+ * @param sleep true to let the modem sleep, false to wake it
+ */
+__attribute__((weak))
+void Platform_modemSleep(bool sleep)
+{
+    (void)sleep;
+}
+
+
+/**
+ * Return the time without traffic that ends a burst: long enough for the
+ * next command to follow the last result, and no longer than sleepMs.
+ */
+static uint32_t quietMs(const ModemAdaptiveDelayState* state)
+{
+    uint32_t quiet = 2 * (uint32_t)state->stats.responseMs;
+    if (quiet > state->sleepMs)
+    {
+        quiet = state->sleepMs;
+    }
+    return (quiet > MIN_QUIET_MS) ? quiet : MIN_QUIET_MS;
+}
+
+/**
+ * Decide whether the modem should sleep now, or is asleep already.
+ *
+ * @param state the adaptive delay state
+ * @param now the current time
+ */
+static void considerSleep(ModemAdaptiveDelayState* state, uint32_t now)
+{
+    uint32_t idle = now - state->lastActivity;
+
+    if (state->asleep || state->waking)
+    {
+        return;
+    }
+    if (state->control == MODEM_SLEEP_TIMER)
+    {
+        /* The modem has slept on its own idle timer */
+        if (idle >= state->sleepMs)
+        {
+            state->asleep = true;
+            state->sleepStart = state->lastActivity + state->sleepMs;
+            ++state->stats.sleeps;
+        }
+        return;
+    }
+
+    /* Never sleep in the middle of a command, however slow, and wait up
+     * to sleepMs for the server to reply to a datagram */
+    if ((idle < quietMs(state)) || state->awaitingResponse
+        || (state->awaitingServer && (idle < state->sleepMs)))
+    {
+        return;
+    }
+    uint32_t breakEven = (uint32_t)state->stats.wakeLatencyMs * BREAK_EVEN_FACTOR;
+    if ((state->stats.idleGapMs >= breakEven) || (idle >= state->sleepMs))
+    {
+        Platform_modemSleep(true);
+        state->asleep = true;
+        state->sleepStart = now;
+        ++state->stats.sleeps;
+    }
+    else
+    {
+        state->declined = true;
+    }
+}
+
+/**
+ * Allow the inner transport to run until the flag is set or the limit is
+ * reached.
+ *
+ * @return true if the flag was set
+ */
+static bool runInnerUntil(ModemAdaptiveDelayState* state, volatile bool* flag, uint32_t limit)
+{
+    ThingstreamTransport* inner = state->inner;
+    for (;;)
+    {
+        if ((flag != NULL) && *flag)
+        {
+            return true;
+        }
+        uint32_t now = Thingstream_Platform_getTimeMillis();
+        if (TIME_COMPARE(now, >=, limit))
+        {
+            return false;
+        }
+        (void)inner->run(inner, limit - now);
+    }
+}
+
+/**
+ * Wake the modem: send the wakeup string, wait for the expected wake
+ * latency, then send AT until the modem answers. The wake latency estimate
+ * is lowered by a quarter when the first probe is answered, and raised to
+ * the time measured when it is not. The answer that ends the wait may be a
+ * late answer to an earlier probe, so the answers to the later probes are
+ * waited for (and consumed) before the modem transport sends anything.
+ *
+ * @param state the adaptive delay state
+ * @param flags the flags passed to send()
+ * @param limit the time limit of the send
+ */
+static void wake(ModemAdaptiveDelayState* state, uint16_t flags, uint32_t limit)
+{
+    ThingstreamTransport* inner = state->inner;
+    ThingstreamModemAdaptiveDelayStats* stats = &state->stats;
+    uint32_t start = Thingstream_Platform_getTimeMillis();
+    uint32_t wakeLimit = start + state->maxWakeMs;
+    uint32_t ready;
+    uint32_t probes = 0;
+
+    if (TIME_COMPARE(wakeLimit, >, limit))
+    {
+        wakeLimit = limit;
+    }
+
+    stats->asleepMs += start - state->sleepStart;
+    ++stats->wakes;
+    state->asleep = false;
+    state->waking = true;
+    state->wakeAnswered = false;
+    state->probesUnanswered = 0;
+    state->probesSettled = true;
+    state->wakeLineLen = 0;
+
+    if (state->control == MODEM_SLEEP_DTR)
+    {
+        Platform_modemSleep(false);
+    }
+    if (state->wakeupString != NULL)
+    {
+        (void)inner->send(inner, flags, (uint8_t*)state->wakeupString,
+                          (uint16_t)strlen(state->wakeupString),
+                          wakeLimit - start);
+    }
+
+    ready = start + stats->wakeLatencyMs;
+    (void)runInnerUntil(state, NULL, TIME_COMPARE(ready, <, wakeLimit) ? ready : wakeLimit);
+
+    /* Probe at least once, even if the wake has used all of maxWakeMs */
+    uint32_t now = Thingstream_Platform_getTimeMillis();
+    uint32_t replyLimit;
+    do
+    {
+        ++probes;
+        ++state->probesUnanswered;
+        state->probesSettled = false;
+        (void)inner->send(inner, flags, (uint8_t*)WAKE_PROBE,
+                          (uint16_t)strlen(WAKE_PROBE), limit - now);
+        replyLimit = now + stats->responseMs + PROBE_REPLY_MS;
+        if (TIME_COMPARE(replyLimit, >, limit))
+        {
+            replyLimit = limit;
+        }
+        if (runInnerUntil(state, &state->wakeAnswered, replyLimit))
+        {
+            /* The latency is the time to the probe that was answered */
+            if (probes == 1)
+            {
+                stats->wakeLatencyMs -= (uint16_t)(stats->wakeLatencyMs >> 2);
+            }
+            else
+            {
+                stats->wakeLatencyMs = (uint16_t)(now - start);
+            }
+            break;
+        }
+        now = Thingstream_Platform_getTimeMillis();
+    } while (TIME_COMPARE(now, <, wakeLimit));
+    if (!state->wakeAnswered)
+    {
+        /* Carry on, as the fixed delay transport would */
+        stats->wakeLatencyMs = state->maxWakeMs;
+    }
+    else
+    {
+        /* Give the last probe its full time to be answered, in case an
+         * earlier probe was lost rather than answered late */
+        (void)runInnerUntil(state, &state->probesSettled, replyLimit);
+    }
+    state->probesUnanswered = 0;
+    if (probes > 1)
+    {
+        stats->wakeRetries += probes - 1;
+    }
+
+    uint32_t waited = Thingstream_Platform_getTimeMillis() - start;
+    if (waited < state->maxWakeMs)
+    {
+        stats->savedWaitMs += state->maxWakeMs - waited;
+    }
+    state->waking = false;
+    if ((state->wakeLineLen > 0) && (state->callback != NULL))
+    {
+        state->callback(state->cookie, state->wakeLine, state->wakeLineLen);
+    }
+    state->lastActivity = Thingstream_Platform_getTimeMillis();
+}
+
+/**
+ * Check a line of modem output received while waking.
+ *
+ * @return true if the line is the answer to a wake probe and is consumed
+ */
+static bool wakeLine(ModemAdaptiveDelayState* state)
+{
+    const uint8_t* line = state->wakeLine;
+    uint8_t len = state->wakeLineLen;
+    while ((len > 0) && ((line[len - 1] == '\r') || (line[len - 1] == '\n')))
+    {
+        --len;
+    }
+    while ((len > 0) && ((line[0] == '\r') || (line[0] == '\n')))
+    {
+        ++line;
+        --len;
+    }
+    if ((len == 0) || ((len == 2) && (memcmp(line, "AT", 2) == 0)))
+    {
+        /* blank line or the echo of the probe */
+        return true;
+    }
+    if ((len == 2) && (memcmp(line, "OK", 2) == 0))
+    {
+        state->wakeAnswered = true;
+    }
+    else if ((len != 5) || (memcmp(line, "ERROR", 5) != 0))
+    {
+        /* A probe garbled by the wake is answered with an error */
+        return false;
+    }
+    if ((state->probesUnanswered > 0) && (--state->probesUnanswered == 0))
+    {
+        state->probesSettled = true;
+    }
+    return true;
+}
+
+/**
+ * Check whether a line of modem output is a final result code.
+ *
+ * @param line the start of the line, without line end characters
+ * @param len the length of the line, or RESULT_LINE_LEN if longer
+ * @return true if the line ends the response to a command
+ */
+static bool isFinalResult(const uint8_t* line, uint8_t len)
+{
+    size_t i;
+    for (i = 0; i < FINAL_RESULTS; ++i)
+    {
+        const char* result = finalResults[i];
+        size_t resultLen = strlen(result);
+        bool prefix = (result[resultLen - 1] == ':');
+        if (((len == resultLen) || (prefix && (len > resultLen)))
+            && (memcmp(line, result, resultLen) == 0))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Follow the modem output for the final result of the command that was
+ * sent, measuring the modem's response time when it arrives. The echo of
+ * the command and any intermediate lines leave the command outstanding,
+ * and a line received when no command is outstanding ends the wait for
+ * the server's reply.
+ *
+ * @param state the adaptive delay state
+ * @param data the modem output
+ * @param len the length of the modem output
+ * @param now the current time
+ */
+static void watchResult(ModemAdaptiveDelayState* state, const uint8_t* data, uint16_t len, uint32_t now)
+{
+    uint16_t i;
+    for (i = 0; i < len; ++i)
+    {
+        uint8_t ch = data[i];
+        if ((ch != '\r') && (ch != '\n'))
+        {
+            if (state->resultLineLen < RESULT_LINE_LEN)
+            {
+                state->resultLine[state->resultLineLen++] = ch;
+            }
+            continue;
+        }
+        if (state->resultLineLen == 0)
+        {
+            continue;
+        }
+        if (!state->awaitingResponse)
+        {
+            /* A line between commands is the server's reply or a URC */
+            state->awaitingServer = false;
+        }
+        else if (isFinalResult(state->resultLine, state->resultLineLen))
+        {
+            uint32_t response = now - state->lastSend;
+            state->awaitingResponse = false;
+            EWMA(state->stats.responseMs, (uint16_t)((response < 0xFFFF) ? response : 0xFFFF));
+        }
+        state->resultLineLen = 0;
+    }
+}
+
+/**
+ * Callback from the inner transport with modem output.
+ *
+ * @param cookie the adaptive delay state
+ * @param data the modem output
+ * @param len the length of the modem output
+ */
+static void modem_adaptive_delay_callback(void* cookie, uint8_t* data, uint16_t len)
+{
+    ModemAdaptiveDelayState* state = (ModemAdaptiveDelayState*)cookie;
+    uint32_t now = Thingstream_Platform_getTimeMillis();
+
+    watchResult(state, data, len, now);
+    state->lastActivity = now;
+    if ((state->control == MODEM_SLEEP_TIMER) && state->asleep)
+    {
+        /* The modem has woken itself to send a URC */
+        state->stats.asleepMs += now - state->sleepStart;
+        state->asleep = false;
+    }
+
+    if (!state->waking)
+    {
+        if (state->callback != NULL)
+        {
+            state->callback(state->cookie, data, len);
+        }
+        return;
+    }
+
+    /* Consume the answers to the wake probes, pass other lines on */
+    uint16_t i;
+    for (i = 0; i < len; ++i)
+    {
+        uint8_t ch = data[i];
+        state->wakeLine[state->wakeLineLen++] = ch;
+        bool lineEnd = (ch == '\n');
+        if (lineEnd || (state->wakeLineLen == WAKE_LINE_LEN))
+        {
+            if ((!lineEnd || !wakeLine(state)) && (state->callback != NULL))
+            {
+                state->callback(state->cookie, state->wakeLine, state->wakeLineLen);
+            }
+            state->wakeLineLen = 0;
+        }
+    }
+}
+
+/**
+ * Initialize the transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param version the transport API version
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_adaptive_delay_init(ThingstreamTransport* self, uint16_t version)
+{
+    ModemAdaptiveDelayState* state = (ModemAdaptiveDelayState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+
+    if (!TRANSPORT_CHECK_VERSION_1(version))
+    {
+        return TRANSPORT_VERSION_MISMATCH;
+    }
+
+    /* The modem is awake while it is initialised */
+    if (state->asleep && (state->control == MODEM_SLEEP_DTR))
+    {
+        Platform_modemSleep(false);
+    }
+    state->asleep = false;
+    state->declined = false;
+    state->waking = false;
+    state->awaitingResponse = false;
+    state->awaitingServer = false;
+    state->resultLineLen = 0;
+    state->lastActivity = Thingstream_Platform_getTimeMillis();
+
+    ThingstreamTransportResult tRes;
+    tRes = inner->register_callback(inner, modem_adaptive_delay_callback, state);
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        tRes = inner->init(inner, version);
+    }
+    return tRes;
+}
+
+/**
+ * Shutdown the transport (i.e. the opposite of initialize)
+ *
+ * @param self the #ThingstreamTransport instance
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_adaptive_delay_shutdown(ThingstreamTransport* self)
+{
+    ModemAdaptiveDelayState* state = (ModemAdaptiveDelayState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    return inner->shutdown(inner);
+}
+
+/**
+ * Pass the buffer request to the inner transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param buffer where to write the buffer pointer
+ * @param len where the write the buffer length
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_adaptive_delay_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len)
+{
+    ModemAdaptiveDelayState* state = (ModemAdaptiveDelayState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    if (inner->get_buffer == NULL)
+    {
+        return TRANSPORT_ERROR;
+    }
+    return inner->get_buffer(inner, buffer, len);
+}
+
+/**
+ * Check whether the data sent is a command that sends a datagram.
+ *
+ * @param data the data sent to the modem
+ * @param len the length of the data
+ * @return true if the data is a socket write command
+ */
+static bool isSocketWrite(const uint8_t* data, uint16_t len)
+{
+    size_t i;
+    for (i = 0; i < SOCKET_WRITE_COMMANDS; ++i)
+    {
+        const char* command = socketWriteCommands[i];
+        if ((len >= strlen(command)) && (memcmp(data, command, strlen(command)) == 0))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Send the data to the modem, waking it first if it is asleep.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param flags an indication of the type of the data, zero is normal.
+ * @param data a pointer to the data
+ * @param len the length of the raw data
+ * @param millis the maximum number of milliseconds to run
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_adaptive_delay_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis)
+{
+    ModemAdaptiveDelayState* state = (ModemAdaptiveDelayState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    uint32_t now = Thingstream_Platform_getTimeMillis();
+    uint32_t limit = now + millis;
+    uint32_t idle = now - state->lastActivity;
+
+    considerSleep(state, now);
+    if (idle >= quietMs(state))
+    {
+        /* This ends an idle period */
+        EWMA(state->stats.idleGapMs, idle);
+        if (state->declined && !state->asleep)
+        {
+            ++state->stats.keptAwake;
+        }
+        state->declined = false;
+    }
+    if (state->asleep)
+    {
+        wake(state, flags, limit);
+        now = Thingstream_Platform_getTimeMillis();
+        if (TIME_COMPARE(now, >=, limit))
+        {
+            return TRANSPORT_SEND_TIMEOUT;
+        }
+    }
+
+    state->lastSend = now;
+    state->lastActivity = now;
+    state->awaitingResponse = true;
+    if (isSocketWrite(data, len))
+    {
+        state->awaitingServer = true;
+    }
+    return inner->send(inner, flags, data, len, limit - now);
+}
+
+/**
+ * Register a callback function that will be called when this transport
+ * has data to send to its next outermost ThingstreamTransport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param callback the callback function
+ * @param cookie a opaque value passed to the callback function
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_adaptive_delay_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie)
+{
+    ModemAdaptiveDelayState* state = (ModemAdaptiveDelayState*)self->_state;
+    state->callback = callback;
+    state->cookie = cookie;
+    return TRANSPORT_SUCCESS;
+}
+
+/**
+ * Allow the inner transport to run for at most the given number of
+ * milliseconds, and let the modem sleep if the traffic has stopped.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param millis the maximum number of milliseconds to run (a value of zero
+ *        processes all pending operations).
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_adaptive_delay_run(ThingstreamTransport* self, uint32_t millis)
+{
+    ModemAdaptiveDelayState* state = (ModemAdaptiveDelayState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    ThingstreamTransportResult tRes = inner->run(inner, millis);
+    considerSleep(state, Thingstream_Platform_getTimeMillis());
+    return tRes;
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief ThingstreamTransport implementation that lets a modem sleep
+ * between bursts of traffic and wakes it before sending, learning from the
+ * traffic when to sleep and how long the modem takes to wake.
+ */
+
+#ifndef INC_MODEM_ADAPTIVE_DELAY_TRANSPORT_H
+#define INC_MODEM_ADAPTIVE_DELAY_TRANSPORT_H
+
+#include <stdbool.h>
+
+#include "transport_api.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * How the modem is put to sleep.
+ */
+typedef enum ThingstreamModemSleepControl_e
+{
+    /** The modem sleeps after its own idle timer, as configured with an AT
+     * command in the init string (e.g. AT+UPSV=1, AT+QSCLK=1 or
+     * AT+CSCLK=1). The transport cannot choose when the modem sleeps, it
+     * assumes the modem is asleep after sleepMs without traffic. */
+    MODEM_SLEEP_TIMER,
+    /** The modem sleeps when the MCU releases its DTR line (e.g. AT+UPSV=3
+     * or AT+QSCLK=1 with DTR), which is driven by Platform_modemSleep().
+     * The transport decides for each idle period whether to let the modem
+     * sleep. */
+    MODEM_SLEEP_DTR
+} ThingstreamModemSleepControl;
+
+/**
+ * The decisions and measurements of the adaptive delay transport.
+ */
+typedef struct ThingstreamModemAdaptiveDelayStats_s
+{
+    /** The number of idle periods in which the modem slept */
+    uint32_t sleeps;
+    /** The number of idle periods in which the modem was kept awake
+     * because traffic was expected soon */
+    uint32_t keptAwake;
+    /** The number of times the modem was woken */
+    uint32_t wakes;
+    /** The number of extra wake probes needed because the modem was not
+     * ready when expected */
+    uint32_t wakeRetries;
+    /** The total time that the modem has been asleep, in milliseconds */
+    uint32_t asleepMs;
+    /** The total waiting saved compared to waiting maxWakeMs after each
+     * wake, in milliseconds */
+    uint32_t savedWaitMs;
+    /** The current estimate of the time the modem takes to wake */
+    uint16_t wakeLatencyMs;
+    /** The current estimate of the time from a command to its final
+     * result code */
+    uint16_t responseMs;
+    /** The current estimate of the length of an idle period */
+    uint32_t idleGapMs;
+} ThingstreamModemAdaptiveDelayStats;
+
+/**
+ * Create an instance of the adaptive delay transport for the modem
+ * transport. This replaces Thingstream_createModemDelayTransport() and is
+ * placed in the same position in the stack.
+ *
+ * Where the fixed delay transport always waits afterWakeMs after sending
+ * the wakeupString, this transport sends the wakeupString and then AT until
+ * the modem answers, consuming the answer. The time the modem took is used
+ * to tune the delay before the first AT of the next wake, starting from
+ * maxWakeMs and approaching the modem's real wake latency.
+ *
+ * It also learns the length of the idle periods between bursts of traffic
+ * and the time the modem takes to answer. With #MODEM_SLEEP_DTR the modem
+ * is let sleep as soon as a burst has ended if idle periods are usually
+ * long enough to be worth the wake latency, and is otherwise kept awake
+ * until it has been idle for sleepMs. A burst only ends once the last
+ * command has its final result code (OK, ERROR, +CME ERROR etc.), so the
+ * modem is never let sleep during a slow command such as AT+COPS, and
+ * after a socket write it is kept awake for up to sleepMs for the server's
+ * reply.
+ *
+ * @param inner the inner #ThingstreamTransport instance to use
+ * @param control how the modem is put to sleep
+ * @param sleepMs the number of milliseconds without traffic after which
+ *   the modem is asleep (#MODEM_SLEEP_TIMER), or is put to sleep even if
+ *   traffic is expected (#MODEM_SLEEP_DTR)
+ * @param wakeupString the string to send to the modem to wake it (e.g.
+ *   "\n"), or NULL
+ * @param maxWakeMs the longest time that the modem may take to wake
+ * @return the #ThingstreamTransport instance
+ */
+extern ThingstreamTransport* Thingstream_createModemAdaptiveDelayTransport(ThingstreamTransport* inner, ThingstreamModemSleepControl control, uint16_t sleepMs, const char* wakeupString, uint16_t maxWakeMs);
+
+/**
+ * Return the decisions and measurements of the adaptive delay transport.
+ *
+ * @param self this instance of adaptive delay transport
+ * @return the counters, which remain valid and are updated in place
+ */
+extern const ThingstreamModemAdaptiveDelayStats* Thingstream_ModemAdaptiveDelay_getStats(ThingstreamTransport* self);
+
+/**
+ * This platform supplied routine is called with #MODEM_SLEEP_DTR to let
+ * the modem sleep (release DTR) or to wake it (assert DTR).
+ * The default implementation does nothing.
+ *
+ * @ingroup porting-platform
+ * @param sleep true to let the modem sleep, false to wake it
+ */
+extern void Platform_modemSleep(bool sleep);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_MODEM_ADAPTIVE_DELAY_TRANSPORT_H */
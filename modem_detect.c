@@ -0,0 +1,856 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Detection of the fitted modem and selection of its configuration
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "modem_detect.h"
+#include "modem_udp_config.h"
+#include "client_platform.h"
+#include "platform_storage.h"
+
+/** The space for the modem's reply to a probe command */
+#define PROBE_RESPONSE_LEN  128
+
+/** The time to wait for the modem to reply to each probe command */
+#define PROBE_REPLY_MS      2000
+
+/** The time allowed for the modem to finish a command that timed out */
+#define PROBE_DRAIN_MS      10000
+
+/** The silence that shows that the modem has no more output for a probe */
+#define PROBE_QUIET_MS      200
+
+/** The space for a line of modem output checked for the operator */
+#define OPERATOR_LINE_LEN   40
+
+/** The operator report, with the numeric format, that is saved */
+#define OPERATOR_REPORT     "+COPS: "
+
+/** The command that starts registration with the saved operator */
+#define OPERATOR_SELECT     "AT+COPS=4,2,\""
+
+/** The command the modem transport issues when it fails to register */
+#define REGISTRATION_FAILED "AT+CRSM=176,28539"
+
+/** The command that asks for the operator in numeric format, then
+ * restores the long format */
+#define OPERATOR_QUERY      "AT+COPS=3,2;+COPS?;+COPS=3,0\r"
+
+/**
+ * The commands that open the modem transport's socket, once the modem has
+ * registered, in the configurations that do not report the operator in
+ * numeric format themselves.
+ */
+static const char* const socketOpenCommands[] = {
+    "AT+USOCR=",
+    "AT+QIOPEN=",
+    "AT+CAOPEN=",
+    "AT+CIPSTART=",
+    "AT+CIPOPEN=",
+    "AT^SISO=",
+};
+
+#define SOCKET_OPEN_COMMANDS (sizeof(socketOpenCommands) / sizeof(socketOpenCommands[0]))
+
+/**
+ * Map from a model name, as it appears in the reply to AT+GMM or ATI, to
+ * the modem initialisation routine. Where one name contains another the
+ * longer name is listed first.
+ */
+static const struct
+{
+    const char* model;
+    ThingstreamModemUdpInit* init;
+} modemModels[] = {
+    { "SARA-R10",  Thingstream_uBloxSaraR10Init },
+    { "SARA-R4",   Thingstream_uBloxSaraR4Init },
+    { "SARA-R5",   Thingstream_uBloxSaraR5Init },
+    { "SARA-G350", Thingstream_uBloxSaraG350Init },
+    { "SARA-G450", Thingstream_uBloxSaraG450Init },
+    { "SARA-U2",   Thingstream_uBloxSaraU2Init },
+    { "LARA-R2",   Thingstream_uBloxLaraR2Init },
+    { "LARA-R6",   Thingstream_uBloxLaraR6Init },
+    { "LENA-R8",   Thingstream_uBloxLenaR8Init },
+    { "LEXI-R10",  Thingstream_uBloxLexiR10Init },
+    { "LEXI-R4",   Thingstream_uBloxLexiR4Init },
+    { "LEXI-R5",   Thingstream_uBloxLexiR5Init },
+    { "TOBY-R2",   Thingstream_uBloxTobyR2Init },
+    { "TOBY-L2",   Thingstream_uBloxTobyL2Init },
+    { "BG77",      Thingstream_QuectelBG77Init },
+    { "BG95",      Thingstream_QuectelBG95Init },
+    { "BG96",      Thingstream_QuectelBG96Init },
+    { "EC25",      Thingstream_QuectelEC25Init },
+    { "EG800",     Thingstream_QuectelEG800Init },
+    { "UG95",      Thingstream_QuectelUG95Init },
+    { "UG96",      Thingstream_QuectelUG96Init },
+    { "MC60",      Thingstream_QuectelMC60Init },
+    { "M66",       Thingstream_QuectelM66Init },
+    { "SIM7000",   Thingstream_Simcom7000Init },
+    { "SIM7070",   Thingstream_Simcom7070Init },
+    { "SIM7080",   Thingstream_Simcom7080Init },
+    { "SIM7600",   Thingstream_Simcom7600Init },
+    { "SIM800",    Thingstream_Simcom800Init },
+    { "SIM868",    Thingstream_Simcom868Init },
+    { "L511",      Thingstream_LynqL511Init },
+    { "C16QS",     Thingstream_CavliC16QSInit },
+    { "EXS62",     Thingstream_ThalesExs62wInit },
+    { "EXS82",     Thingstream_ThalesExs82wInit },
+};
+
+#define MODEM_MODELS (sizeof(modemModels) / sizeof(modemModels[0]))
+
+/**
+ * The ModemDetectState structure is used to store state for the modem
+ * detect transport.
+ */
+typedef struct ModemDetectState_s
+{
+    /** The inner (serial) transport */
+    ThingstreamTransport* inner;
+    /** The callback registered by the outer transport */
+    ThingstreamTransportCallback_t callback;
+    /** Cookie associated with the registered callback */
+    void* cookie;
+    /** The inner transport has been initialised */
+    bool initialised;
+    /** Modem output is collected in response rather than passed on */
+    volatile bool probing;
+    /** The number of bytes in response */
+    volatile uint16_t responseLen;
+    /** The modem's reply to the latest probe command */
+    char response[PROBE_RESPONSE_LEN];
+    /** The routine that Thingstream_ModemDetectInit() dispatches to */
+    ThingstreamModemUdpInit* selected;
+    /** The number of bytes in line */
+    uint8_t lineLen;
+    /** The current line of modem output */
+    char line[OPERATOR_LINE_LEN];
+    /** The operator (plmn[,act]) reported by the modem, or empty */
+    char operatorSeen[OPERATOR_LINE_LEN];
+    /** operatorSeen has changed and is yet to be saved */
+    volatile bool operatorPending;
+    /** The modem transport has failed to register, forget the operator */
+    volatile bool operatorFailed;
+    /** The number of bytes of #REGISTRATION_FAILED sent so far */
+    uint8_t failedMatch;
+    /** Thingstream_ModemDetect_attach() has been called */
+    bool attachEnabled;
+    /** The operator has been reported, or asked for, since the boot */
+    volatile bool operatorKnown;
+    /** The modem's latest line of output was OK, so it awaits a command */
+    volatile bool modemIdle;
+} ModemDetectState;
+
+/** Instance of ModemDetectState */
+static ModemDetectState _modem_detect_transport_state;
+
+static ThingstreamTransportResult modem_detect_init(ThingstreamTransport* self, uint16_t version);
+static ThingstreamTransportResult modem_detect_shutdown(ThingstreamTransport* self);
+static ThingstreamTransportResult modem_detect_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len);
+static ThingstreamTransportResult modem_detect_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis);
+static ThingstreamTransportResult modem_detect_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie);
+static ThingstreamTransportResult modem_detect_run(ThingstreamTransport* self, uint32_t millis);
+
+/** Instance of ThingstreamTransport for the modem detect transport */
+static const ThingstreamTransport _modem_detect_transport_instance = {
+    (ThingstreamTransportState_t*)&_modem_detect_transport_state,
+    modem_detect_init,
+    modem_detect_shutdown,
+    modem_detect_get_buffer,
+    NULL, /* This slot no longer used */
+    modem_detect_send,
+    modem_detect_register_callback,
+    NULL, /* This slot no longer used */
+    modem_detect_run
+};
+
+
+const struct ThingstreamModemUdpConfig_s* Thingstream_ModemDetectInit(uint32_t version, struct ThingstreamModemSharedState_s* gState)
+{
+    ThingstreamModemUdpInit* selected = _modem_detect_transport_state.selected;
+    if (selected == NULL)
+    {
+        selected = Thingstream_UssdInit;
+    }
+    return selected(version, gState);
+}
+
+
+ThingstreamTransport* Thingstream_createModemDetectTransport(ThingstreamTransport* inner)
+{
+    ThingstreamTransport* self = (ThingstreamTransport*)&_modem_detect_transport_instance;
+    ModemDetectState* state = (ModemDetectState*)self->_state;
+
+    if (inner == NULL)
+    {
+        return NULL;
+    }
+    memset(state, 0, sizeof(*state));
+    state->inner = inner;
+    return self;
+}
+
+
+/**
+ * Return true if the text contains the pattern.
+ */
+static bool contains(const char* text, uint16_t len, const char* pattern)
+{
+    uint16_t patternLen = (uint16_t)strlen(pattern);
+    uint16_t i;
+    for (i = 0; i + patternLen <= len; ++i)
+    {
+        if (memcmp(&text[i], pattern, patternLen) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Return the index in modemModels of the model named in the text, or
+ * MODEM_MODELS if there is none.
+ */
+static size_t findModel(const char* text, uint16_t len)
+{
+    size_t i;
+    for (i = 0; i < MODEM_MODELS; ++i)
+    {
+        if (contains(text, len, modemModels[i].model))
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+/**
+ * Send a command and collect the reply until the final result code.
+ *
+ * @param state the modem detect state
+ * @param command the command, including the terminating '\\r'
+ * @param replyMs the time to wait for the reply
+ * @param limit the time limit
+ * @return true if the modem replied OK
+ */
+static bool probeFor(ModemDetectState* state, const char* command, uint32_t replyMs, uint32_t limit)
+{
+    ThingstreamTransport* inner = state->inner;
+    uint32_t now = Thingstream_Platform_getTimeMillis();
+    uint32_t replyLimit = now + replyMs;
+    if (TIME_COMPARE(replyLimit, >, limit))
+    {
+        replyLimit = limit;
+    }
+    if (TIME_COMPARE(now, >=, replyLimit))
+    {
+        return false;
+    }
+
+    state->responseLen = 0;
+    if (inner->send(inner, 0, (uint8_t*)command, (uint16_t)strlen(command),
+                    replyLimit - now) != TRANSPORT_SUCCESS)
+    {
+        return false;
+    }
+    for (;;)
+    {
+        uint16_t len = state->responseLen;
+        if (contains(state->response, len, "\nOK\r"))
+        {
+            return true;
+        }
+        if (contains(state->response, len, "ERROR"))
+        {
+            return false;
+        }
+        now = Thingstream_Platform_getTimeMillis();
+        if (TIME_COMPARE(now, >=, replyLimit))
+        {
+            return false;
+        }
+        (void)inner->run(inner, replyLimit - now);
+    }
+}
+
+/**
+ * Send a probe command and collect the reply until the final result code.
+ *
+ * @param state the modem detect state
+ * @param command the command, including the terminating '\\r'
+ * @param limit the time limit
+ * @return true if the modem replied OK
+ */
+static bool probe(ModemDetectState* state, const char* command, uint32_t limit)
+{
+    return probeFor(state, command, PROBE_REPLY_MS, limit);
+}
+
+/**
+ * Return true if the response holds a final result code.
+ */
+static bool finalResult(ModemDetectState* state)
+{
+    uint16_t len = state->responseLen;
+    return contains(state->response, len, "\nOK\r")
+        || contains(state->response, len, "ERROR");
+}
+
+/**
+ * Wait for the modem to finish a probe command that timed out, so that its
+ * late final result code is not passed on to the modem transport. A
+ * command still running (e.g. AT+COPS) is aborted by the next character on
+ * the modems that support it, so AT is sent until the modem answers OK and
+ * the modem's output then stops.
+ *
+ * @param state the modem detect state
+ */
+static void drain(ModemDetectState* state)
+{
+    ThingstreamTransport* inner = state->inner;
+    uint32_t limit = Thingstream_Platform_getTimeMillis() + PROBE_DRAIN_MS;
+
+    while (!probe(state, "AT\r", limit))
+    {
+        if (TIME_COMPARE(Thingstream_Platform_getTimeMillis(), >=, limit))
+        {
+            return;
+        }
+    }
+    for (;;)
+    {
+        uint16_t len = state->responseLen;
+        uint32_t now = Thingstream_Platform_getTimeMillis();
+        uint32_t quiet = now + PROBE_QUIET_MS;
+        while (TIME_COMPARE(now, <, quiet) && (state->responseLen == len))
+        {
+            (void)inner->run(inner, quiet - now);
+            now = Thingstream_Platform_getTimeMillis();
+        }
+        if ((state->responseLen == len) || TIME_COMPARE(now, >=, limit))
+        {
+            return;
+        }
+    }
+}
+
+ThingstreamModemUdpInit* Thingstream_ModemDetect_select(ThingstreamTransport* self, ThingstreamModemUdpInit* udpConfigInit, uint32_t millis)
+{
+    ModemDetectState* state = (ModemDetectState*)self->_state;
+    uint32_t limit = Thingstream_Platform_getTimeMillis() + millis;
+    char saved[PLATFORM_STORAGE_MAX_LEN];
+    uint16_t savedLen;
+    size_t savedModel = MODEM_MODELS;
+    size_t model = MODEM_MODELS;
+
+    if (udpConfigInit != Thingstream_ModemDetectInit)
+    {
+        return udpConfigInit;
+    }
+
+    /* Look up the model found on an earlier boot if there is one */
+    savedLen = Platform_storageRead(PLATFORM_STORAGE_KEY_MODEM_MODEL,
+                                    (uint8_t*)saved, sizeof(saved));
+    if (savedLen > 0)
+    {
+        size_t i;
+        for (i = 0; i < MODEM_MODELS; ++i)
+        {
+            if ((strlen(modemModels[i].model) == savedLen)
+                && (memcmp(modemModels[i].model, saved, savedLen) == 0))
+            {
+                savedModel = i;
+                break;
+            }
+        }
+    }
+
+    if (modem_detect_init(self, TRANSPORT_VERSION) == TRANSPORT_SUCCESS)
+    {
+        state->probing = true;
+
+        /* Wait for the modem to finish booting */
+        bool alive = false;
+        while (!alive && TIME_COMPARE(Thingstream_Platform_getTimeMillis(), <, limit))
+        {
+            alive = probe(state, "AT\r", limit);
+        }
+
+        /* Trust the saved model only if the modem fitted now reports it */
+        if (alive && (savedModel < MODEM_MODELS) && probe(state, "ATI\r", limit)
+            && (findModel(state->response, state->responseLen) == savedModel))
+        {
+            model = savedModel;
+        }
+        if (alive && (model == MODEM_MODELS) && probe(state, "AT+GMM\r", limit))
+        {
+            model = findModel(state->response, state->responseLen);
+        }
+        if (alive && (model == MODEM_MODELS) && probe(state, "ATI\r", limit))
+        {
+            model = findModel(state->response, state->responseLen);
+        }
+        if (alive && !finalResult(state))
+        {
+            drain(state);
+        }
+
+        state->probing = false;
+
+        if ((model < MODEM_MODELS) && (model != savedModel))
+        {
+            const char* name = modemModels[model].model;
+            (void)Platform_storageWrite(PLATFORM_STORAGE_KEY_MODEM_MODEL,
+                                        (const uint8_t*)name,
+                                        (uint16_t)strlen(name));
+        }
+    }
+
+    state->selected = (model < MODEM_MODELS) ? modemModels[model].init : Thingstream_UssdInit;
+    return state->selected;
+}
+
+
+ThingstreamTransportResult Thingstream_ModemDetect_attach(ThingstreamTransport* self, uint32_t millis)
+{
+    ModemDetectState* state = (ModemDetectState*)self->_state;
+    uint32_t limit = Thingstream_Platform_getTimeMillis() + millis;
+    char command[sizeof(OPERATOR_SELECT) + PLATFORM_STORAGE_MAX_LEN + 2];
+    char* p = command;
+    uint16_t savedLen;
+
+    /* Ask for the operator once the modem has registered */
+    state->attachEnabled = true;
+
+    memcpy(p, OPERATOR_SELECT, strlen(OPERATOR_SELECT));
+    p += strlen(OPERATOR_SELECT);
+    savedLen = Platform_storageRead(PLATFORM_STORAGE_KEY_MODEM_OPERATOR,
+                                    (uint8_t*)p, PLATFORM_STORAGE_MAX_LEN);
+    if ((savedLen == 0) || (savedLen >= sizeof(state->operatorSeen)))
+    {
+        return TRANSPORT_SUCCESS;
+    }
+    memcpy(state->operatorSeen, p, savedLen);
+    state->operatorSeen[savedLen] = '\0';
+
+    /* The saved value is plmn[,act], only the plmn is quoted */
+    char* end = p + savedLen;
+    char* comma = memchr(p, ',', savedLen);
+    if (comma != NULL)
+    {
+        memmove(comma + 1, comma, end - comma);
+        *comma = '"';
+        ++end;
+    }
+    else
+    {
+        *end++ = '"';
+    }
+    *end++ = '\r';
+    *end = '\0';
+
+    ThingstreamTransportResult tRes = modem_detect_init(self, TRANSPORT_VERSION);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return tRes;
+    }
+    state->probing = true;
+
+    /* Wait for the modem to finish booting */
+    bool alive = false;
+    while (!alive && TIME_COMPARE(Thingstream_Platform_getTimeMillis(), <, limit))
+    {
+        alive = probe(state, "AT\r", limit);
+    }
+
+    /* The modem answers once it has tried the operator, and falls back to
+     * automatic selection if that fails
+     */
+    if (!alive)
+    {
+        tRes = TRANSPORT_SEND_TIMEOUT;
+    }
+    else if (!probeFor(state, command, millis, limit))
+    {
+        if (contains(state->response, state->responseLen, "ERROR"))
+        {
+            (void)Platform_storageWrite(PLATFORM_STORAGE_KEY_MODEM_OPERATOR, NULL, 0);
+            state->operatorSeen[0] = '\0';
+            tRes = TRANSPORT_MODEM_ERROR;
+        }
+        else
+        {
+            /* The modem may still be searching, wait for it to finish */
+            drain(state);
+            tRes = TRANSPORT_SEND_TIMEOUT;
+        }
+    }
+
+    state->probing = false;
+    return tRes;
+}
+
+
+void Thingstream_ModemDetect_forget(void)
+{
+    (void)Platform_storageWrite(PLATFORM_STORAGE_KEY_MODEM_MODEL, NULL, 0);
+    (void)Platform_storageWrite(PLATFORM_STORAGE_KEY_MODEM_OPERATOR, NULL, 0);
+}
+
+
+/**
+ * Check a line of modem output for the operator in numeric format, e.g.
+ * +COPS: 0,2,"23415",7 and note it to be saved if it has changed.
+ *
+ * @param state the modem detect state
+ */
+static void operatorLine(ModemDetectState* state)
+{
+    const char* p = state->line;
+    const char* end = p + state->lineLen;
+    const char* plmn;
+    const char* plmnEnd;
+    char seen[OPERATOR_LINE_LEN];
+    uint16_t len;
+
+    if ((state->lineLen <= strlen(OPERATOR_REPORT))
+        || (memcmp(p, OPERATOR_REPORT, strlen(OPERATOR_REPORT)) != 0))
+    {
+        return;
+    }
+    p += strlen(OPERATOR_REPORT);
+    while ((p < end) && (*p != ','))
+    {
+        ++p;
+    }
+    if ((end - p < 4) || (memcmp(p, ",2,\"", 4) != 0))
+    {
+        return;
+    }
+    plmn = p + 4;
+    for (plmnEnd = plmn; (plmnEnd < end) && (*plmnEnd >= '0') && (*plmnEnd <= '9'); ++plmnEnd)
+    {
+    }
+    if ((plmnEnd == plmn) || (plmnEnd == end) || (*plmnEnd != '"'))
+    {
+        return;
+    }
+
+    /* Keep the plmn, and the radio access technology if present */
+    len = (uint16_t)(plmnEnd - plmn);
+    memcpy(seen, plmn, len);
+    p = plmnEnd + 1;
+    if ((p < end) && (*p == ','))
+    {
+        while ((p < end) && (len < sizeof(seen) - 1) && (*p != '\r') && (*p != '\n'))
+        {
+            seen[len++] = *p++;
+        }
+    }
+    seen[len] = '\0';
+    state->operatorKnown = true;
+    if (strcmp(seen, state->operatorSeen) != 0)
+    {
+        memcpy(state->operatorSeen, seen, len + 1);
+        state->operatorPending = true;
+    }
+}
+
+/**
+ * Watch the modem output for its operator.
+ *
+ * @param state the modem detect state
+ * @param data the modem output
+ * @param len the length of the modem output
+ */
+static void watchOutput(ModemDetectState* state, const uint8_t* data, uint16_t len)
+{
+    uint16_t i;
+    for (i = 0; i < len; ++i)
+    {
+        char ch = (char)data[i];
+        if ((ch == '\r') || (ch == '\n'))
+        {
+            if (state->lineLen > 0)
+            {
+                state->modemIdle = (state->lineLen == 2)
+                                && (memcmp(state->line, "OK", 2) == 0);
+                operatorLine(state);
+            }
+            state->lineLen = 0;
+        }
+        else if (state->lineLen < sizeof(state->line))
+        {
+            state->line[state->lineLen++] = ch;
+        }
+    }
+}
+
+
+/**
+ * Callback from the inner transport with modem output.
+ * This may be called from an interrupt handler.
+ *
+ * @param cookie the modem detect state
+ * @param data the modem output
+ * @param len the length of the modem output
+ */
+static void modem_detect_callback(void* cookie, uint8_t* data, uint16_t len)
+{
+    ModemDetectState* state = (ModemDetectState*)cookie;
+    if (state->probing)
+    {
+        uint16_t used = state->responseLen;
+        uint16_t room = PROBE_RESPONSE_LEN - used;
+        if (len > room)
+        {
+            len = room;
+        }
+        memcpy(&state->response[used], data, len);
+        state->responseLen = used + len;
+    }
+    else
+    {
+        watchOutput(state, data, len);
+        if (state->callback != NULL)
+        {
+            state->callback(state->cookie, data, len);
+        }
+    }
+}
+
+/**
+ * Initialize the transport. The inner transport is only initialised once,
+ * either by Thingstream_ModemDetect_select() or by the outer transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param version the transport API version
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_detect_init(ThingstreamTransport* self, uint16_t version)
+{
+    ModemDetectState* state = (ModemDetectState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+
+    if (!TRANSPORT_CHECK_VERSION_1(version))
+    {
+        return TRANSPORT_VERSION_MISMATCH;
+    }
+    if (state->initialised)
+    {
+        return TRANSPORT_SUCCESS;
+    }
+
+    ThingstreamTransportResult tRes;
+    tRes = inner->register_callback(inner, modem_detect_callback, state);
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        tRes = inner->init(inner, version);
+    }
+    state->initialised = (tRes == TRANSPORT_SUCCESS);
+    return tRes;
+}
+
+/**
+ * Shutdown the transport (i.e. the opposite of initialize)
+ *
+ * @param self the #ThingstreamTransport instance
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_detect_shutdown(ThingstreamTransport* self)
+{
+    ModemDetectState* state = (ModemDetectState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    state->initialised = false;
+    return inner->shutdown(inner);
+}
+
+/**
+ * Pass the buffer request to the inner transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param buffer where to write the buffer pointer
+ * @param len where the write the buffer length
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_detect_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len)
+{
+    ModemDetectState* state = (ModemDetectState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    if (inner->get_buffer == NULL)
+    {
+        return TRANSPORT_ERROR;
+    }
+    return inner->get_buffer(inner, buffer, len);
+}
+
+/**
+ * Watch the commands sent to the modem for #REGISTRATION_FAILED. The
+ * command is matched wherever it appears, so that it is still found when a
+ * CMUX multiplexer above this transport has put it in a frame.
+ *
+ * @param state the modem detect state
+ * @param data the data sent to the modem
+ * @param len the length of the data
+ */
+static void watchCommands(ModemDetectState* state, const uint8_t* data, uint16_t len)
+{
+    uint16_t i;
+    for (i = 0; i < len; ++i)
+    {
+        char ch = (char)data[i];
+        if (ch == REGISTRATION_FAILED[state->failedMatch])
+        {
+            if (++state->failedMatch == strlen(REGISTRATION_FAILED))
+            {
+                /* The saved operator did not help, let the modem search again */
+                state->operatorFailed = true;
+                state->failedMatch = 0;
+            }
+        }
+        else
+        {
+            state->failedMatch = (ch == REGISTRATION_FAILED[0]) ? 1 : 0;
+        }
+    }
+}
+
+/**
+ * Return true if the data is a command that opens the modem transport's
+ * socket. Commands in a CMUX frame are not recognised, as nothing can be
+ * inserted between them.
+ */
+static bool isSocketOpen(const uint8_t* data, uint16_t len)
+{
+    size_t i;
+    for (i = 0; i < SOCKET_OPEN_COMMANDS; ++i)
+    {
+        const char* command = socketOpenCommands[i];
+        if ((len >= strlen(command)) && (memcmp(data, command, strlen(command)) == 0))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Ask the registered modem for its operator in numeric format, for the
+ * configurations that do not report it themselves, so that it can be saved
+ * for Thingstream_ModemDetect_attach(). This is done once per boot, before
+ * the modem transport opens its socket.
+ *
+ * @param state the modem detect state
+ */
+static void queryOperator(ModemDetectState* state)
+{
+    uint32_t limit = Thingstream_Platform_getTimeMillis() + PROBE_REPLY_MS;
+
+    state->operatorKnown = true;
+    state->probing = true;
+    if (probe(state, OPERATOR_QUERY, limit))
+    {
+        /* The reply is checked as though it had been passed on */
+        state->lineLen = 0;
+        watchOutput(state, (const uint8_t*)state->response, state->responseLen);
+        state->lineLen = 0;
+    }
+    else if (!finalResult(state))
+    {
+        drain(state);
+    }
+    state->probing = false;
+}
+
+/**
+ * Send the data to the inner transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param flags an indication of the type of the data, zero is normal.
+ * @param data a pointer to the data
+ * @param len the length of the raw data
+ * @param millis the maximum number of milliseconds to run
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_detect_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis)
+{
+    ModemDetectState* state = (ModemDetectState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+
+    watchCommands(state, data, len);
+    if (state->attachEnabled && !state->operatorKnown && state->modemIdle
+        && isSocketOpen(data, len))
+    {
+        queryOperator(state);
+    }
+    state->modemIdle = false;
+    return inner->send(inner, flags, data, len, millis);
+}
+
+/**
+ * Register a callback function that will be called when this transport
+ * has data to send to its next outermost ThingstreamTransport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param callback the callback function
+ * @param cookie a opaque value passed to the callback function
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_detect_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie)
+{
+    ModemDetectState* state = (ModemDetectState*)self->_state;
+    state->callback = callback;
+    state->cookie = cookie;
+    return TRANSPORT_SUCCESS;
+}
+
+/**
+ * Allow the inner transport to run for at most the given number of
+ * milliseconds. A change to the operator is saved first.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param millis the maximum number of milliseconds to run (a value of zero
+ *        processes all pending operations).
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_detect_run(ThingstreamTransport* self, uint32_t millis)
+{
+    ModemDetectState* state = (ModemDetectState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    if (state->operatorFailed)
+    {
+        state->operatorFailed = false;
+        state->operatorPending = false;
+        state->operatorSeen[0] = '\0';
+        (void)Platform_storageWrite(PLATFORM_STORAGE_KEY_MODEM_OPERATOR, NULL, 0);
+    }
+    else if (state->operatorPending)
+    {
+        state->operatorPending = false;
+        (void)Platform_storageWrite(PLATFORM_STORAGE_KEY_MODEM_OPERATOR,
+                                    (const uint8_t*)state->operatorSeen,
+                                    (uint16_t)strlen(state->operatorSeen));
+    }
+    return inner->run(inner, millis);
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Detection of the fitted modem and selection of its configuration
+ */
+
+#ifndef INC_MODEM_DETECT_H
+#define INC_MODEM_DETECT_H
+
+#include "transport_api.h"
+#include "modem_transport.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * A modem initialisation routine that dispatches to the routine chosen by
+ * Thingstream_ModemDetect_select(). Use this in place of a particular
+ * modem's routine (e.g. as UDP_MODEM_INIT) when the same firmware must run
+ * with different modems.
+ * If no modem has been selected this behaves as #Thingstream_UssdInit.
+ */
+extern ThingstreamModemUdpInit Thingstream_ModemDetectInit;
+
+/**
+ * Create an instance of the modem detect transport.
+ *
+ * This transport is placed directly above the serial transport and passes
+ * all traffic through. It allows Thingstream_ModemDetect_select() and
+ * Thingstream_ModemDetect_attach() to talk to the modem before the rest of
+ * the stack is created, and ignores the second initialisation made when the
+ * stack is initialised.
+ *
+ * @param inner the inner (serial) #ThingstreamTransport instance to use
+ * @return the #ThingstreamTransport instance
+ */
+extern ThingstreamTransport* Thingstream_createModemDetectTransport(ThingstreamTransport* inner);
+
+/**
+ * Choose the modem initialisation routine to pass to
+ * Thingstream_createModemTransport().
+ *
+ * If udpConfigInit is not #Thingstream_ModemDetectInit it is returned
+ * unchanged. Otherwise the model saved by an earlier boot (see
+ * platform_storage.h) is used once the reply to ATI confirms it, or if
+ * there is none (or another modem has been fitted) the modem is asked for
+ * its model with AT+GMM, then ATI, and the reply is matched against the
+ * models supported by the SDK. The model found is saved so that later boots
+ * skip the AT+GMM probe. Nothing is saved unless the platform provides
+ * non-volatile storage.
+ *
+ * @param self this instance of modem detect transport
+ * @param udpConfigInit the configured modem initialisation routine
+ * @param millis the maximum number of milliseconds to wait for the modem
+ * @return the initialisation routine of the fitted modem, or
+ *    #Thingstream_UssdInit if the modem was not recognised.
+ */
+extern ThingstreamModemUdpInit* Thingstream_ModemDetect_select(ThingstreamTransport* self, ThingstreamModemUdpInit* udpConfigInit, uint32_t millis);
+
+/**
+ * Start registration with the operator that the modem last registered
+ * with, so that the modem can skip the full operator search.
+ *
+ * The modem detect transport watches for the operator reported in numeric
+ * format (+COPS: 0,2,"plmn",act) and saves it (see platform_storage.h).
+ * Unless a configuration has already reported it that way, it asks once
+ * per boot, when the modem transport first opens its socket (unless CMUX
+ * is used above this transport). If an operator has been saved this selects
+ * it with AT+COPS=4,2,"plmn",act, which falls back to automatic selection
+ * if that operator cannot be used, and waits for the modem to answer. If
+ * the modem does not answer in time the command is aborted, and its late
+ * answer consumed, before the modem is handed to the modem transport. The
+ * saved operator is forgotten if the modem rejects the command, or if the
+ * modem transport later fails to register and starts to check the SIM's
+ * forbidden operator list.
+ *
+ * This only helps if the saved operator survives until the next boot. The
+ * default storage in platform_storage.c stores nothing, so this does
+ * nothing unless Platform_storageRead() and Platform_storageWrite() are
+ * overridden with non-volatile storage.
+ *
+ * Call this after Thingstream_ModemDetect_select() and before the modem
+ * transport is initialised.
+ *
+ * @param self this instance of modem detect transport
+ * @param millis the maximum number of milliseconds to wait for the modem
+ * @return a #ThingstreamTransportResult status code (success / fail);
+ *    success if no operator has been saved
+ */
+extern ThingstreamTransportResult Thingstream_ModemDetect_attach(ThingstreamTransport* self, uint32_t millis);
+
+/**
+ * Forget the saved model and operator so that the next call to
+ * Thingstream_ModemDetect_select() probes the modem again.
+ */
+extern void Thingstream_ModemDetect_forget(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_MODEM_DETECT_H */
@@ -0,0 +1,216 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Discovery of the largest UDP datagram that the network path
+ * delivers
+ */
+
+#include <string.h>
+
+#include "modem_mtu.h"
+#include "modem_transport.h"
+#include "platform_storage.h"
+
+/** The space for an operator (plmn[,act]) in a saved entry */
+#define MTU_OPERATOR_LEN    10
+
+/** The size of a saved entry: the operator and a 16-bit size */
+#define MTU_ENTRY_LEN       (MTU_OPERATOR_LEN + 2)
+
+#if (MODEM_MTU_OPERATORS * MTU_ENTRY_LEN) > PLATFORM_STORAGE_MAX_LEN
+#error "MODEM_MTU_OPERATORS entries do not fit in platform storage"
+#endif
+
+/** The MQTT-SN PUBLISH header, with a one byte length field */
+#define PUBLISH_HEADER      7
+
+/** The longer length field needed by packets of 256 bytes or more */
+#define LONG_LENGTH_EXTRA   2
+
+/** The saved sizes, most recently found first */
+typedef struct MtuTable_s
+{
+    uint8_t entries;
+    uint8_t data[MODEM_MTU_OPERATORS * MTU_ENTRY_LEN];
+} MtuTable;
+
+
+/**
+ * Read the current operator, as saved by the modem detect transport, or
+ * an empty string if there is none.
+ */
+static void currentOperator(char* op)
+{
+    char saved[PLATFORM_STORAGE_MAX_LEN];
+    uint16_t len = Platform_storageRead(PLATFORM_STORAGE_KEY_MODEM_OPERATOR,
+                                        (uint8_t*)saved, sizeof(saved));
+    if (len >= MTU_OPERATOR_LEN)
+    {
+        len = MTU_OPERATOR_LEN - 1;
+    }
+    memset(op, 0, MTU_OPERATOR_LEN);
+    memcpy(op, saved, len);
+}
+
+/**
+ * Read the saved sizes.
+ */
+static void readTable(MtuTable* table)
+{
+    uint16_t len = Platform_storageRead(PLATFORM_STORAGE_KEY_MODEM_MTU,
+                                        table->data, sizeof(table->data));
+    table->entries = (uint8_t)(len / MTU_ENTRY_LEN);
+}
+
+/**
+ * Return the index of the operator's entry in the table, or the number of
+ * entries if there is none.
+ */
+static uint8_t findEntry(const MtuTable* table, const char* op)
+{
+    uint8_t i;
+    for (i = 0; i < table->entries; ++i)
+    {
+        if (memcmp(&table->data[i * MTU_ENTRY_LEN], op, MTU_OPERATOR_LEN) == 0)
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+/**
+ * Return the size of the datagram that carries a QoS 1 publish of the
+ * given payload.
+ */
+static uint16_t datagramSize(uint16_t payload, bool base64)
+{
+    uint32_t size = (uint32_t)payload + PUBLISH_HEADER;
+    if (size > 255)
+    {
+        size += LONG_LENGTH_EXTRA;
+    }
+    if (base64)
+    {
+        size = ((size + 2) / 3) * 4;
+    }
+    return (size > 0xFFFF) ? 0xFFFF : (uint16_t)size;
+}
+
+/**
+ * Publish a probe and return true if it was acknowledged.
+ */
+static bool probe(ThingstreamClient* client, ThingstreamTopic topic, uint8_t* buffer, uint16_t payload)
+{
+    return Thingstream_Client_publish(client, topic, ThingstreamQOS1, false,
+                                      buffer, payload) == CLIENT_SUCCESS;
+}
+
+
+uint16_t Thingstream_ModemMtu_apply(ThingstreamTransport* modem)
+{
+    char op[MTU_OPERATOR_LEN];
+    MtuTable table;
+    uint8_t i;
+
+    currentOperator(op);
+    readTable(&table);
+    i = findEntry(&table, op);
+    if (i == table.entries)
+    {
+        return 0;
+    }
+    const uint8_t* entry = &table.data[i * MTU_ENTRY_LEN];
+    uint16_t mss = (uint16_t)((entry[MTU_OPERATOR_LEN] << 8) | entry[MTU_OPERATOR_LEN + 1]);
+    if (Thingstream_Modem_setBearerMSS(modem, mss) != TRANSPORT_SUCCESS)
+    {
+        return 0;
+    }
+    return mss;
+}
+
+
+uint16_t Thingstream_ModemMtu_probe(ThingstreamClient* client, ThingstreamTopic topic, bool base64, uint8_t* buffer, uint16_t bufSize)
+{
+    uint16_t lo = 0;
+    uint16_t hi = bufSize;
+
+    /* The largest payload that is assumed to be delivered */
+    while ((lo < hi) && (datagramSize(lo + 1, base64) <= MODEM_MTU_MIN))
+    {
+        ++lo;
+    }
+    memset(buffer, 0, bufSize);
+    if (!probe(client, topic, buffer, lo))
+    {
+        return 0;
+    }
+
+    /* Most paths deliver the largest size, try it first */
+    if ((hi > lo) && probe(client, topic, buffer, hi))
+    {
+        lo = hi;
+    }
+    else if (hi > lo)
+    {
+        --hi;
+    }
+    while (datagramSize(hi, base64) - datagramSize(lo, base64) > MODEM_MTU_RESOLUTION)
+    {
+        uint16_t mid = (uint16_t)(lo + (hi - lo + 1) / 2);
+        if (probe(client, topic, buffer, mid))
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+
+    /* Save the size for this operator, as the most recent entry */
+    uint16_t mss = datagramSize(lo, base64);
+    char op[MTU_OPERATOR_LEN];
+    MtuTable table;
+    uint8_t i;
+
+    currentOperator(op);
+    readTable(&table);
+    i = findEntry(&table, op);
+    if (i == table.entries)
+    {
+        if (table.entries < MODEM_MTU_OPERATORS)
+        {
+            ++table.entries;
+        }
+        i = table.entries - 1;
+    }
+    memmove(&table.data[MTU_ENTRY_LEN], &table.data[0], i * MTU_ENTRY_LEN);
+    memcpy(&table.data[0], op, MTU_OPERATOR_LEN);
+    table.data[MTU_OPERATOR_LEN] = (uint8_t)(mss >> 8);
+    table.data[MTU_OPERATOR_LEN + 1] = (uint8_t)mss;
+    (void)Platform_storageWrite(PLATFORM_STORAGE_KEY_MODEM_MTU, table.data,
+                                (uint16_t)(table.entries * MTU_ENTRY_LEN));
+    return mss;
+}
+
+
+void Thingstream_ModemMtu_forget(void)
+{
+    (void)Platform_storageWrite(PLATFORM_STORAGE_KEY_MODEM_MTU, NULL, 0);
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Discovery of the largest UDP datagram that the network path
+ * delivers, and automatic setting of the modem transport's bearer MSS
+ */
+
+#ifndef INC_MODEM_MTU_H
+#define INC_MODEM_MTU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "transport_api.h"
+#include "client_api.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * The smallest datagram size that is assumed to be delivered by any
+ * network path.
+ * @hideinitializer
+ */
+#ifndef MODEM_MTU_MIN
+#define MODEM_MTU_MIN 256
+#endif
+
+/**
+ * The probe stops when the largest delivered and smallest lost sizes are
+ * this close.
+ * @hideinitializer
+ */
+#ifndef MODEM_MTU_RESOLUTION
+#define MODEM_MTU_RESOLUTION 32
+#endif
+
+/**
+ * The number of operators for which the discovered size is kept.
+ * @hideinitializer
+ */
+#ifndef MODEM_MTU_OPERATORS
+#define MODEM_MTU_OPERATORS 4
+#endif
+
+/**
+ * Set the bearer MSS of the modem transport to the size found by
+ * Thingstream_ModemMtu_probe() for the current operator, so that the
+ * protocol transport fragments long messages at that size.
+ *
+ * The current operator is the one saved by the modem detect transport (see
+ * Thingstream_ModemDetect_attach()). The sizes and operator are kept with
+ * Platform_storageWrite(), so nothing is found unless the platform
+ * provides non-volatile storage (see platform_storage.h). This must be
+ * called after the modem
+ * transport has been created and before the client is initialised, as
+ * Thingstream_Modem_setBearerMSS() requires.
+ *
+ * @param modem the modem transport instance
+ * @return the MSS that has been set, or zero if no size has been found for
+ *   the current operator (the MSS is left unchanged)
+ */
+extern uint16_t Thingstream_ModemMtu_apply(ThingstreamTransport* modem);
+
+/**
+ * Find the largest datagram that the network path delivers, and save it
+ * for the current operator to be set by Thingstream_ModemMtu_apply() when
+ * the stack is next created.
+ *
+ * Datagrams of increasing size are published at QoS 1 to the given topic,
+ * each one's PUBACK showing that a datagram of that size was delivered, in
+ * a binary search between #MODEM_MTU_MIN and the largest publish that fits
+ * in the buffer. A lost datagram costs the client's full retry time, so
+ * this should be run once per operator (e.g. when
+ * Thingstream_ModemMtu_apply() returns zero) rather than on every boot.
+ *
+ * The client must be connected and the MSS must not have been reduced by
+ * Thingstream_ModemMtu_apply(), else the probes are fragmented. The probes
+ * count as messages, so the topic should be one that nothing subscribes
+ * to.
+ *
+ * @param client the connected client
+ * @param topic the topic to publish the probes to
+ * @param base64 true if the stack includes the base64 codec transport, so
+ *   that each datagram is larger than the MQTT-SN packet it carries
+ * @param buffer a buffer for the probe payload, its size is the largest
+ *   publish that is tried
+ * @param bufSize the size of the buffer
+ * @return the largest datagram size delivered, or zero if the smallest
+ *   probe was lost
+ */
+extern uint16_t Thingstream_ModemMtu_probe(ThingstreamClient* client, ThingstreamTopic topic, bool base64, uint8_t* buffer, uint16_t bufSize);
+
+/**
+ * Forget the sizes found for all operators.
+ */
+extern void Thingstream_ModemMtu_forget(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_MODEM_MTU_H */
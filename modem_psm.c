@@ -0,0 +1,377 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief 3GPP Power Saving Mode (PSM) and eDRX configuration
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "modem_psm.h"
+#include "modem_transport.h"
+#include "client_platform.h"
+#include "thingstream_util.h"
+
+/** The registration report, with the PSM timers when enabled by AT+CEREG=4 */
+#define CEREG_REPORT        "+CEREG: "
+
+/** The eDRX report, enabled by AT+CEDRXS=2 */
+#define CEDRXP_REPORT       "+CEDRXP: "
+
+/** The most fields expected in a +CEREG or +CEDRXP report */
+#define MAX_FIELDS          9
+
+/** The fields of a +CEREG report, after <n> in a solicited report */
+#define CEREG_STAT          0
+#define CEREG_ACTIVE_TIME   6
+#define CEREG_PERIODIC_TAU  7
+
+/** The fields of a +CEDRXP report: the access technology and the eDRX
+ * value granted */
+#define CEDRXP_ACT          0
+#define CEDRXP_NW_VALUE     2
+
+/** The time between attempts to wake the modem */
+#define RESUME_POLL_MS      1000
+
+/** A timer unit: its 3-bit code and its length in seconds */
+typedef struct TimerUnit_s
+{
+    uint8_t code;
+    uint32_t seconds;
+} TimerUnit;
+
+/** The units of the periodic TAU timer (GPRS Timer 3), shortest first */
+static const TimerUnit tauUnits[] = {
+    { 3, 2 },
+    { 4, 30 },
+    { 5, 60 },
+    { 0, 600 },
+    { 1, 3600 },
+    { 2, 36000 },
+    { 6, 1152000 },
+};
+
+/** The units of the active time (GPRS Timer 2), shortest first */
+static const TimerUnit activeUnits[] = {
+    { 0, 2 },
+    { 1, 60 },
+    { 2, 360 },
+};
+
+/** The code of a timer that is deactivated */
+#define TIMER_DEACTIVATED   7
+
+/** The eDRX cycles of WB-S1 mode (LTE-M) in milliseconds, indexed by
+ * their 4-bit value */
+static const uint32_t wbEdrxCycles[16] = {
+    5120, 10240, 20480, 40960, 61440, 81920, 102400, 122880,
+    143360, 163840, 327680, 655360, 1310720, 2621440, 5242880, 10485760
+};
+
+/** The eDRX cycles of NB-S1 mode (NB-IoT) in milliseconds, indexed by
+ * their 4-bit value. The values not defined for NB-S1 are taken as 20.48
+ * seconds, as 3GPP TS 24.008 requires. */
+static const uint32_t nbEdrxCycles[16] = {
+    20480, 20480, 20480, 40960, 20480, 81920, 20480, 20480,
+    20480, 163840, 327680, 655360, 1310720, 2621440, 5242880, 10485760
+};
+
+/** The shortest eDRX value of NB-S1 mode */
+#define NB_EDRX_MIN_VALUE   2
+
+/** The values granted by the network */
+static ThingstreamModemPsmGranted granted;
+
+/** The registration state from the last +CEREG report */
+static volatile bool registered;
+
+/** A +CEREG report has been seen since reportSeen was cleared */
+static volatile bool reportSeen;
+
+
+/**
+ * Write the low bits of value to str as a string of '0' and '1'.
+ */
+static char* writeBits(char* str, uint8_t value, uint8_t bits)
+{
+    while (bits > 0)
+    {
+        --bits;
+        *str++ = ((value >> bits) & 1) ? '1' : '0';
+    }
+    return str;
+}
+
+/**
+ * Encode a timer as the unit in the top 3 bits and the value in the low 5
+ * bits, rounding up to the next value that can be represented.
+ */
+static uint8_t encodeTimer(const TimerUnit* units, size_t count, uint32_t seconds)
+{
+    size_t i;
+    for (i = 0; i < count; ++i)
+    {
+        uint32_t value = (seconds + units[i].seconds - 1) / units[i].seconds;
+        if (value <= 31)
+        {
+            return (uint8_t)((units[i].code << 5) | value);
+        }
+    }
+    return (uint8_t)((units[count - 1].code << 5) | 31);
+}
+
+/**
+ * Decode a timer reported as a string of eight '0' and '1' characters.
+ * @return the timer in seconds, or zero if it is deactivated or invalid
+ */
+static uint32_t decodeTimer(const TimerUnit* units, size_t count, const char* str, uint16_t len)
+{
+    uint8_t timer = 0;
+    uint16_t i;
+    if (len != 8)
+    {
+        return 0;
+    }
+    for (i = 0; i < len; ++i)
+    {
+        if ((str[i] != '0') && (str[i] != '1'))
+        {
+            return 0;
+        }
+        timer = (uint8_t)((timer << 1) | (str[i] - '0'));
+    }
+    uint8_t code = timer >> 5;
+    for (i = 0; i < count; ++i)
+    {
+        if ((code != TIMER_DEACTIVATED) && (units[i].code == code))
+        {
+            return (timer & 0x1F) * units[i].seconds;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Split the parameters of a report into fields, removing any quotes.
+ * @return the number of fields
+ */
+static uint8_t splitFields(const char* p, const char* end, const char** start, uint16_t* len, bool* quoted)
+{
+    uint8_t fields = 0;
+    while ((p <= end) && (fields < MAX_FIELDS))
+    {
+        const char* comma = p;
+        bool inQuote = false;
+        while ((comma < end) && (inQuote || (*comma != ',')))
+        {
+            if (*comma == '"')
+            {
+                inQuote = !inQuote;
+            }
+            ++comma;
+        }
+        quoted[fields] = (comma - p >= 2) && (*p == '"') && (comma[-1] == '"');
+        start[fields] = quoted[fields] ? p + 1 : p;
+        len[fields] = (uint16_t)(quoted[fields] ? comma - p - 2 : comma - p);
+        ++fields;
+        p = comma + 1;
+    }
+    return fields;
+}
+
+void Thingstream_ModemPsm_processLine(const char* response, uint16_t len)
+{
+    const char* end = response + len;
+    const char* start[MAX_FIELDS];
+    uint16_t fieldLen[MAX_FIELDS];
+    bool quoted[MAX_FIELDS];
+    uint8_t fields;
+
+    if ((len > strlen(CEREG_REPORT))
+        && (memcmp(response, CEREG_REPORT, strlen(CEREG_REPORT)) == 0))
+    {
+        fields = splitFields(response + strlen(CEREG_REPORT), end,
+                             start, fieldLen, quoted);
+
+        /* A solicited report starts with <n>, the unsolicited report has
+         * the quoted <tac> after <stat>
+         */
+        uint8_t first = ((fields >= 2) && !quoted[1] && (fieldLen[1] > 0)) ? 1 : 0;
+        uint32_t stat = Thingstream_Util_parseUInt(start[first + CEREG_STAT],
+                                                   start[first + CEREG_STAT] + fieldLen[first + CEREG_STAT],
+                                                   NULL);
+        registered = (stat == 1) || (stat == 5);
+        reportSeen = true;
+        if (registered)
+        {
+            uint8_t active = first + CEREG_ACTIVE_TIME;
+            uint8_t tau = first + CEREG_PERIODIC_TAU;
+            granted.activeTimeSec = (active < fields)
+                ? decodeTimer(activeUnits, sizeof(activeUnits) / sizeof(activeUnits[0]),
+                              start[active], fieldLen[active])
+                : 0;
+            granted.periodicTauSec = (tau < fields)
+                ? decodeTimer(tauUnits, sizeof(tauUnits) / sizeof(tauUnits[0]),
+                              start[tau], fieldLen[tau])
+                : 0;
+        }
+    }
+    else if ((len > strlen(CEDRXP_REPORT))
+             && (memcmp(response, CEDRXP_REPORT, strlen(CEDRXP_REPORT)) == 0))
+    {
+        fields = splitFields(response + strlen(CEDRXP_REPORT), end,
+                             start, fieldLen, quoted);
+        granted.edrxCycleMs = 0;
+        if ((fields > CEDRXP_NW_VALUE) && (fieldLen[CEDRXP_NW_VALUE] == 4))
+        {
+            uint32_t act = Thingstream_Util_parseUInt(start[CEDRXP_ACT],
+                                                      start[CEDRXP_ACT] + fieldLen[CEDRXP_ACT],
+                                                      NULL);
+            const uint32_t* cycles = (act == MODEM_EDRX_NB_IOT) ? nbEdrxCycles : wbEdrxCycles;
+            const char* value = start[CEDRXP_NW_VALUE];
+            uint8_t index = 0;
+            uint8_t i;
+            for (i = 0; i < 4; ++i)
+            {
+                index = (uint8_t)((index << 1) | (value[i] == '1'));
+            }
+            granted.edrxCycleMs = cycles[index];
+        }
+    }
+}
+
+const ThingstreamModemPsmGranted* Thingstream_ModemPsm_getGranted(void)
+{
+    return &granted;
+}
+
+ThingstreamTransportResult Thingstream_ModemPsm_request(ThingstreamTransport* modem, uint32_t periodicTauSec, uint32_t activeTimeSec, uint32_t millis)
+{
+    static const char prefix[] = "AT+CPSMS=1,,,\"";
+    char command[sizeof(prefix) + 8 + 3 + 8 + 1];
+    char* p = command;
+
+    memcpy(p, prefix, strlen(prefix));
+    p += strlen(prefix);
+    p = writeBits(p, encodeTimer(tauUnits, sizeof(tauUnits) / sizeof(tauUnits[0]),
+                                 periodicTauSec), 8);
+    memcpy(p, "\",\"", 3);
+    p += 3;
+    p = writeBits(p, encodeTimer(activeUnits, sizeof(activeUnits) / sizeof(activeUnits[0]),
+                                 activeTimeSec), 8);
+    *p++ = '"';
+    *p = '\0';
+
+    ThingstreamTransportResult tRes;
+    tRes = Thingstream_Modem_sendLine(modem, "AT+CEREG=4", millis);
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        tRes = Thingstream_Modem_sendLine(modem, command, millis);
+    }
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        /* Report the timers granted by the network */
+        tRes = Thingstream_Modem_sendLine(modem, "AT+CEREG?", millis);
+    }
+    return tRes;
+}
+
+ThingstreamTransportResult Thingstream_ModemPsm_requestEdrx(ThingstreamTransport* modem, ThingstreamModemEdrxAct act, uint32_t cycleMs, uint32_t millis)
+{
+    char command[] = "AT+CEDRXS=2,#,\"####\"";
+    const uint32_t* cycles;
+    uint8_t index;
+    uint8_t i;
+
+    if (act == MODEM_EDRX_LTE_M)
+    {
+        cycles = wbEdrxCycles;
+        index = 0;
+    }
+    else if (act == MODEM_EDRX_NB_IOT)
+    {
+        cycles = nbEdrxCycles;
+        index = NB_EDRX_MIN_VALUE;
+    }
+    else
+    {
+        return TRANSPORT_ILLEGAL_ARGUMENT;
+    }
+
+    /* The longest defined cycle that is no longer than requested; the
+     * undefined NB-S1 values never exceed the shortest defined one */
+    for (i = 0; i < 16; ++i)
+    {
+        if ((cycles[i] <= cycleMs) && (cycles[i] > cycles[index]))
+        {
+            index = i;
+        }
+    }
+    command[12] = (char)('0' + act);
+    (void)writeBits(&command[15], index, 4);
+    return Thingstream_Modem_sendLine(modem, command, millis);
+}
+
+ThingstreamTransportResult Thingstream_ModemPsm_disable(ThingstreamTransport* modem, uint32_t millis)
+{
+    ThingstreamTransportResult tRes;
+    tRes = Thingstream_Modem_sendLine(modem, "AT+CPSMS=0", millis);
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        tRes = Thingstream_Modem_sendLine(modem, "AT+CEDRXS=0", millis);
+    }
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        memset(&granted, 0, sizeof(granted));
+    }
+    return tRes;
+}
+
+ThingstreamTransportResult Thingstream_ModemPsm_resume(ThingstreamTransport* modem, uint32_t millis)
+{
+    uint32_t limit = Thingstream_Platform_getTimeMillis() + millis;
+    ThingstreamTransportResult tRes = TRANSPORT_SEND_TIMEOUT;
+
+    /* The first command may be lost while the modem wakes */
+    while (TIME_COMPARE(Thingstream_Platform_getTimeMillis(), <, limit))
+    {
+        tRes = Thingstream_Modem_sendLine(modem, "AT", RESUME_POLL_MS);
+        if (tRes == TRANSPORT_SUCCESS)
+        {
+            break;
+        }
+    }
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return tRes;
+    }
+
+    uint32_t now = Thingstream_Platform_getTimeMillis();
+    if (TIME_COMPARE(now, >=, limit))
+    {
+        return TRANSPORT_SEND_TIMEOUT;
+    }
+    reportSeen = false;
+    tRes = Thingstream_Modem_sendLine(modem, "AT+CEREG?", limit - now);
+    if ((tRes == TRANSPORT_SUCCESS) && !(reportSeen && registered))
+    {
+        tRes = TRANSPORT_MODEM_ERROR;
+    }
+    return tRes;
+}
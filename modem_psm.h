@@ -0,0 +1,154 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief 3GPP Power Saving Mode (PSM) and eDRX configuration for LTE-M and
+ * NB-IoT modems driven by the modem transport
+ *
+ * These routines use the standard 27.007 commands (AT+CPSMS, AT+CEDRXS and
+ * AT+CEREG=4) supported by the SARA-R4/R5, BG95/BG96 and SIM7080 modems.
+ * They send their commands with Thingstream_Modem_sendLine(), so they must
+ * be called from the application's main loop after the client has been
+ * initialised, and the modem's responses reach them through the
+ * application's Thingstream_Application_modemCallback(), which must pass
+ * each line to Thingstream_ModemPsm_processLine().
+ */
+
+#ifndef INC_MODEM_PSM_H
+#define INC_MODEM_PSM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "transport_api.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * The radio access technology of an eDRX request.
+ */
+typedef enum ThingstreamModemEdrxAct_e
+{
+    /** LTE-M (E-UTRAN WB-S1 mode) */
+    MODEM_EDRX_LTE_M = 4,
+    /** NB-IoT (E-UTRAN NB-S1 mode) */
+    MODEM_EDRX_NB_IOT = 5
+} ThingstreamModemEdrxAct;
+
+/**
+ * The PSM and eDRX values granted by the network. A value of zero means
+ * that the feature has not been granted (or not reported yet).
+ */
+typedef struct ThingstreamModemPsmGranted_s
+{
+    /** The periodic TAU timer (T3412 extended) in seconds */
+    uint32_t periodicTauSec;
+    /** The active time (T3324) in seconds */
+    uint32_t activeTimeSec;
+    /** The eDRX cycle in milliseconds */
+    uint32_t edrxCycleMs;
+} ThingstreamModemPsmGranted;
+
+/**
+ * Request Power Saving Mode with the given timers, and enable the +CEREG
+ * reports that carry the values granted by the network.
+ *
+ * Each timer is rounded up to the next value that the 3GPP encoding can
+ * represent. The network may grant different values, see
+ * Thingstream_ModemPsm_getGranted().
+ *
+ * @param modem the modem transport instance
+ * @param periodicTauSec the requested periodic TAU (T3412) in seconds
+ * @param activeTimeSec the requested active time (T3324) in seconds
+ * @param millis the maximum number of milliseconds to wait for each command
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+extern ThingstreamTransportResult Thingstream_ModemPsm_request(ThingstreamTransport* modem, uint32_t periodicTauSec, uint32_t activeTimeSec, uint32_t millis);
+
+/**
+ * Request an eDRX cycle. The cycle is rounded down to the nearest value
+ * that 3GPP defines for the access technology: 5.12 seconds to 10485.76
+ * seconds for LTE-M, and a subset from 20.48 seconds for NB-IoT. A cycle
+ * shorter than the shortest value is rounded up to it. The modem reports
+ * the cycle granted by the network with +CEDRXP.
+ *
+ * @param modem the modem transport instance
+ * @param act the radio access technology to configure
+ * @param cycleMs the requested eDRX cycle in milliseconds
+ * @param millis the maximum number of milliseconds to wait for the modem
+ * @return a #ThingstreamTransportResult status code (success / fail);
+ *    #TRANSPORT_ILLEGAL_ARGUMENT if act is not one of the values above
+ */
+extern ThingstreamTransportResult Thingstream_ModemPsm_requestEdrx(ThingstreamTransport* modem, ThingstreamModemEdrxAct act, uint32_t cycleMs, uint32_t millis);
+
+/**
+ * Disable Power Saving Mode and eDRX.
+ *
+ * @param modem the modem transport instance
+ * @param millis the maximum number of milliseconds to wait for each command
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+extern ThingstreamTransportResult Thingstream_ModemPsm_disable(ThingstreamTransport* modem, uint32_t millis);
+
+/**
+ * Bring the modem back to the command state after it has woken from PSM,
+ * without initialising it again.
+ *
+ * A modem in PSM keeps its registration and PDP context, but does not
+ * answer AT commands until it wakes. This sends AT until the modem
+ * answers, then checks that it is still registered, so that the modem
+ * transport can carry on with its UDP socket. If the modem has lost its
+ * registration the caller should let the modem transport initialise it
+ * again (e.g. by calling Thingstream_Client_init()).
+ *
+ * The modem must already have been woken by the platform if it needs a
+ * pin to be driven to do so (for example PWR_ON on SARA-R4 or PSM_EINT on
+ * BG95).
+ *
+ * @param modem the modem transport instance
+ * @param millis the maximum number of milliseconds to wait for the modem
+ * @return a #ThingstreamTransportResult status code (success / fail);
+ *    #TRANSPORT_MODEM_ERROR if the modem is not registered
+ */
+extern ThingstreamTransportResult Thingstream_ModemPsm_resume(ThingstreamTransport* modem, uint32_t millis);
+
+/**
+ * Track the values granted by the network. Call this from
+ * Thingstream_Application_modemCallback() with every line, it ignores the
+ * lines that are not +CEREG or +CEDRXP reports.
+ *
+ * @param response the modem response
+ * @param len the length of the response
+ */
+extern void Thingstream_ModemPsm_processLine(const char* response, uint16_t len);
+
+/**
+ * Return the PSM and eDRX values last granted by the network.
+ *
+ * @return the granted values
+ */
+extern const ThingstreamModemPsmGranted* Thingstream_ModemPsm_getGranted(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_MODEM_PSM_H */
@@ -0,0 +1,375 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Self test of the modem socket transport against a scripted modem
+ *
+ * This example does not use the modem. It plays the part of the u-blox
+ * modem transport, issuing the binary AT+USOST and AT+USORF commands that
+ * the u-blox configurations send, through a modem socket transport whose
+ * inner transport is a scripted modem. It checks that a write payload with
+ * no line end is passed through as is, that a read made when no data has
+ * been announced is answered locally, that reads reach the modem from an
+ * announcement until one reports no data, and that transparent mode is entered
+ * from a real socket write and carries datagrams both ways.
+ */
+
+#include <string.h>
+
+#include "run_example.h"
+#include "modem_socket_transport.h"
+
+/** The socket write the u-blox configurations send for a 4 byte payload */
+#define TEST_WRITE      "AT+USOST=0,\"10.20.30.40\",1883,4\r\n"
+
+/** The socket read the u-blox configurations send */
+#define TEST_READ       "AT+USORF=0,1024\r\n"
+
+/** A payload that looks like the start of another socket command */
+static uint8_t testPayload[4] = { 'A', 'T', '+', 'U' };
+
+/** A datagram from the server, with its MQTT-SN length header */
+static uint8_t testDatagram[2] = { 0x02, 0x17 };
+
+/** The state of the scripted modem */
+static struct
+{
+    ThingstreamTransportCallback_t callback;
+    void* cookie;
+    /** Everything sent to the modem */
+    uint8_t sent[256];
+    uint16_t sentLen;
+    /** The start of the command line being sent */
+    uint16_t lineStart;
+    /** The output the modem has yet to deliver */
+    const uint8_t* reply;
+    uint16_t replyLen;
+    /** The number of datagrams held for reading */
+    uint16_t held;
+    /** The number of write payload bytes still to come */
+    uint16_t payload;
+    /** Ignore a '\\n' that follows the command's '\\r' */
+    bool skipLf;
+    /** The modem is in transparent mode */
+    bool link;
+} modem;
+
+/** The output of the modem socket transport, as the modem transport sees it */
+static uint8_t received[256];
+static uint16_t receivedLen;
+
+static uint8_t socketBuf[256];
+static uint8_t linkBuf[64];
+
+/**
+ * Queue a reply from the scripted modem.
+ */
+static void modemReply(const char* reply)
+{
+    modem.reply = (const uint8_t*)reply;
+    modem.replyLen = (uint16_t)strlen(reply);
+}
+
+/**
+ * Answer a complete command line sent to the scripted modem.
+ */
+static void modemCommand(const char* line, uint16_t len)
+{
+    if ((len > 9) && (memcmp(line, "AT+USOST=", 9) == 0))
+    {
+        /* the payload length is the last field */
+        const char* comma = line + len;
+        while (comma[-1] != ',')
+        {
+            --comma;
+        }
+        modem.payload = (uint16_t)Thingstream_Util_parseUInt(comma, line + len, NULL);
+        modemReply("\r\n@");
+    }
+    else if ((len > 9) && (memcmp(line, "AT+USORF=", 9) == 0))
+    {
+        if (modem.held > 0)
+        {
+            modem.held--;
+            modemReply("\r\n+USORF: 0,\"10.20.30.40\",1883,2,\"\x02\x17\"\r\n\r\nOK\r\n");
+        }
+        else
+        {
+            modemReply("\r\n+USORF: 0,\"10.20.30.40\",1883,0,\"\"\r\n\r\nOK\r\n");
+        }
+    }
+    else if ((len > 9) && (memcmp(line, "AT+USODL=", 9) == 0))
+    {
+        modem.link = true;
+        modemReply("\r\nCONNECT\r\n");
+    }
+    else
+    {
+        modemReply("\r\nOK\r\n");
+    }
+}
+
+static ThingstreamTransportResult modem_init(ThingstreamTransport* self, uint16_t version)
+{
+    UNUSED(self);
+    UNUSED(version);
+    return TRANSPORT_SUCCESS;
+}
+
+static ThingstreamTransportResult modem_shutdown(ThingstreamTransport* self)
+{
+    UNUSED(self);
+    return TRANSPORT_SUCCESS;
+}
+
+static ThingstreamTransportResult modem_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis)
+{
+    uint16_t i;
+    UNUSED(self);
+    UNUSED(flags);
+    UNUSED(millis);
+
+    for (i = 0; i < len; ++i)
+    {
+        uint8_t ch = data[i];
+        bool skipLf = modem.skipLf;
+        modem.skipLf = false;
+        if (modem.sentLen == sizeof(modem.sent))
+        {
+            return TRANSPORT_ERROR;
+        }
+        modem.sent[modem.sentLen++] = ch;
+        if (skipLf && (ch == '\n'))
+        {
+            modem.lineStart = modem.sentLen;
+        }
+        else if (modem.link)
+        {
+            /* transparent mode, the data goes to the server */
+            modem.lineStart = modem.sentLen;
+        }
+        else if (modem.payload > 0)
+        {
+            if (--modem.payload == 0)
+            {
+                modemReply("\r\n+USOST: 0,4\r\n\r\nOK\r\n");
+            }
+            modem.lineStart = modem.sentLen;
+        }
+        else if ((ch == '\r') || (ch == '\n'))
+        {
+            uint16_t start = modem.lineStart;
+            modem.lineStart = modem.sentLen;
+            modem.skipLf = (ch == '\r');
+            if (modem.sentLen - 1 > start)
+            {
+                modemCommand((const char*)&modem.sent[start], modem.sentLen - 1 - start);
+            }
+        }
+    }
+    return TRANSPORT_SUCCESS;
+}
+
+static ThingstreamTransportResult modem_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie)
+{
+    UNUSED(self);
+    modem.callback = callback;
+    modem.cookie = cookie;
+    return TRANSPORT_SUCCESS;
+}
+
+static ThingstreamTransportResult modem_run(ThingstreamTransport* self, uint32_t millis)
+{
+    UNUSED(self);
+    UNUSED(millis);
+    if ((modem.replyLen > 0) && (modem.callback != NULL))
+    {
+        uint16_t len = modem.replyLen;
+        modem.replyLen = 0;
+        modem.callback(modem.cookie, (uint8_t*)modem.reply, len);
+    }
+    return TRANSPORT_SUCCESS;
+}
+
+static ThingstreamTransport scriptedModem = {
+    NULL,
+    modem_init,
+    modem_shutdown,
+    NULL,
+    NULL,
+    modem_send,
+    modem_register_callback,
+    NULL,
+    modem_run
+};
+
+/**
+ * Collect the output of the modem socket transport.
+ */
+static void collect(void* cookie, uint8_t* data, uint16_t len)
+{
+    UNUSED(cookie);
+    if (len > sizeof(received) - receivedLen)
+    {
+        len = sizeof(received) - receivedLen;
+    }
+    memcpy(received + receivedLen, data, len);
+    receivedLen += len;
+}
+
+/**
+ * Return true if the data contains the given string.
+ */
+static bool contains(const uint8_t* data, uint16_t len, const char* str)
+{
+    uint16_t count = (uint16_t)strlen(str);
+    uint16_t i;
+    for (i = 0; i + count <= len; ++i)
+    {
+        if (memcmp(data + i, str, count) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Send bytes as the modem transport would, then run the transports until
+ * all output has been delivered.
+ */
+static ThingstreamTransportResult exchange(ThingstreamTransport* transport, const void* data, uint16_t len)
+{
+    ThingstreamTransportResult tRes = TRANSPORT_SUCCESS;
+    int i;
+
+    receivedLen = 0;
+    if (len > 0)
+    {
+        tRes = transport->send(transport, 0, (uint8_t*)data, len, 1000);
+    }
+    for (i = 0; i < 4; ++i)
+    {
+        (void)transport->run(transport, 0);
+    }
+    return tRes;
+}
+
+/**
+ * Run the modem socket transport self test. The transport is not used.
+ */
+ThingstreamClientResult run_example(ThingstreamTransport *transport,
+                        ThingstreamModemUdpInit *modem_init,
+                        uint16_t modem_flags)
+{
+    ThingstreamClientResult result = CLIENT_ILLEGAL_ARGUMENT;
+    ThingstreamTransport* socket;
+    uint16_t mark;
+
+    UNUSED(transport);
+    UNUSED(modem_init);
+    UNUSED(modem_flags);
+
+    socket = Thingstream_createModemSocketTransport(&scriptedModem,
+                 Thingstream_uBloxSaraR4Init, socketBuf, sizeof(socketBuf));
+    CHECK("create", socket != NULL);
+    (void)socket->register_callback(socket, collect, NULL);
+    CHECK("init", socket->init(socket, TRANSPORT_VERSION_1) == TRANSPORT_SUCCESS);
+
+    /* The first read always reaches the modem */
+    CHECK("first read", exchange(socket, TEST_READ, strlen(TEST_READ)) == TRANSPORT_SUCCESS);
+    CHECK("first read sent",
+          contains(modem.sent, modem.sentLen, TEST_READ));
+    CHECK("first read answered",
+          contains(received, receivedLen, "+USORF: 0,\"10.20.30.40\""));
+
+    /* A binary write, prompted by the modem */
+    CHECK("write", exchange(socket, TEST_WRITE, strlen(TEST_WRITE)) == TRANSPORT_SUCCESS);
+    CHECK("write sent",
+          contains(modem.sent, modem.sentLen, TEST_WRITE));
+    CHECK("write prompt", contains(received, receivedLen, "@"));
+
+    /* The payload, with no line end, is passed through as is */
+    mark = modem.sentLen;
+    CHECK("payload", exchange(socket, testPayload, sizeof(testPayload)) == TRANSPORT_SUCCESS);
+    CHECK("payload sent", (modem.sentLen == mark + sizeof(testPayload))
+                          && (memcmp(modem.sent + mark, testPayload, sizeof(testPayload)) == 0));
+    CHECK("write response", contains(received, receivedLen, "+USOST: 0,4"));
+
+    /* No data has been announced, so the next read is answered here */
+    mark = modem.sentLen;
+    CHECK("idle read", exchange(socket, TEST_READ, strlen(TEST_READ)) == TRANSPORT_SUCCESS);
+    CHECK("idle read held", modem.sentLen == mark);
+    CHECK("idle read answered", contains(received, receivedLen, "+USORF: 0,0"));
+
+    /* Two datagrams are announced once; reads reach the modem until empty */
+    modem.held = 2;
+    modemReply("\r\n+UUSORF: 0,2\r\n");
+    CHECK("announce", exchange(socket, NULL, 0) == TRANSPORT_SUCCESS);
+    mark = modem.sentLen;
+    CHECK("announced read", exchange(socket, TEST_READ, strlen(TEST_READ)) == TRANSPORT_SUCCESS);
+    CHECK("announced read sent", (modem.sentLen > mark)
+          && contains(received, receivedLen, "1883,2,\"\x02\x17\""));
+    mark = modem.sentLen;
+    CHECK("second read", exchange(socket, TEST_READ, strlen(TEST_READ)) == TRANSPORT_SUCCESS);
+    CHECK("second read sent", (modem.sentLen > mark) && (modem.held == 0)
+          && contains(received, receivedLen, "1883,2,\"\x02\x17\""));
+    mark = modem.sentLen;
+    CHECK("empty read", exchange(socket, TEST_READ, strlen(TEST_READ)) == TRANSPORT_SUCCESS);
+    CHECK("empty read sent", (modem.sentLen > mark)
+          && contains(received, receivedLen, "1883,0,\"\""));
+    mark = modem.sentLen;
+    CHECK("drained read", exchange(socket, TEST_READ, strlen(TEST_READ)) == TRANSPORT_SUCCESS);
+    CHECK("drained read held", modem.sentLen == mark);
+
+    /* The next write enters transparent mode */
+    CHECK("transparent",
+          Thingstream_ModemSocket_setTransparent(socket, linkBuf, sizeof(linkBuf), 1000)
+          == TRANSPORT_SUCCESS);
+    mark = modem.sentLen;
+    CHECK("link write", exchange(socket, TEST_WRITE, strlen(TEST_WRITE)) == TRANSPORT_SUCCESS);
+    CHECK("link connect",
+          contains(modem.sent + mark, modem.sentLen - mark, "AT+USOCO=0,\"10.20.30.40\",1883"));
+    CHECK("link enter", modem.link
+          && contains(modem.sent + mark, modem.sentLen - mark, "AT+USODL=0"));
+    CHECK("link write not sent",
+          !contains(modem.sent + mark, modem.sentLen - mark, "AT+USOST"));
+    CHECK("link prompt", contains(received, receivedLen, "@"));
+
+    mark = modem.sentLen;
+    CHECK("link payload", exchange(socket, testPayload, sizeof(testPayload)) == TRANSPORT_SUCCESS);
+    CHECK("link payload sent", (modem.sentLen == mark + sizeof(testPayload))
+                               && (memcmp(modem.sent + mark, testPayload, sizeof(testPayload)) == 0));
+    CHECK("link write response", contains(received, receivedLen, "+USOST: 0,4\r\n\r\nOK"));
+
+    /* A datagram from the server is announced and read locally */
+    modem.reply = testDatagram;
+    modem.replyLen = sizeof(testDatagram);
+    CHECK("link receive", exchange(socket, NULL, 0) == TRANSPORT_SUCCESS);
+    CHECK("link announce", contains(received, receivedLen, "+UUSORF: 0,2"));
+    mark = modem.sentLen;
+    CHECK("link read", exchange(socket, TEST_READ, strlen(TEST_READ)) == TRANSPORT_SUCCESS);
+    CHECK("link read held", modem.sentLen == mark);
+    CHECK("link read answered",
+          contains(received, receivedLen, "+USORF: 0,\"10.20.30.40\",1883,2,\"\x02\x17\""));
+
+    Thingstream_Util_printf("modem socket self test passed\n");
+    result = CLIENT_SUCCESS;
+
+error:
+    return result;
+}
@@ -0,0 +1,2460 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief ThingstreamTransport implementation that sits between the modem
+ * transport and the modem hardware, holding back socket reads until the
+ * modem announces data, and providing application sockets and transparent
+ * mode.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "modem_socket_transport.h"
+#include "ublox_modem_config.h"
+#include "quectel_modem_config.h"
+#include "simcom_modem_config.h"
+#include "client_platform.h"
+#include "thingstream_util.h"
+
+/**
+ * The longest read response header (e.g. +USORF: s,"ip",port,len,")
+ * that will be held while looking for the payload length.
+ */
+#define RX_HOLD_LEN     64
+
+/** The maximum number of fields parsed from a socket write command */
+#define MAX_FIELDS      8
+
+/** The space for the peer's IP address in transparent mode */
+#define LINK_ADDRESS_LEN 48
+
+/**
+ * The fields of the binary socket write command holding the socket id, the
+ * peer address, the peer port and the payload length, in the dialects that
+ * support transparent mode.
+ */
+#define LINK_SOCKET_FIELD   0
+#define LINK_ADDRESS_FIELD  1
+#define LINK_PORT_FIELD     2
+#define LINK_LENGTH_FIELD   3
+
+/** The modem's report that transparent mode has ended */
+#define LINK_DISCONNECT     "\r\nDISCONNECT"
+
+/** Test for the characters that end an AT command or response line */
+#define IS_LINE_END(ch) (((ch) == '\r') || ((ch) == '\n'))
+
+/**
+ * The AT command dialect used by a family of modems for socket transfers.
+ */
+typedef struct ModemSocketDialect_s
+{
+    /** The prefix of the binary socket write command, whose last field is
+     * the length of the payload that follows the prompt */
+    const char* binarySend;
+    /** The prefix of the binary write command for a connected socket, or
+     * NULL */
+    const char* connectedSend;
+    /** The prompt that the modem sends when it is ready for binary data */
+    char prompt;
+    /** The time to wait after the prompt before sending binary data */
+    uint16_t promptDelayMs;
+    /** The prefix of a socket read response that carries payload */
+    const char* readResponse;
+    /** The index of the length field in that read response */
+    uint8_t readLengthField;
+    /** The command that creates an application socket, or NULL if the
+     * application sockets are not supported */
+    const char* socketCreate;
+    /** The information response to socketCreate giving the socket id */
+    const char* socketCreated;
+    /** The prefix of the command that closes a socket */
+    const char* socketClose;
+    /** The prefix of the command that reads from a socket */
+    const char* socketRead;
+    /** The URC announcing the amount of data waiting on a socket */
+    const char* dataUrc;
+    /** The URC announcing that the modem has closed a socket */
+    const char* closeUrc;
+    /** The information response to a socket write */
+    const char* writeResponse;
+    /** The prefix of the command that connects a UDP socket to its peer */
+    const char* socketConnect;
+    /** The prefix of the command that enters transparent mode, or NULL if
+     * transparent mode is not supported */
+    const char* linkEnter;
+    /** The prefix of the socket read command issued by the modem transport,
+     * or NULL if reads are not held back until data is announced */
+    const char* pollRead;
+    /** The answer to pollRead when no data is waiting ('#' is replaced by
+     * the socket id) */
+    const char* readNone;
+    /** The answer to pollRead with a length of zero, or NULL if readNone */
+    const char* queryNone;
+    /** The prefix of the modem's response to pollRead */
+    const char* pollResponse;
+    /** The index of the length field in that response */
+    uint8_t pollLengthField;
+    /** The URC announcing data on the modem transport's socket */
+    const char* recvUrc;
+    /** The recvUrc gives the number of bytes waiting after the socket id */
+    bool recvUrcLength;
+} ModemSocketDialect;
+
+/** u-blox: AT+USOST binary extended syntax, AT+USORF read response */
+static const ModemSocketDialect ubloxDialect = {
+    "AT+USOST=",
+    "AT+USOWR=",
+    '@',
+    50,
+    "+USORF:",
+    3,
+    "AT+USOCR=17",
+    "+USOCR:",
+    "AT+USOCL=",
+    "AT+USORF=",
+    "+UUSORF:",
+    "+UUSOCL:",
+    "+USOST:",
+    "AT+USOCO=",
+    "AT+USODL=",
+    "AT+USORF=",
+    "+USORF: #,0",
+    NULL,
+    "+USORF:",
+    3,
+    "+UUSORF:",
+    true
+};
+
+/** Quectel: AT+QISEND/AT+QIRD are binary, only reads are held back */
+static const ModemSocketDialect quectelDialect = {
+    "AT+QISEND=",
+    NULL,
+    '>',
+    0,
+    NULL,
+    0,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    "AT+QIRD=",
+    "+QIRD: 0",
+    "+QIRD: 0,0,0",
+    "+QIRD:",
+    0,
+    "+QIURC: \"recv\",",
+    false
+};
+
+/** SimCom: AT+CASEND/AT+CARECV are binary, only reads are held back */
+static const ModemSocketDialect simcomDialect = {
+    "AT+CASEND=",
+    NULL,
+    '>',
+    0,
+    NULL,
+    0,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    "AT+CARECV=",
+    "+CARECV: 0",
+    NULL,
+    "+CARECV:",
+    0,
+    "+CADATAIND:",
+    false
+};
+
+/**
+ * Map from the modem initialisation routine to the matching dialect.
+ * Modems that are not listed have their traffic passed through.
+ */
+static const struct
+{
+    ThingstreamModemUdpInit* init;
+    const ModemSocketDialect* dialect;
+} modemDialects[] = {
+    { Thingstream_uBloxLaraR2Init,   &ubloxDialect },
+    { Thingstream_uBloxLaraR6Init,   &ubloxDialect },
+    { Thingstream_uBloxLenaR8Init,   &ubloxDialect },
+    { Thingstream_uBloxLexiR4Init,   &ubloxDialect },
+    { Thingstream_uBloxLexiR5Init,   &ubloxDialect },
+    { Thingstream_uBloxLexiR10Init,  &ubloxDialect },
+    { Thingstream_uBloxSaraG350Init, &ubloxDialect },
+    { Thingstream_uBloxSaraG450Init, &ubloxDialect },
+    { Thingstream_uBloxSaraR4Init,   &ubloxDialect },
+    { Thingstream_uBloxSaraR5Init,   &ubloxDialect },
+    { Thingstream_uBloxSaraR10Init,  &ubloxDialect },
+    { Thingstream_uBloxSaraU2Init,   &ubloxDialect },
+    { Thingstream_uBloxTobyR2Init,   &ubloxDialect },
+    { Thingstream_uBloxTobyL2Init,   &ubloxDialect },
+    { Thingstream_QuectelBG77Init,   &quectelDialect },
+    { Thingstream_QuectelBG95Init,   &quectelDialect },
+    { Thingstream_QuectelBG96Init,   &quectelDialect },
+    { Thingstream_QuectelEC25Init,   &quectelDialect },
+    { Thingstream_QuectelEG800Init,  &quectelDialect },
+    { Thingstream_QuectelUG95Init,   &quectelDialect },
+    { Thingstream_QuectelUG96Init,   &quectelDialect },
+    { Thingstream_Simcom7070Init,    &simcomDialect },
+    { Thingstream_Simcom7080Init,    &simcomDialect },
+};
+
+/** The states of the outbound (modem transport to modem) line parser */
+typedef enum
+{
+    TX_LINE_START,      /**< at the start of a command line */
+    TX_MATCHING,        /**< holding bytes that may start a socket command */
+    TX_HOLDING,         /**< holding a socket command until the line ends */
+    TX_PASSING,         /**< passing the rest of the line through */
+    TX_WRITE,           /**< waiting for the prompt after a binary write */
+    TX_PAYLOAD          /**< passing the payload of a binary write through */
+} TxState;
+
+/** The states of the inbound (modem to modem transport) line parser */
+typedef enum
+{
+    RX_LINE_START,      /**< at the start of a response line */
+    RX_MATCHING,        /**< holding bytes that may start a read response */
+    RX_HEADER,          /**< holding a read response up to its payload */
+    RX_PAYLOAD,         /**< collecting the payload of an own read */
+    RX_LINE,            /**< holding a URC or own response until it ends */
+    RX_SKIP,            /**< dropping the rest of the line */
+    RX_PASSING          /**< passing the rest of the line through */
+} RxState;
+
+/** The kinds of line held by the inbound line parser */
+typedef enum
+{
+    LINE_READ,          /**< a socket read response */
+    LINE_DATA_URC,      /**< data waiting on a socket */
+    LINE_CLOSE_URC,     /**< a socket closed by the modem */
+    LINE_RECV_URC,      /**< data waiting on the modem transport's socket */
+    LINE_OWN            /**< a response to this transport's own command */
+} RxLineKind;
+
+/** An application socket */
+typedef struct ModemSocket_s
+{
+    /** The socket is open */
+    bool open;
+    /** The modem closed the socket, the application is yet to be told */
+    bool closed;
+    /** The modem's id for the socket */
+    uint8_t id;
+    /** The remote port */
+    uint16_t port;
+    /** The remote IP address */
+    const char* address;
+    /** The queue of datagrams to send, each preceded by a 16-bit length */
+    uint8_t* queue;
+    /** The size of queue */
+    uint16_t queueSize;
+    /** The number of bytes in queue */
+    uint16_t queueLen;
+    /** The number of bytes the modem has announced for reading */
+    uint16_t available;
+    /** The callback for received datagrams */
+    ThingstreamModemSocketCallback callback;
+    /** Cookie associated with the callback */
+    void* cookie;
+} ModemSocket;
+
+/**
+ * The ModemSocketState structure is used to store state for the modem
+ * socket transport.
+ */
+typedef struct ModemSocketState_s
+{
+    /** The inner transport (serial, ring buffer or logger) */
+    ThingstreamTransport* inner;
+    /** The callback registered by the modem transport */
+    ThingstreamTransportCallback_t callback;
+    /** Cookie associated with the registered callback */
+    void* cookie;
+    /** The dialect of the modem, or NULL to pass all traffic through */
+    const ModemSocketDialect* dialect;
+
+    /** The buffer that holds a socket command line until it ends, or the
+     * payload of a read made for an application socket */
+    uint8_t* txBuffer;
+    /** The size of txBuffer */
+    uint16_t txSize;
+    /** The number of bytes held in txBuffer */
+    uint16_t txLen;
+    /** The state of the outbound line parser */
+    TxState txState;
+    /** Drop a '\\n' that follows a command answered here and terminated
+     * by '\\r' */
+    bool txSwallowLf;
+    /** The length of the payload of the binary write in progress */
+    uint16_t writeLen;
+    /** The number of payload bytes of the binary write still to come */
+    uint16_t writeRemaining;
+    /** A binary write passed to the modem is waiting for its prompt */
+    volatile bool writeAwaitPrompt;
+    /** The prompt for the binary write has reached the modem transport */
+    volatile bool writePromptSeen;
+    /** The binary write is sent in transparent mode */
+    bool writeLink;
+
+    /** A write for an application socket is waiting for the modem's
+     * prompt */
+    bool rxAwaitPrompt;
+    /** The modem's prompt has been received */
+    bool rxPromptSeen;
+    /** Drop a ' ' that follows a '>' prompt */
+    bool rxSwallowSpace;
+    /** The state of the inbound line parser */
+    RxState rxState;
+    /** The read response header held while looking for the length */
+    uint8_t rxHold[RX_HOLD_LEN];
+    /** The number of bytes held in rxHold */
+    uint8_t rxHoldLen;
+    /** The index of the read response field being parsed */
+    uint8_t rxField;
+    /** The offset in rxHold of the start of the current field */
+    uint8_t rxFieldStart;
+    /** The read response field being parsed is quoted */
+    bool rxInQuote;
+    /** The payload length parsed from the read response */
+    uint16_t rxLength;
+    /** The kind of line held in rxHold */
+    RxLineKind rxLineKind;
+
+    /** The application sockets */
+    ModemSocket sockets[MODEM_SOCKET_MAX_SOCKETS];
+    /** The number of open application sockets */
+    uint8_t socketsOpen;
+    /** An AT command issued by this transport is in progress */
+    bool ownActive;
+    /** The own command has completed */
+    bool ownDone;
+    /** The own command is a socket read */
+    bool ownRead;
+    /** The result of the own command */
+    ThingstreamTransportResult ownResult;
+    /** The information response expected for the own command, or NULL */
+    const char* ownExpect;
+    /** The number parsed from the information response */
+    int32_t ownValue;
+    /** The number of bytes read into txBuffer by the own command */
+    uint16_t ownReadLen;
+
+    /** The buffer for datagrams received in transparent mode, or NULL if
+     * transparent mode is disabled */
+    uint8_t* linkBuffer;
+    /** The size of linkBuffer */
+    uint16_t linkSize;
+    /** The number of bytes held in linkBuffer */
+    uint16_t linkLen;
+    /** The modem is in transparent mode */
+    volatile bool linkActive;
+    /** Drop a '\\n' that follows the CONNECT response */
+    bool linkSkipLf;
+    /** The datagram at the start of linkBuffer has been announced */
+    bool linkAnnounced;
+    /** The socket id of the modem transport's socket */
+    uint8_t linkSocket;
+    /** The peer port of the modem transport's socket */
+    uint16_t linkPort;
+    /** The peer address of the modem transport's socket */
+    char linkAddress[LINK_ADDRESS_LEN];
+    /** The length of a datagram written in transparent mode that is yet to
+     * be acknowledged to the modem transport, or zero */
+    uint16_t linkWriteReply;
+    /** The maximum length of a read that is yet to be answered, or zero */
+    uint16_t linkReadReply;
+    /** The prompt for a write made in transparent mode is yet to be passed
+     * to the modem transport */
+    bool linkPrompt;
+
+    /** The modem has announced data, or the last read passed on returned
+     * data, so the modem may still hold more */
+    volatile bool readWaiting;
+    /** A read has been passed on and its response is being watched for */
+    volatile bool readPassed;
+    /** The number of bytes of pollResponse matched */
+    uint8_t pollMatched;
+    /** The index of the response field being parsed */
+    uint8_t pollField;
+    /** The response field being parsed is quoted */
+    bool pollInQuote;
+    /** The length field has started */
+    bool pollDigits;
+    /** The length parsed from the response */
+    uint16_t pollValue;
+    /** The number of bytes announced, or zero if not known */
+    volatile uint16_t readWaitingLen;
+    /** The time that the last read was passed on to the modem */
+    uint32_t readPassedTime;
+    /** The answer to a read made while no data was waiting, or NULL */
+    const char* readReply;
+    /** The socket id for readReply */
+    uint32_t readReplyId;
+} ModemSocketState;
+
+/** Instance of ModemSocketState */
+static ModemSocketState _modem_socket_transport_state;
+
+static ThingstreamTransportResult modem_socket_init(ThingstreamTransport* self, uint16_t version);
+static ThingstreamTransportResult modem_socket_shutdown(ThingstreamTransport* self);
+static ThingstreamTransportResult modem_socket_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len);
+static ThingstreamTransportResult modem_socket_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis);
+static ThingstreamTransportResult modem_socket_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie);
+static ThingstreamTransportResult modem_socket_run(ThingstreamTransport* self, uint32_t millis);
+
+/** Instance of ThingstreamTransport for the modem socket transport */
+static const ThingstreamTransport _modem_socket_transport_instance = {
+    (ThingstreamTransportState_t*)&_modem_socket_transport_state,
+    modem_socket_init,
+    modem_socket_shutdown,
+    modem_socket_get_buffer,
+    NULL, /* This slot no longer used */
+    modem_socket_send,
+    modem_socket_register_callback,
+    NULL, /* This slot no longer used */
+    modem_socket_run
+};
+
+
+ThingstreamTransport* Thingstream_createModemSocketTransport(ThingstreamTransport* inner, ThingstreamModemUdpInit udpConfigInit, uint8_t* buffer, uint16_t bufSize)
+{
+    ThingstreamTransport* self = (ThingstreamTransport*)&_modem_socket_transport_instance;
+    ModemSocketState* state = (ModemSocketState*)self->_state;
+
+    if ((inner == NULL) || (buffer == NULL) || (bufSize < RX_HOLD_LEN))
+    {
+        return NULL;
+    }
+
+    memset(state, 0, sizeof(*state));
+    state->inner = inner;
+    state->txBuffer = buffer;
+    state->txSize = bufSize;
+
+    size_t i;
+    for (i = 0; i < sizeof(modemDialects) / sizeof(modemDialects[0]); ++i)
+    {
+        if (modemDialects[i].init == udpConfigInit)
+        {
+            state->dialect = modemDialects[i].dialect;
+            break;
+        }
+    }
+
+    return self;
+}
+
+
+/**
+ * Return true if the held bytes could still become one of the socket
+ * commands that this transport handles.
+ */
+static bool isCommandPrefix(const uint8_t* held, uint16_t len, const char* command)
+{
+    return (command != NULL)
+        && (len <= strlen(command))
+        && (memcmp(held, command, len) == 0);
+}
+
+/**
+ * Return true if the held bytes are one of the socket commands that this
+ * transport handles.
+ */
+static bool isCommand(const uint8_t* held, uint16_t len, const char* command)
+{
+    return (command != NULL)
+        && (len == strlen(command))
+        && (memcmp(held, command, len) == 0);
+}
+
+/**
+ * Pass modem output to the modem transport.
+ *
+ * @param state the modem socket state
+ * @param data the modem output
+ * @param len the length of the modem output
+ */
+static void deliver(ModemSocketState* state, uint8_t* data, uint16_t len)
+{
+    ThingstreamTransportCallback_t callback = state->callback;
+    if ((len > 0) && (callback != NULL))
+    {
+        callback(state->cookie, data, len);
+    }
+}
+
+/**
+ * Pass a null-terminated string to the modem transport.
+ */
+static void deliverString(ModemSocketState* state, const char* str)
+{
+    deliver(state, (uint8_t*)str, (uint16_t)strlen(str));
+}
+
+/**
+ * Pass a number in decimal to the modem transport.
+ */
+static void deliverUInt(ModemSocketState* state, uint32_t num)
+{
+    char str[12];
+    *Thingstream_Util_sprintfUInt(str, num) = '\0';
+    deliverString(state, str);
+}
+
+/**
+ * Return the length of the datagram at the start of linkBuffer, or zero if
+ * it has not been completely received. The MQTT-SN length header is one
+ * byte, or 0x01 followed by a 16-bit length.
+ */
+static uint16_t linkDatagram(ModemSocketState* state)
+{
+    const uint8_t* buf = state->linkBuffer;
+    uint16_t len;
+
+    if (state->linkLen < 1)
+    {
+        return 0;
+    }
+    if (buf[0] == 0x01)
+    {
+        if (state->linkLen < 3)
+        {
+            return 0;
+        }
+        len = ((uint16_t)buf[1] << 8) | buf[2];
+    }
+    else
+    {
+        len = buf[0];
+    }
+    if ((len < 2) || (len > state->linkSize))
+    {
+        /* Not an MQTT-SN message, drop the data to find the next one */
+        state->linkLen = 0;
+        return 0;
+    }
+    return (state->linkLen >= len) ? len : 0;
+}
+
+/**
+ * Announce the datagram at the start of linkBuffer to the modem transport
+ * with a data URC, once it has been completely received.
+ *
+ * @param state the modem socket state
+ */
+static void linkAnnounce(ModemSocketState* state)
+{
+    const ModemSocketDialect* dialect = state->dialect;
+    uint16_t len;
+
+    if (state->linkAnnounced)
+    {
+        return;
+    }
+    /* A 13 byte MQTT-SN message of type 0x0A (REGACK, always 7 bytes)
+     * cannot exist, so this can only be the modem's report.
+     */
+    if ((state->linkLen >= sizeof(LINK_DISCONNECT) - 1)
+        && (memcmp(state->linkBuffer, LINK_DISCONNECT, sizeof(LINK_DISCONNECT) - 1) == 0))
+    {
+        state->linkActive = false;
+        state->linkLen = 0;
+        state->rxState = RX_LINE_START;
+        return;
+    }
+    len = linkDatagram(state);
+    if (len > 0)
+    {
+        state->linkAnnounced = true;
+        deliverString(state, "\r\n");
+        deliverString(state, dialect->dataUrc);
+        deliverString(state, " ");
+        deliverUInt(state, state->linkSocket);
+        deliverString(state, ",");
+        deliverUInt(state, len);
+        deliverString(state, "\r\n");
+    }
+}
+
+/**
+ * Add modem output received in transparent mode to linkBuffer.
+ *
+ * @param state the modem socket state
+ * @param data the modem output
+ * @param len the length of the modem output
+ */
+static void linkData(ModemSocketState* state, const uint8_t* data, uint16_t len)
+{
+    uint16_t room = state->linkSize - state->linkLen;
+    if (len > room)
+    {
+        /* Lose the excess, as the modem would if its own buffer was full */
+        len = room;
+    }
+    memcpy(state->linkBuffer + state->linkLen, data, len);
+    state->linkLen += len;
+    linkAnnounce(state);
+}
+
+/**
+ * Answer the socket write made in transparent mode.
+ *
+ * @param state the modem socket state
+ */
+static void linkWriteResponse(ModemSocketState* state)
+{
+    const ModemSocketDialect* dialect = state->dialect;
+    uint16_t len = state->linkWriteReply;
+
+    state->linkWriteReply = 0;
+    deliverString(state, "\r\n");
+    deliverString(state, dialect->writeResponse);
+    deliverString(state, " ");
+    deliverUInt(state, state->linkSocket);
+    deliverString(state, ",");
+    deliverUInt(state, len);
+    deliverString(state, "\r\n\r\nOK\r\n");
+}
+
+/**
+ * Answer the socket read made in transparent mode with the announced
+ * datagram, then announce the next one.
+ *
+ * @param state the modem socket state
+ */
+static void linkReadResponse(ModemSocketState* state)
+{
+    const ModemSocketDialect* dialect = state->dialect;
+    uint16_t len = state->linkAnnounced ? linkDatagram(state) : 0;
+    uint16_t count = (len < state->linkReadReply) ? len : state->linkReadReply;
+
+    state->linkReadReply = 0;
+    deliverString(state, "\r\n");
+    deliverString(state, dialect->readResponse);
+    deliverString(state, " ");
+    deliverUInt(state, state->linkSocket);
+    deliverString(state, ",\"");
+    deliverString(state, state->linkAddress);
+    deliverString(state, "\",");
+    deliverUInt(state, state->linkPort);
+    deliverString(state, ",");
+    deliverUInt(state, count);
+    deliverString(state, ",\"");
+    deliver(state, state->linkBuffer, count);
+    deliverString(state, "\"\r\n\r\nOK\r\n");
+
+    if (len > 0)
+    {
+        /* Any part of the datagram beyond the read length is lost, as it
+         * would be when reading from the modem.
+         */
+        state->linkLen -= len;
+        memmove(state->linkBuffer, state->linkBuffer + len, state->linkLen);
+        state->linkAnnounced = false;
+        linkAnnounce(state);
+    }
+}
+
+/**
+ * Parse the read response header held in rxHold.
+ *
+ * @param state the modem socket state
+ * @param ch the latest byte added to rxHold
+ * @return true if the payload starts after this byte
+ */
+static bool parseReadHeader(ModemSocketState* state, uint8_t ch)
+{
+    const ModemSocketDialect* dialect = state->dialect;
+    if (ch == '"')
+    {
+        if (!state->rxInQuote
+            && (state->rxField == dialect->readLengthField + 1)
+            && (state->rxFieldStart == state->rxHoldLen - 1))
+        {
+            return true;
+        }
+        state->rxInQuote = !state->rxInQuote;
+    }
+    else if ((ch == ',') && !state->rxInQuote)
+    {
+        if (state->rxField == dialect->readLengthField)
+        {
+            const char* start = (const char*)&state->rxHold[state->rxFieldStart];
+            const char* end = (const char*)&state->rxHold[state->rxHoldLen - 1];
+            while ((start < end) && (*start == ' '))
+            {
+                ++start;
+            }
+            state->rxLength = (uint16_t)Thingstream_Util_parseUInt(start, end, NULL);
+        }
+        state->rxField++;
+        state->rxFieldStart = state->rxHoldLen;
+    }
+    return false;
+}
+
+/**
+ * Return the prefix of the given kind of line, or NULL if lines of that
+ * kind are not expected at present.
+ */
+static const char* linePrefix(const ModemSocketState* state, RxLineKind kind)
+{
+    const ModemSocketDialect* dialect = state->dialect;
+    switch (kind)
+    {
+    case LINE_READ:
+        return state->ownRead ? dialect->readResponse : NULL;
+    case LINE_DATA_URC:
+        return (state->socketsOpen > 0) ? dialect->dataUrc : NULL;
+    case LINE_CLOSE_URC:
+        return (state->socketsOpen > 0) ? dialect->closeUrc : NULL;
+    case LINE_RECV_URC:
+        return dialect->recvUrc;
+    default:
+        return NULL;
+    }
+}
+
+/**
+ * Match the bytes held in rxHold against the expected kinds of line.
+ *
+ * @param state the modem socket state
+ * @param pPartial set to true if the held bytes may still become a match
+ * @return the kind of line matched, or LINE_OWN if there is no match
+ */
+static RxLineKind matchLine(ModemSocketState* state, bool* pPartial)
+{
+    RxLineKind kind;
+    *pPartial = false;
+    for (kind = LINE_READ; kind < LINE_OWN; ++kind)
+    {
+        const char* prefix = linePrefix(state, kind);
+        if (isCommand(state->rxHold, state->rxHoldLen, prefix))
+        {
+            return kind;
+        }
+        if (isCommandPrefix(state->rxHold, state->rxHoldLen, prefix))
+        {
+            *pPartial = true;
+        }
+    }
+    return LINE_OWN;
+}
+
+/**
+ * Find the open application socket with the given modem id.
+ */
+static ModemSocket* findSocket(ModemSocketState* state, uint32_t id)
+{
+    int i;
+    for (i = 0; i < MODEM_SOCKET_MAX_SOCKETS; ++i)
+    {
+        ModemSocket* socket = &state->sockets[i];
+        if (socket->open && (socket->id == id))
+        {
+            return socket;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Handle a data or close URC.
+ *
+ * @param state the modem socket state
+ * @param line the URC, without its line end
+ * @param len the length of the URC
+ * @return true if the URC is for an application socket
+ */
+static bool socketUrc(ModemSocketState* state, const uint8_t* line, uint16_t len)
+{
+    const char* p = (const char*)line + strlen(linePrefix(state, state->rxLineKind));
+    const char* end = (const char*)line + len;
+    while ((p < end) && (*p == ' '))
+    {
+        ++p;
+    }
+    ModemSocket* socket = findSocket(state, Thingstream_Util_parseUInt(p, end, &p));
+    if (socket == NULL)
+    {
+        return false;
+    }
+    if (state->rxLineKind == LINE_CLOSE_URC)
+    {
+        socket->open = false;
+        socket->closed = true;
+        state->socketsOpen--;
+    }
+    else if ((p < end) && (*p == ','))
+    {
+        socket->available = (uint16_t)Thingstream_Util_parseUInt(p + 1, end, NULL);
+    }
+    return true;
+}
+
+/**
+ * Handle a line received while an own command is in progress.
+ *
+ * @param state the modem socket state
+ * @param line the line, without its line end
+ * @param len the length of the line
+ * @return true if the line belongs to the own command
+ */
+static bool ownLine(ModemSocketState* state, const uint8_t* line, uint16_t len)
+{
+    const char* text = (const char*)line;
+    if (len == 0)
+    {
+        return true;
+    }
+    if (isCommand(line, len, "OK"))
+    {
+        state->ownResult = TRANSPORT_SUCCESS;
+        state->ownDone = true;
+    }
+    else if (isCommand(line, len, "CONNECT"))
+    {
+        /* The modem has entered transparent mode */
+        state->linkActive = true;
+        state->linkSkipLf = true;
+        state->linkLen = 0;
+        state->linkAnnounced = false;
+        state->ownResult = TRANSPORT_SUCCESS;
+        state->ownDone = true;
+    }
+    else if (isCommand(line, len, "DISCONNECT"))
+    {
+        /* The modem has left transparent mode, OK follows */
+    }
+    else if ((len >= 10) && (memcmp(line, "+CME ERROR", 10) == 0))
+    {
+        state->ownResult = TRANSPORT_MODEM_CME_ERROR;
+        state->ownDone = true;
+    }
+    else if (isCommand(line, len, "ERROR"))
+    {
+        state->ownResult = TRANSPORT_MODEM_ERROR;
+        state->ownDone = true;
+    }
+    else if ((state->ownExpect != NULL)
+             && (len >= strlen(state->ownExpect))
+             && isCommandPrefix(line, (uint16_t)strlen(state->ownExpect), state->ownExpect))
+    {
+        const char* p = text + strlen(state->ownExpect);
+        while ((p < text + len) && (*p == ' '))
+        {
+            ++p;
+        }
+        state->ownValue = (int32_t)Thingstream_Util_parseUInt(p, text + len, NULL);
+    }
+    else if ((len < 2) || (memcmp(line, "AT", 2) != 0))
+    {
+        /* Not an echo of the command, so something for the modem transport */
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Note a data URC for the modem transport's socket, so that its next read
+ * is passed on to the modem.
+ *
+ * @param state the modem socket state
+ * @param line the URC, without its line end
+ * @param len the length of the URC
+ */
+static void recvUrc(ModemSocketState* state, const uint8_t* line, uint16_t len)
+{
+    const ModemSocketDialect* dialect = state->dialect;
+    const char* p = (const char*)line;
+    const char* end = p + len;
+    uint16_t waiting = 0;
+
+    if ((dialect->recvUrc == NULL)
+        || (len < strlen(dialect->recvUrc))
+        || (memcmp(line, dialect->recvUrc, strlen(dialect->recvUrc)) != 0))
+    {
+        return;
+    }
+    if (dialect->recvUrcLength)
+    {
+        while ((p < end) && (*p != ','))
+        {
+            ++p;
+        }
+        if (p < end)
+        {
+            waiting = (uint16_t)Thingstream_Util_parseUInt(p + 1, end, NULL);
+        }
+    }
+    state->readWaitingLen = waiting;
+    state->readWaiting = true;
+}
+
+/**
+ * Handle the URC or own command response held in rxHold.
+ *
+ * @param state the modem socket state
+ */
+static void endLine(ModemSocketState* state)
+{
+    uint16_t len = state->rxHoldLen;
+    while ((len > 0) && IS_LINE_END(state->rxHold[len - 1]))
+    {
+        --len;
+    }
+    bool consumed;
+    if (state->rxLineKind == LINE_OWN)
+    {
+        consumed = ownLine(state, state->rxHold, len);
+    }
+    else if (state->rxLineKind == LINE_RECV_URC)
+    {
+        consumed = false;
+    }
+    else
+    {
+        consumed = socketUrc(state, state->rxHold, len);
+    }
+    if (!consumed && (state->rxLineKind != LINE_OWN))
+    {
+        /* A URC for the modem transport's socket */
+        recvUrc(state, state->rxHold, len);
+    }
+    if (!consumed)
+    {
+        deliver(state, state->rxHold, state->rxHoldLen);
+        if (state->ownActive && (state->rxHold[state->rxHoldLen - 1] == '\r'))
+        {
+            uint8_t lf = '\n';
+            deliver(state, &lf, 1);
+        }
+    }
+}
+
+/**
+ * Note the length reported by the response to a read that was passed on:
+ * more reads are passed on until one reports that no data is left.
+ *
+ * @param state the modem socket state
+ * @param length the length reported
+ */
+static void pollDone(ModemSocketState* state, uint16_t length)
+{
+    state->readPassed = false;
+    state->pollMatched = 0;
+    state->readWaiting = (length > 0);
+}
+
+/**
+ * Watch the modem output for the response to a read that was passed on,
+ * and parse its length field. The output itself is not changed. A response
+ * that ends before its length field (e.g. "+USORF: 0,0") reports no data.
+ *
+ * @param state the modem socket state
+ * @param data the modem output
+ * @param len the length of the modem output
+ */
+static void watchPollResponse(ModemSocketState* state, const uint8_t* data, uint16_t len)
+{
+    const ModemSocketDialect* dialect = state->dialect;
+    const char* prefix = dialect->pollResponse;
+    uint8_t prefixLen = (uint8_t)strlen(prefix);
+    uint16_t i;
+
+    for (i = 0; (i < len) && state->readPassed; ++i)
+    {
+        uint8_t ch = data[i];
+        bool inLength = (state->pollField == dialect->pollLengthField);
+
+        if (state->pollMatched < prefixLen)
+        {
+            if (ch == (uint8_t)prefix[state->pollMatched])
+            {
+                state->pollMatched++;
+            }
+            else
+            {
+                state->pollMatched = (ch == (uint8_t)prefix[0]) ? 1 : 0;
+            }
+            if (state->pollMatched == prefixLen)
+            {
+                state->pollField = 0;
+                state->pollInQuote = false;
+                state->pollDigits = false;
+                state->pollValue = 0;
+            }
+        }
+        else if (IS_LINE_END(ch))
+        {
+            pollDone(state, inLength ? state->pollValue : 0);
+        }
+        else if (ch == '"')
+        {
+            state->pollInQuote = !state->pollInQuote;
+        }
+        else if (state->pollInQuote)
+        {
+            /* e.g. the remote address */
+        }
+        else if (inLength && (ch >= '0') && (ch <= '9'))
+        {
+            state->pollValue = (uint16_t)(state->pollValue * 10 + (ch - '0'));
+            state->pollDigits = true;
+        }
+        else if (inLength && state->pollDigits)
+        {
+            /* the payload follows the length */
+            pollDone(state, state->pollValue);
+        }
+        else if (ch == ',')
+        {
+            state->pollField++;
+        }
+    }
+}
+
+/**
+ * Callback from the inner transport with modem output.
+ *
+ * @param cookie the modem socket state
+ * @param data the modem output
+ * @param len the length of the modem output
+ */
+static void modem_socket_callback(void* cookie, uint8_t* data, uint16_t len)
+{
+    ModemSocketState* state = (ModemSocketState*)cookie;
+    const ModemSocketDialect* dialect = state->dialect;
+    uint16_t run = 0;
+    uint16_t i;
+
+    if (dialect == NULL)
+    {
+        deliver(state, data, len);
+        return;
+    }
+    if (state->readPassed)
+    {
+        watchPollResponse(state, data, len);
+    }
+
+    for (i = 0; i < len; ++i)
+    {
+        uint8_t ch = data[i];
+        RxLineKind kind;
+        bool partial;
+
+        if (state->linkActive)
+        {
+            deliver(state, data + run, i - run);
+            if (state->linkSkipLf && (ch == '\n'))
+            {
+                ++i;
+            }
+            state->linkSkipLf = false;
+            linkData(state, data + i, len - i);
+            return;
+        }
+        if (state->writeAwaitPrompt && (ch == (uint8_t)dialect->prompt))
+        {
+            /* The modem transport sends the payload once it sees this */
+            state->writeAwaitPrompt = false;
+            state->writePromptSeen = true;
+        }
+        if (state->rxAwaitPrompt && !state->rxPromptSeen && (ch == (uint8_t)dialect->prompt))
+        {
+            deliver(state, data + run, i - run);
+            run = i + 1;
+            state->rxPromptSeen = true;
+            state->rxSwallowSpace = (ch == '>');
+            continue;
+        }
+        if (state->rxSwallowSpace)
+        {
+            state->rxSwallowSpace = false;
+            if (ch == ' ')
+            {
+                deliver(state, data + run, i - run);
+                run = i + 1;
+                continue;
+            }
+        }
+
+        switch (state->rxState)
+        {
+        case RX_LINE_START:
+            if (IS_LINE_END(ch))
+            {
+                if (state->ownActive)
+                {
+                    /* drop the blank lines around own command responses */
+                    deliver(state, data + run, i - run);
+                    run = i + 1;
+                }
+                break;
+            }
+            state->rxHoldLen = 0;
+            state->rxState = RX_MATCHING;
+            if (!state->ownActive)
+            {
+                state->rxHold[0] = ch;
+                state->rxHoldLen = 1;
+                (void)matchLine(state, &partial);
+                state->rxHoldLen = 0;
+                if (!partial)
+                {
+                    state->rxState = RX_PASSING;
+                    break;
+                }
+            }
+            deliver(state, data + run, i - run);
+            /* FALLTHROUGH */
+
+        case RX_MATCHING:
+            run = i + 1;
+            state->rxHold[state->rxHoldLen++] = ch;
+            kind = matchLine(state, &partial);
+            if (kind == LINE_READ)
+            {
+                state->rxField = 0;
+                state->rxFieldStart = state->rxHoldLen;
+                state->rxInQuote = false;
+                state->rxLength = 0;
+                state->rxState = RX_HEADER;
+            }
+            else if (kind != LINE_OWN)
+            {
+                state->rxLineKind = kind;
+                state->rxState = RX_LINE;
+            }
+            else if (partial)
+            {
+                /* keep holding */
+            }
+            else if (state->ownActive)
+            {
+                state->rxLineKind = LINE_OWN;
+                state->rxState = RX_LINE;
+                if (IS_LINE_END(ch))
+                {
+                    endLine(state);
+                    state->rxState = RX_LINE_START;
+                }
+            }
+            else
+            {
+                deliver(state, state->rxHold, state->rxHoldLen);
+                state->rxState = IS_LINE_END(ch) ? RX_LINE_START : RX_PASSING;
+            }
+            break;
+
+        case RX_HEADER:
+            run = i + 1;
+            state->rxHold[state->rxHoldLen++] = ch;
+            if (parseReadHeader(state, ch))
+            {
+                if (!state->ownRead)
+                {
+                    deliver(state, state->rxHold, state->rxHoldLen);
+                }
+                state->rxState = (state->rxLength > 0) ? RX_PAYLOAD
+                               : state->ownRead ? RX_SKIP : RX_PASSING;
+            }
+            else if (IS_LINE_END(ch) || (state->rxHoldLen == RX_HOLD_LEN))
+            {
+                if (!state->ownRead)
+                {
+                    deliver(state, state->rxHold, state->rxHoldLen);
+                }
+                state->rxState = IS_LINE_END(ch) ? RX_LINE_START
+                               : state->ownRead ? RX_SKIP : RX_PASSING;
+            }
+            break;
+
+        case RX_PAYLOAD:
+            {
+                uint16_t count = len - i;
+                if (count > state->rxLength)
+                {
+                    count = state->rxLength;
+                }
+                if (state->ownRead)
+                {
+                    uint16_t room = state->txSize - state->ownReadLen;
+                    uint16_t copy = (count < room) ? count : room;
+                    memcpy(state->txBuffer + state->ownReadLen, data + i, copy);
+                    state->ownReadLen += copy;
+                }
+                else
+                {
+                    deliver(state, data + i, count);
+                }
+                state->rxLength -= count;
+                i += count - 1;
+                run = i + 1;
+                if (state->rxLength == 0)
+                {
+                    state->rxState = state->ownRead ? RX_SKIP : RX_PASSING;
+                }
+            }
+            break;
+
+        case RX_LINE:
+            run = i + 1;
+            if (state->rxHoldLen < RX_HOLD_LEN)
+            {
+                state->rxHold[state->rxHoldLen++] = ch;
+            }
+            else if (state->rxLineKind != LINE_OWN)
+            {
+                /* Too long to be a URC for an application socket */
+                deliver(state, state->rxHold, state->rxHoldLen);
+                run = i;
+                state->rxState = IS_LINE_END(ch) ? RX_LINE_START : RX_PASSING;
+                break;
+            }
+            if (IS_LINE_END(ch))
+            {
+                endLine(state);
+                state->rxState = RX_LINE_START;
+            }
+            break;
+
+        case RX_SKIP:
+            run = i + 1;
+            if (IS_LINE_END(ch))
+            {
+                state->rxState = RX_LINE_START;
+            }
+            break;
+
+        case RX_PASSING:
+            if (IS_LINE_END(ch))
+            {
+                state->rxState = RX_LINE_START;
+            }
+            break;
+        }
+    }
+    deliver(state, data + run, len - run);
+}
+
+/**
+ * Run the inner transport until one of the conditions is met or the time
+ * limit is reached.
+ *
+ * @param state the modem socket state
+ * @param flag the condition to wait for, or NULL to wait until the limit
+ * @param flag2 a second condition to wait for, or NULL
+ * @param limit the time limit
+ * @return true if a condition was met
+ */
+static bool runInnerUntil(ModemSocketState* state, volatile bool* flag, volatile bool* flag2, uint32_t limit)
+{
+    ThingstreamTransport* inner = state->inner;
+    for (;;)
+    {
+        if (((flag != NULL) && *flag) || ((flag2 != NULL) && *flag2))
+        {
+            return true;
+        }
+        uint32_t now = Thingstream_Platform_getTimeMillis();
+        if (TIME_COMPARE(now, >=, limit))
+        {
+            return false;
+        }
+        (void)inner->run(inner, limit - now);
+    }
+}
+
+/**
+ * Send a null-terminated string to the inner transport.
+ */
+static ThingstreamTransportResult sendString(ModemSocketState* state, uint16_t flags, const char* str, uint32_t limit)
+{
+    ThingstreamTransport* inner = state->inner;
+    uint32_t now = Thingstream_Platform_getTimeMillis();
+    uint32_t millis = TIME_COMPARE(limit, >, now) ? limit - now : 0;
+    return inner->send(inner, flags, (uint8_t*)str, (uint16_t)strlen(str), millis);
+}
+
+/**
+ * Send bytes to the inner transport.
+ */
+static ThingstreamTransportResult sendBytes(ModemSocketState* state, uint16_t flags, uint8_t* data, uint16_t len, uint32_t limit)
+{
+    ThingstreamTransport* inner = state->inner;
+    if (len == 0)
+    {
+        return TRANSPORT_SUCCESS;
+    }
+    uint32_t now = Thingstream_Platform_getTimeMillis();
+    uint32_t millis = TIME_COMPARE(limit, >, now) ? limit - now : 0;
+    return inner->send(inner, flags, data, len, millis);
+}
+
+/**
+ * A binary socket write command held in txBuffer, split into its fields.
+ */
+typedef struct SocketWrite_s
+{
+    /** The offset in txBuffer of the start of each field */
+    uint16_t fieldStart[MAX_FIELDS];
+    /** The offset in txBuffer of the end of each field */
+    uint16_t fieldEnd[MAX_FIELDS];
+    /** The number of fields */
+    uint8_t fields;
+    /** The length of the payload that follows the prompt */
+    uint16_t len;
+} SocketWrite;
+
+/**
+ * Split the binary socket write held in txBuffer into its fields. The last
+ * field of the command is the length of the payload that the modem
+ * transport sends once the modem has prompted for it.
+ *
+ * @param state the modem socket state
+ * @param prefix the prefix of the write command, or NULL
+ * @param write where to write the fields of the command
+ * @return false if the command was not recognised
+ */
+static bool parseWrite(ModemSocketState* state, const char* prefix, SocketWrite* write)
+{
+    const char* line = (const char*)state->txBuffer;
+    uint16_t* fieldStart = write->fieldStart;
+    uint16_t* fieldEnd = write->fieldEnd;
+    uint8_t fields = 0;
+    bool inQuote = false;
+    uint16_t prefixLen;
+    uint16_t i;
+    const char* p;
+    uint32_t len;
+
+    if (prefix == NULL)
+    {
+        return false;
+    }
+    prefixLen = (uint16_t)strlen(prefix);
+    if ((state->txLen <= prefixLen) || (memcmp(line, prefix, prefixLen) != 0))
+    {
+        return false;
+    }
+    fieldStart[0] = prefixLen;
+    for (i = prefixLen; i < state->txLen; ++i)
+    {
+        if (line[i] == '"')
+        {
+            inQuote = !inQuote;
+        }
+        else if ((line[i] == ',') && !inQuote)
+        {
+            if (fields + 1 == MAX_FIELDS)
+            {
+                return false;
+            }
+            fieldEnd[fields++] = i;
+            fieldStart[fields] = i + 1;
+        }
+    }
+    fieldEnd[fields++] = state->txLen;
+
+    /* The length must be the whole of the last field */
+    len = Thingstream_Util_parseUInt(line + fieldStart[fields - 1],
+                                     line + fieldEnd[fields - 1], &p);
+    if ((p != line + fieldEnd[fields - 1]) || (len == 0) || (len > 0xFFFF))
+    {
+        return false;
+    }
+    write->fields = fields;
+    write->len = (uint16_t)len;
+    return true;
+}
+
+/**
+ * Start passing the payload of a binary socket write through once the
+ * modem has prompted for it.
+ *
+ * @param state the modem socket state
+ * @param len the length of the payload
+ * @param link true if the write is made in transparent mode
+ */
+static void beginWrite(ModemSocketState* state, uint16_t len, bool link)
+{
+    state->writeLen = len;
+    state->writeRemaining = len;
+    state->writeLink = link;
+    state->writePromptSeen = false;
+    state->writeAwaitPrompt = !link;
+    state->linkPrompt = link;
+    state->txState = TX_WRITE;
+}
+
+/**
+ * Decide whether the socket read held in txBuffer needs to reach the modem.
+ * Reads are passed on from the modem's announcement of data until a read
+ * response reports that no data is left, as the Quectel and SimCom modems
+ * only announce data that arrives while their buffer is empty. A read made
+ * at other times is answered here instead, unless
+ * #MODEM_SOCKET_READ_POLL_MS have passed, in case an announcement was
+ * missed.
+ *
+ * @param state the modem socket state
+ * @param pLen where to write the length requested by the read
+ * @return true if the read has been answered and must not be sent
+ */
+static bool answerRead(ModemSocketState* state, uint32_t* pLen)
+{
+    const ModemSocketDialect* dialect = state->dialect;
+    const char* line = (const char*)state->txBuffer;
+    const char* end = line + state->txLen;
+    const char* p;
+    uint32_t id;
+    uint32_t len = 0;
+
+    if ((dialect->pollRead == NULL)
+        || (state->txLen <= strlen(dialect->pollRead))
+        || (memcmp(line, dialect->pollRead, strlen(dialect->pollRead)) != 0))
+    {
+        return false;
+    }
+    id = Thingstream_Util_parseUInt(line + strlen(dialect->pollRead), end, &p);
+    if ((p < end) && (*p == ','))
+    {
+        len = Thingstream_Util_parseUInt(p + 1, end, NULL);
+    }
+    *pLen = len;
+
+    uint32_t now = Thingstream_Platform_getTimeMillis();
+    if (state->readWaiting
+        || (!state->linkActive
+            && TIME_COMPARE(now, >=, state->readPassedTime + MODEM_SOCKET_READ_POLL_MS)))
+    {
+        /* A query for the amount waiting does not report the data left */
+        if (len > 0)
+        {
+            state->readPassed = true;
+            state->pollMatched = 0;
+        }
+        state->readPassedTime = now;
+        return false;
+    }
+
+    state->readReply = ((len == 0) && (dialect->queryNone != NULL))
+                       ? dialect->queryNone : dialect->readNone;
+    state->readReplyId = id;
+    return true;
+}
+
+/**
+ * Pass the answer to a read made while no data was waiting to the modem
+ * transport, as the modem would have answered it.
+ *
+ * @param state the modem socket state
+ */
+static void readResponse(ModemSocketState* state)
+{
+    const char* reply = state->readReply;
+    const char* hash = strchr(reply, '#');
+
+    state->readReply = NULL;
+    deliverString(state, "\r\n");
+    if (hash != NULL)
+    {
+        deliver(state, (uint8_t*)reply, (uint16_t)(hash - reply));
+        deliverUInt(state, state->readReplyId);
+        reply = hash + 1;
+    }
+    deliverString(state, reply);
+    deliverString(state, "\r\n\r\nOK\r\n");
+}
+
+/**
+ * Send the socket read held in txBuffer, limited to the number of bytes
+ * that the modem has announced so that the modem transport does not ask
+ * for more than it will be given.
+ *
+ * @param state the modem socket state
+ * @param flags the flags passed to send()
+ * @param len the length requested by the read
+ * @param limit the time limit
+ * @param pRes where to write the result of sending the read
+ * @return false if the read should be sent as is
+ */
+static bool sendSizedRead(ModemSocketState* state, uint16_t flags, uint32_t len, uint32_t limit, ThingstreamTransportResult* pRes)
+{
+    const ModemSocketDialect* dialect = state->dialect;
+    uint16_t waiting = state->readWaitingLen;
+    const uint8_t* comma;
+
+    state->readWaitingLen = 0;
+    if (!dialect->recvUrcLength || (waiting == 0) || (len <= waiting))
+    {
+        return false;
+    }
+    comma = memchr(state->txBuffer, ',', state->txLen);
+    if (comma == NULL)
+    {
+        return false;
+    }
+
+    char lenStr[12];
+    *Thingstream_Util_sprintfUInt(lenStr, waiting) = '\0';
+    ThingstreamTransportResult tRes;
+    tRes = sendBytes(state, flags, state->txBuffer, (uint16_t)(comma + 1 - state->txBuffer), limit);
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        tRes = sendString(state, flags, lenStr, limit);
+    }
+    *pRes = tRes;
+    return true;
+}
+
+static bool processLinkLine(ModemSocketState* state, uint32_t limit, ThingstreamTransportResult* pRes);
+static ThingstreamTransportResult leaveLink(ModemSocketState* state, uint32_t limit);
+
+/**
+ * Process a complete socket command line held in txBuffer.
+ *
+ * @param state the modem socket state
+ * @param flags the flags passed to send()
+ * @param terminator the character that ended the line
+ * @param limit the time limit
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult processLine(ModemSocketState* state, uint16_t flags, uint8_t terminator, uint32_t limit)
+{
+    const ModemSocketDialect* dialect = state->dialect;
+    ThingstreamTransportResult tRes;
+    uint32_t readLen = 0;
+    SocketWrite write;
+
+    if ((state->linkBuffer != NULL) && processLinkLine(state, limit, &tRes))
+    {
+        state->txSwallowLf = (terminator == '\r');
+        return tRes;
+    }
+    if (answerRead(state, &readLen))
+    {
+        state->txSwallowLf = (terminator == '\r');
+        return TRANSPORT_SUCCESS;
+    }
+    tRes = leaveLink(state, limit);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return tRes;
+    }
+
+    if ((readLen > 0) && sendSizedRead(state, flags, readLen, limit, &tRes))
+    {
+        /* the terminator is sent below */
+    }
+    else
+    {
+        if (parseWrite(state, dialect->binarySend, &write)
+            || parseWrite(state, dialect->connectedSend, &write))
+        {
+            /* The payload follows the prompt, and may hold any bytes */
+            beginWrite(state, write.len, false);
+        }
+        tRes = sendBytes(state, flags, state->txBuffer, state->txLen, limit);
+    }
+
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        tRes = sendBytes(state, flags, &terminator, 1, limit);
+    }
+    return tRes;
+}
+
+/**
+ * Start an AT command issued by this transport, rather than by the modem
+ * transport. Responses are consumed until the final result code, other
+ * lines are passed on to the modem transport as usual.
+ *
+ * @param state the modem socket state
+ * @param expect the information response to parse, or NULL
+ */
+static void beginOwn(ModemSocketState* state, const char* expect)
+{
+    state->ownExpect = expect;
+    state->ownValue = -1;
+    state->ownResult = TRANSPORT_SEND_TIMEOUT;
+    state->ownDone = false;
+    state->ownReadLen = 0;
+    state->ownActive = true;
+}
+
+/**
+ * Wait for the own command to complete.
+ *
+ * @param state the modem socket state
+ * @param tRes the result of sending the command
+ * @param limit the time limit
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult endOwn(ModemSocketState* state, ThingstreamTransportResult tRes, uint32_t limit)
+{
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        (void)runInnerUntil(state, &state->ownDone, NULL, limit);
+        tRes = state->ownResult;
+    }
+    state->ownActive = false;
+    state->ownRead = false;
+    state->rxAwaitPrompt = false;
+    return tRes;
+}
+
+/**
+ * Send a number in decimal to the inner transport.
+ */
+static ThingstreamTransportResult sendUInt(ModemSocketState* state, uint32_t num, uint32_t limit)
+{
+    char str[12];
+    *Thingstream_Util_sprintfUInt(str, num) = '\0';
+    return sendString(state, 0, str, limit);
+}
+
+/**
+ * Return the application socket for the handle, or NULL if not valid.
+ */
+static ModemSocket* socketForHandle(ModemSocketState* state, int16_t handle)
+{
+    if ((handle < 0) || (handle >= MODEM_SOCKET_MAX_SOCKETS))
+    {
+        return NULL;
+    }
+    return &state->sockets[handle];
+}
+
+/**
+ * Send a datagram on an application socket with a binary write.
+ *
+ * @param state the modem socket state
+ * @param socket the application socket
+ * @param data the datagram
+ * @param len the length of the datagram
+ * @param limit the time limit
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult ownSend(ModemSocketState* state, ModemSocket* socket, uint8_t* data, uint16_t len, uint32_t limit)
+{
+    const ModemSocketDialect* dialect = state->dialect;
+    ThingstreamTransportResult tRes;
+
+    tRes = leaveLink(state, limit);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return tRes;
+    }
+    beginOwn(state, dialect->writeResponse);
+    state->rxPromptSeen = false;
+    state->rxAwaitPrompt = true;
+    tRes = sendString(state, 0, dialect->binarySend, limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendUInt(state, socket->id, limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendString(state, 0, ",\"", limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendString(state, 0, socket->address, limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendString(state, 0, "\",", limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendUInt(state, socket->port, limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendString(state, 0, ",", limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendUInt(state, len, limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendString(state, 0, "\r", limit);
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        (void)runInnerUntil(state, &state->rxPromptSeen, &state->ownDone, limit);
+        if (state->rxPromptSeen)
+        {
+            uint32_t ready = Thingstream_Platform_getTimeMillis() + dialect->promptDelayMs;
+            (void)runInnerUntil(state, NULL, NULL, TIME_COMPARE(ready, <, limit) ? ready : limit);
+            tRes = sendBytes(state, 0, data, len, limit);
+        }
+    }
+    return endOwn(state, tRes, limit);
+}
+
+/**
+ * Read the data waiting on an application socket into txBuffer.
+ *
+ * @param state the modem socket state
+ * @param socket the application socket
+ * @param len the maximum length to read
+ * @param limit the time limit
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult ownReceive(ModemSocketState* state, ModemSocket* socket, uint16_t len, uint32_t limit)
+{
+    const ModemSocketDialect* dialect = state->dialect;
+    ThingstreamTransportResult tRes;
+
+    tRes = leaveLink(state, limit);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return tRes;
+    }
+    beginOwn(state, NULL);
+    state->ownRead = true;
+    tRes = sendString(state, 0, dialect->socketRead, limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendUInt(state, socket->id, limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendString(state, 0, ",", limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendUInt(state, len, limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendString(state, 0, "\r", limit);
+    return endOwn(state, tRes, limit);
+}
+
+/**
+ * Connect the modem transport's socket to the peer given by linkSocket,
+ * linkAddress and linkPort, and switch the modem to transparent mode.
+ *
+ * @param state the modem socket state
+ * @param limit the time limit
+ * @return true if the modem is in transparent mode
+ */
+static bool enterLink(ModemSocketState* state, uint32_t limit)
+{
+    const ModemSocketDialect* dialect = state->dialect;
+    ThingstreamTransportResult tRes;
+
+    beginOwn(state, NULL);
+    tRes = sendString(state, 0, dialect->socketConnect, limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendUInt(state, state->linkSocket, limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendString(state, 0, ",\"", limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendString(state, 0, state->linkAddress, limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendString(state, 0, "\",", limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendUInt(state, state->linkPort, limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendString(state, 0, "\r", limit);
+    tRes = endOwn(state, tRes, limit);
+    /* An error is expected if the socket is already connected */
+    if (tRes == TRANSPORT_SEND_TIMEOUT)
+    {
+        return false;
+    }
+
+    beginOwn(state, NULL);
+    tRes = sendString(state, 0, dialect->linkEnter, limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendUInt(state, state->linkSocket, limit);
+    if (tRes == TRANSPORT_SUCCESS)
+        tRes = sendString(state, 0, "\r", limit);
+    tRes = endOwn(state, tRes, limit);
+    return (tRes == TRANSPORT_SUCCESS) && state->linkActive;
+}
+
+/**
+ * Return the modem from transparent mode to command mode, if necessary.
+ *
+ * @param state the modem socket state
+ * @param limit the time limit, extended if needed for the guard times
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult leaveLink(ModemSocketState* state, uint32_t limit)
+{
+    ThingstreamTransportResult tRes;
+    uint32_t ready;
+
+    if (!state->linkActive)
+    {
+        return TRANSPORT_SUCCESS;
+    }
+
+    /* Received data is still collected during the guard time */
+    ready = Thingstream_Platform_getTimeMillis() + MODEM_SOCKET_ESCAPE_GUARD_MS;
+    (void)runInnerUntil(state, NULL, NULL, ready);
+
+    ready = Thingstream_Platform_getTimeMillis() + 2 * MODEM_SOCKET_ESCAPE_GUARD_MS;
+    if (TIME_COMPARE(limit, <, ready))
+    {
+        limit = ready;
+    }
+    tRes = sendString(state, 0, "+++", limit);
+    state->linkActive = false;
+    state->linkLen = 0;
+    state->linkAnnounced = false;
+    state->rxState = RX_LINE_START;
+
+    /* The modem answers OK after the second guard time */
+    beginOwn(state, NULL);
+    return endOwn(state, tRes, limit);
+}
+
+/**
+ * Handle a socket command from the modem transport while transparent mode
+ * is enabled: a binary write to the transparent socket is answered with the
+ * prompt and its payload is then sent as is (entering transparent mode
+ * first if necessary), and a read of an announced datagram is answered
+ * from linkBuffer.
+ *
+ * @param state the modem socket state
+ * @param limit the time limit
+ * @param pRes where to write the result of handling the command
+ * @return false if the command should be sent to the modem in command mode
+ */
+static bool processLinkLine(ModemSocketState* state, uint32_t limit, ThingstreamTransportResult* pRes)
+{
+    const ModemSocketDialect* dialect = state->dialect;
+    const char* line = (const char*)state->txBuffer;
+    SocketWrite write;
+
+    if (dialect->linkEnter == NULL)
+    {
+        return false;
+    }
+
+    if (state->linkActive && state->linkAnnounced
+        && (state->txLen > strlen(dialect->socketRead))
+        && (memcmp(line, dialect->socketRead, strlen(dialect->socketRead)) == 0))
+    {
+        const char* p = line + strlen(dialect->socketRead);
+        const char* end = line + state->txLen;
+        uint32_t want;
+        if ((Thingstream_Util_parseUInt(p, end, &p) != state->linkSocket)
+            || (p == end) || (*p != ','))
+        {
+            return false;
+        }
+        want = Thingstream_Util_parseUInt(p + 1, end, NULL);
+        if (want == 0)
+        {
+            return false;
+        }
+        state->linkReadReply = (want < state->linkSize) ? (uint16_t)want : state->linkSize;
+        *pRes = TRANSPORT_SUCCESS;
+        return true;
+    }
+
+    if (!parseWrite(state, dialect->binarySend, &write)
+        || (write.fields != LINK_LENGTH_FIELD + 1)
+        || (write.len > state->linkSize))
+    {
+        return false;
+    }
+
+    /* The socket and its peer, the address without its quotes */
+    const char* socketField = line + write.fieldStart[LINK_SOCKET_FIELD];
+    const char* address = line + write.fieldStart[LINK_ADDRESS_FIELD] + 1;
+    uint16_t addressLen = write.fieldEnd[LINK_ADDRESS_FIELD]
+                        - write.fieldStart[LINK_ADDRESS_FIELD] - 2;
+    uint32_t socket = Thingstream_Util_parseUInt(socketField,
+                          line + write.fieldEnd[LINK_SOCKET_FIELD], NULL);
+    uint32_t port = Thingstream_Util_parseUInt(line + write.fieldStart[LINK_PORT_FIELD],
+                          line + write.fieldEnd[LINK_PORT_FIELD], NULL);
+    if ((write.fieldEnd[LINK_ADDRESS_FIELD] - write.fieldStart[LINK_ADDRESS_FIELD] < 2)
+        || (address[-1] != '"') || (address[addressLen] != '"')
+        || (addressLen >= LINK_ADDRESS_LEN))
+    {
+        return false;
+    }
+
+    if (state->linkActive
+        && ((socket != state->linkSocket) || (port != state->linkPort)
+            || (strlen(state->linkAddress) != addressLen)
+            || (memcmp(state->linkAddress, address, addressLen) != 0)))
+    {
+        /* A different peer, start again */
+        *pRes = leaveLink(state, limit);
+        if (*pRes != TRANSPORT_SUCCESS)
+        {
+            return true;
+        }
+    }
+    if (!state->linkActive)
+    {
+        state->linkSocket = (uint8_t)socket;
+        state->linkPort = (uint16_t)port;
+        memcpy(state->linkAddress, address, addressLen);
+        state->linkAddress[addressLen] = '\0';
+        if (!enterLink(state, limit))
+        {
+            /* Not supported for this socket, stop trying */
+            state->linkBuffer = NULL;
+            state->linkActive = false;
+            return false;
+        }
+    }
+
+    /* Prompt for the payload, which is then sent as is */
+    beginWrite(state, write.len, true);
+    *pRes = TRANSPORT_SUCCESS;
+    return true;
+}
+
+
+int16_t Thingstream_ModemSocket_open(ThingstreamTransport* self, const char* address, uint16_t port, uint8_t* queue, uint16_t queueSize, ThingstreamModemSocketCallback callback, void* cookie, uint32_t millis)
+{
+    ModemSocketState* state = (ModemSocketState*)self->_state;
+    const ModemSocketDialect* dialect = state->dialect;
+    uint32_t limit = Thingstream_Platform_getTimeMillis() + millis;
+    ModemSocket* socket = NULL;
+    int16_t handle;
+
+    if ((dialect == NULL) || (dialect->socketCreate == NULL))
+    {
+        return TRANSPORT_ERROR;
+    }
+    if ((address == NULL) || (callback == NULL) || ((queue == NULL) && (queueSize > 0)))
+    {
+        return TRANSPORT_ILLEGAL_ARGUMENT;
+    }
+    for (handle = 0; handle < MODEM_SOCKET_MAX_SOCKETS; ++handle)
+    {
+        if (!state->sockets[handle].open && !state->sockets[handle].closed)
+        {
+            socket = &state->sockets[handle];
+            break;
+        }
+    }
+    if (socket == NULL)
+    {
+        return TRANSPORT_ERROR;
+    }
+
+    ThingstreamTransportResult tRes;
+    tRes = leaveLink(state, limit);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return tRes;
+    }
+    beginOwn(state, dialect->socketCreated);
+    tRes = sendString(state, 0, dialect->socketCreate, limit);
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        tRes = sendString(state, 0, "\r", limit);
+    }
+    tRes = endOwn(state, tRes, limit);
+    if ((tRes == TRANSPORT_SUCCESS) && (state->ownValue < 0))
+    {
+        tRes = TRANSPORT_INIT_UDP_SOCKET_CREATE_FAILED;
+    }
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return tRes;
+    }
+
+    memset(socket, 0, sizeof(*socket));
+    socket->id = (uint8_t)state->ownValue;
+    socket->address = address;
+    socket->port = port;
+    socket->queue = queue;
+    socket->queueSize = queueSize;
+    socket->callback = callback;
+    socket->cookie = cookie;
+    socket->open = true;
+    state->socketsOpen++;
+    return handle;
+}
+
+
+ThingstreamTransportResult Thingstream_ModemSocket_send(ThingstreamTransport* self, int16_t handle, const uint8_t* data, uint16_t len)
+{
+    ModemSocketState* state = (ModemSocketState*)self->_state;
+    ModemSocket* socket = socketForHandle(state, handle);
+
+    if ((socket == NULL) || !socket->open)
+    {
+        return TRANSPORT_ILLEGAL_ARGUMENT;
+    }
+    if ((uint32_t)len + 2 > (uint32_t)(socket->queueSize - socket->queueLen))
+    {
+        return TRANSPORT_BUFFER_TOO_SMALL;
+    }
+    uint8_t* entry = socket->queue + socket->queueLen;
+    entry[0] = (uint8_t)(len >> 8);
+    entry[1] = (uint8_t)len;
+    memcpy(entry + 2, data, len);
+    socket->queueLen += len + 2;
+    return TRANSPORT_SUCCESS;
+}
+
+
+ThingstreamTransportResult Thingstream_ModemSocket_service(ThingstreamTransport* self, uint32_t millis)
+{
+    ModemSocketState* state = (ModemSocketState*)self->_state;
+    uint32_t limit = Thingstream_Platform_getTimeMillis() + millis;
+    ThingstreamTransportResult tRes = TRANSPORT_SUCCESS;
+    int i;
+
+    for (i = 0; (i < MODEM_SOCKET_MAX_SOCKETS) && (tRes == TRANSPORT_SUCCESS); ++i)
+    {
+        ModemSocket* socket = &state->sockets[i];
+
+        if (socket->closed)
+        {
+            socket->closed = false;
+            socket->queueLen = 0;
+            socket->callback(socket->cookie, NULL, 0);
+            continue;
+        }
+
+        /* Send the queued datagrams */
+        while (socket->open && (socket->queueLen >= 2) && (tRes == TRANSPORT_SUCCESS))
+        {
+            uint16_t len = ((uint16_t)socket->queue[0] << 8) | socket->queue[1];
+            tRes = ownSend(state, socket, socket->queue + 2, len, limit);
+            if (tRes == TRANSPORT_SEND_TIMEOUT)
+            {
+                break;  /* keep the datagram for the next attempt */
+            }
+            /* The modem refused the datagram, it is dropped like any
+             * other lost UDP datagram.
+             */
+            tRes = TRANSPORT_SUCCESS;
+            socket->queueLen -= len + 2;
+            memmove(socket->queue, socket->queue + len + 2, socket->queueLen);
+        }
+
+        /* Read the announced datagrams */
+        while (socket->open && (socket->available > 0) && (tRes == TRANSPORT_SUCCESS))
+        {
+            uint16_t want = (socket->available < state->txSize) ? socket->available : state->txSize;
+            tRes = ownReceive(state, socket, want, limit);
+            if (tRes == TRANSPORT_SUCCESS)
+            {
+                uint16_t got = state->ownReadLen;
+                socket->available = ((got == 0) || (got >= socket->available))
+                                  ? 0 : socket->available - got;
+                if (got > 0)
+                {
+                    socket->callback(socket->cookie, state->txBuffer, got);
+                }
+            }
+        }
+    }
+    return tRes;
+}
+
+
+ThingstreamTransportResult Thingstream_ModemSocket_close(ThingstreamTransport* self, int16_t handle, uint32_t millis)
+{
+    ModemSocketState* state = (ModemSocketState*)self->_state;
+    const ModemSocketDialect* dialect = state->dialect;
+    ModemSocket* socket = socketForHandle(state, handle);
+    uint32_t limit = Thingstream_Platform_getTimeMillis() + millis;
+    ThingstreamTransportResult tRes = TRANSPORT_SUCCESS;
+
+    if (socket == NULL)
+    {
+        return TRANSPORT_ILLEGAL_ARGUMENT;
+    }
+    if (socket->open)
+    {
+        tRes = leaveLink(state, limit);
+        beginOwn(state, NULL);
+        if (tRes == TRANSPORT_SUCCESS)
+            tRes = sendString(state, 0, dialect->socketClose, limit);
+        if (tRes == TRANSPORT_SUCCESS)
+            tRes = sendUInt(state, socket->id, limit);
+        if (tRes == TRANSPORT_SUCCESS)
+            tRes = sendString(state, 0, "\r", limit);
+        tRes = endOwn(state, tRes, limit);
+        state->socketsOpen--;
+    }
+    memset(socket, 0, sizeof(*socket));
+    return tRes;
+}
+
+
+ThingstreamTransportResult Thingstream_ModemSocket_setTransparent(ThingstreamTransport* self, uint8_t* buffer, uint16_t bufSize, uint32_t millis)
+{
+    ModemSocketState* state = (ModemSocketState*)self->_state;
+    const ModemSocketDialect* dialect = state->dialect;
+    uint32_t limit = Thingstream_Platform_getTimeMillis() + millis;
+    ThingstreamTransportResult tRes;
+
+    if ((dialect == NULL) || (dialect->linkEnter == NULL))
+    {
+        return TRANSPORT_ERROR;
+    }
+    if ((buffer != NULL) && (bufSize < 3))
+    {
+        return TRANSPORT_ILLEGAL_ARGUMENT;
+    }
+    tRes = leaveLink(state, limit);
+    state->linkBuffer = buffer;
+    state->linkSize = (buffer != NULL) ? bufSize : 0;
+    return tRes;
+}
+
+
+/**
+ * Initialize the transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param version the transport API version
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_socket_init(ThingstreamTransport* self, uint16_t version)
+{
+    ModemSocketState* state = (ModemSocketState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+
+    if (!TRANSPORT_CHECK_VERSION_1(version))
+    {
+        return TRANSPORT_VERSION_MISMATCH;
+    }
+
+    state->txLen = 0;
+    state->txState = TX_LINE_START;
+    state->txSwallowLf = false;
+    state->writeRemaining = 0;
+    state->writeAwaitPrompt = false;
+    state->writePromptSeen = false;
+    state->linkPrompt = false;
+    state->rxAwaitPrompt = false;
+    state->rxSwallowSpace = false;
+    state->rxState = RX_LINE_START;
+    state->ownActive = false;
+    state->ownRead = false;
+    state->linkActive = false;
+    state->linkLen = 0;
+    state->linkAnnounced = false;
+    state->linkWriteReply = 0;
+    state->linkReadReply = 0;
+    state->readWaiting = true;
+    state->readWaitingLen = 0;
+    state->readPassed = false;
+    state->readPassedTime = Thingstream_Platform_getTimeMillis();
+    state->readReply = NULL;
+
+    /* Sockets do not survive the modem being initialised again */
+    int i;
+    for (i = 0; i < MODEM_SOCKET_MAX_SOCKETS; ++i)
+    {
+        ModemSocket* socket = &state->sockets[i];
+        if (socket->open)
+        {
+            socket->open = false;
+            socket->closed = true;
+        }
+    }
+    state->socketsOpen = 0;
+
+    ThingstreamTransportResult tRes;
+    tRes = inner->register_callback(inner, modem_socket_callback, state);
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        tRes = inner->init(inner, version);
+    }
+    return tRes;
+}
+
+/**
+ * Shutdown the transport (i.e. the opposite of initialize)
+ *
+ * @param self the #ThingstreamTransport instance
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_socket_shutdown(ThingstreamTransport* self)
+{
+    ModemSocketState* state = (ModemSocketState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    return inner->shutdown(inner);
+}
+
+/**
+ * Pass the buffer request to the inner transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param buffer where to write the buffer pointer
+ * @param len where the write the buffer length
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_socket_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len)
+{
+    ModemSocketState* state = (ModemSocketState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    if (inner->get_buffer == NULL)
+    {
+        return TRANSPORT_ERROR;
+    }
+    return inner->get_buffer(inner, buffer, len);
+}
+
+/**
+ * Send the data to the modem, answering socket reads that do not need to
+ * reach it and passing binary write payloads through untouched.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param flags an indication of the type of the data, zero is normal.
+ * @param data a pointer to the data
+ * @param len the length of the raw data
+ * @param millis the maximum number of milliseconds to run
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_socket_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis)
+{
+    ModemSocketState* state = (ModemSocketState*)self->_state;
+    const ModemSocketDialect* dialect = state->dialect;
+    ThingstreamTransportResult tRes = TRANSPORT_SUCCESS;
+    uint32_t limit = Thingstream_Platform_getTimeMillis() + millis;
+    uint16_t run = 0;
+    uint16_t i;
+
+    if (dialect == NULL)
+    {
+        ThingstreamTransport* inner = state->inner;
+        return inner->send(inner, flags, data, len, millis);
+    }
+
+    for (i = 0; (i < len) && (tRes == TRANSPORT_SUCCESS); ++i)
+    {
+        uint8_t ch = data[i];
+        if (state->txState == TX_WRITE)
+        {
+            if (state->writePromptSeen)
+            {
+                state->txSwallowLf = false;
+                state->txState = TX_PAYLOAD;
+            }
+            else if (state->txSwallowLf && (ch == '\n'))
+            {
+                tRes = sendBytes(state, flags, data + run, i - run, limit);
+                run = i + 1;
+                state->txSwallowLf = false;
+                continue;
+            }
+            else if (IS_LINE_END(ch))
+            {
+                /* the rest of the write command's line end */
+                continue;
+            }
+            else
+            {
+                /* No prompt, the modem transport has given up on the write */
+                state->writeAwaitPrompt = false;
+                state->linkPrompt = false;
+                state->txState = TX_LINE_START;
+            }
+        }
+        switch (state->txState)
+        {
+        case TX_LINE_START:
+            if (state->txSwallowLf && (ch == '\n'))
+            {
+                tRes = sendBytes(state, flags, data + run, i - run, limit);
+                run = i + 1;
+                state->txSwallowLf = false;
+                break;
+            }
+            state->txSwallowLf = false;
+            if (IS_LINE_END(ch))
+            {
+                if (state->linkActive)
+                {
+                    /* not part of any datagram */
+                    tRes = sendBytes(state, flags, data + run, i - run, limit);
+                    run = i + 1;
+                }
+                break;
+            }
+            tRes = sendBytes(state, flags, data + run, i - run, limit);
+            state->txLen = 0;
+            state->txState = TX_MATCHING;
+            /* FALLTHROUGH */
+
+        case TX_MATCHING:
+            run = i + 1;
+            state->txBuffer[state->txLen++] = ch;
+            if (isCommand(state->txBuffer, state->txLen, dialect->binarySend)
+                || isCommand(state->txBuffer, state->txLen, dialect->connectedSend))
+            {
+                state->txState = TX_HOLDING;
+            }
+            else if (isCommandPrefix(state->txBuffer, state->txLen, dialect->binarySend)
+                  || isCommandPrefix(state->txBuffer, state->txLen, dialect->connectedSend)
+                  || isCommandPrefix(state->txBuffer, state->txLen, dialect->pollRead)
+                  || (state->linkActive
+                      && isCommandPrefix(state->txBuffer, state->txLen, dialect->socketRead)))
+            {
+                /* keep holding, the read commands are checked at the line
+                 * end
+                 */
+                if (isCommand(state->txBuffer, state->txLen, dialect->pollRead)
+                    || (state->linkActive
+                        && isCommand(state->txBuffer, state->txLen, dialect->socketRead)))
+                {
+                    state->txState = TX_HOLDING;
+                }
+            }
+            else
+            {
+                if (tRes == TRANSPORT_SUCCESS)
+                {
+                    /* Any other command must be sent in command mode */
+                    tRes = leaveLink(state, limit);
+                }
+                if (tRes == TRANSPORT_SUCCESS)
+                {
+                    tRes = sendBytes(state, flags, state->txBuffer, state->txLen, limit);
+                }
+                state->txState = IS_LINE_END(ch) ? TX_LINE_START : TX_PASSING;
+            }
+            break;
+
+        case TX_HOLDING:
+            run = i + 1;
+            if (IS_LINE_END(ch))
+            {
+                /* processLine() may start a binary write */
+                state->txState = TX_LINE_START;
+                tRes = processLine(state, flags, ch, limit);
+            }
+            else if (state->txLen < state->txSize)
+            {
+                state->txBuffer[state->txLen++] = ch;
+            }
+            else
+            {
+                /* Too long to be a socket command, pass it on as is */
+                tRes = leaveLink(state, limit);
+                if (tRes == TRANSPORT_SUCCESS)
+                {
+                    tRes = sendBytes(state, flags, state->txBuffer, state->txLen, limit);
+                }
+                run = i;
+                state->txState = TX_PASSING;
+            }
+            break;
+
+        case TX_PASSING:
+            if (IS_LINE_END(ch))
+            {
+                state->txState = TX_LINE_START;
+            }
+            break;
+
+        case TX_PAYLOAD:
+            /* pass the payload through, it is not a command line */
+            {
+                uint16_t count = len - i;
+                if (count > state->writeRemaining)
+                {
+                    count = state->writeRemaining;
+                }
+                i += count - 1;
+                state->writeRemaining -= count;
+            }
+            if (state->writeRemaining == 0)
+            {
+                state->txState = TX_LINE_START;
+                if (state->writeLink)
+                {
+                    state->linkWriteReply = state->writeLen;
+                }
+            }
+            break;
+
+        case TX_WRITE:
+            break;
+        }
+    }
+
+    if ((tRes == TRANSPORT_SUCCESS)
+        && (state->txState != TX_MATCHING) && (state->txState != TX_HOLDING))
+    {
+        tRes = sendBytes(state, flags, data + run, len - run, limit);
+    }
+    return tRes;
+}
+
+/**
+ * Register a callback function that will be called when this transport
+ * has data to send to its next outermost ThingstreamTransport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param callback the callback function
+ * @param cookie a opaque value passed to the callback function
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_socket_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie)
+{
+    ModemSocketState* state = (ModemSocketState*)self->_state;
+    state->callback = callback;
+    state->cookie = cookie;
+    return TRANSPORT_SUCCESS;
+}
+
+/**
+ * Allow the transport instance to run for at most the given number of
+ * milliseconds. The responses to commands answered in transparent mode or
+ * while no data was waiting are passed to the modem transport first.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param millis the maximum number of milliseconds to run (a value of zero
+ *        processes all pending operations).
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_socket_run(ThingstreamTransport* self, uint32_t millis)
+{
+    ModemSocketState* state = (ModemSocketState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+
+    if (state->linkPrompt)
+    {
+        uint8_t prompt = (uint8_t)state->dialect->prompt;
+        state->linkPrompt = false;
+        state->writePromptSeen = true;
+        deliver(state, &prompt, 1);
+    }
+    if (state->linkWriteReply > 0)
+    {
+        linkWriteResponse(state);
+    }
+    if (state->linkReadReply > 0)
+    {
+        linkReadResponse(state);
+    }
+    if (state->readReply != NULL)
+    {
+        readResponse(state);
+    }
+    return inner->run(inner, millis);
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief ThingstreamTransport implementation that sits between the modem
+ * transport and the modem hardware, holding back socket reads until the
+ * modem announces data, and providing application sockets and transparent
+ * mode.
+ */
+
+#ifndef INC_MODEM_SOCKET_TRANSPORT_H
+#define INC_MODEM_SOCKET_TRANSPORT_H
+
+#include "transport_api.h"
+#include "modem_transport.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * Recommended buffer size for Thingstream_createModemSocketTransport().
+ * The buffer holds a socket command line until it ends, and each read made
+ * for an application socket, so it also limits the size of the datagrams
+ * read for application sockets.
+ * @hideinitializer
+ */
+#ifndef MODEM_SOCKET_BUFFER_LEN
+#define MODEM_SOCKET_BUFFER_LEN 256
+#endif
+
+/**
+ * The maximum number of application sockets that can be opened with
+ * Thingstream_ModemSocket_open().
+ * @hideinitializer
+ */
+#ifndef MODEM_SOCKET_MAX_SOCKETS
+#define MODEM_SOCKET_MAX_SOCKETS 2
+#endif
+
+/**
+ * The function type of the callback for datagrams received on an
+ * application socket. It is called from Thingstream_ModemSocket_service().
+ *
+ * @param cookie the cookie passed to Thingstream_ModemSocket_open()
+ * @param data the datagram, or NULL if the modem has closed the socket
+ * @param len the length of the datagram, or zero if the socket is closed
+ */
+typedef void (*ThingstreamModemSocketCallback)(void* cookie, uint8_t* data, uint16_t len);
+
+/**
+ * Create an instance of the modem socket transport.
+ *
+ * This transport is placed between the serial (or ring buffer) transport and
+ * the modem transport. It watches the AT socket commands issued by the modem
+ * configuration. The u-blox, Quectel and SimCom configurations already write
+ * socket payloads in binary, after the modem's prompt:
+ *
+ * * u-blox: AT+USOST=s,"ip",port,len then the payload after '@'
+ * * Quectel: AT+QISEND=id,len then the payload after '>'
+ * * SimCom SIM7070/SIM7080: AT+CASEND=id,len then the payload after '>'
+ *
+ * so writes are passed through unchanged. The length announced by the write
+ * command is used to pass exactly that many payload bytes through, so that a
+ * payload is never mistaken for a command. The traffic of all other modems
+ * is passed through untouched; the dialect is selected automatically from
+ * the udpConfigInit routine.
+ *
+ * On the u-blox, Quectel and SimCom modems, the socket reads that the
+ * modem transport issues while it waits for a response are also held back
+ * until the modem announces received data with its URC (+UUSORF,
+ * +QIURC: "recv" or +CADATAIND), and are then passed on until a read
+ * response reports that no data is left. A read made while no data is
+ * waiting is answered with the modem's own "no data" response without any
+ * serial traffic, and on u-blox modems a read is limited to the announced length.
+ * A read is still passed on at least every #MODEM_SOCKET_READ_POLL_MS in
+ * case an announcement is missed.
+ *
+ * @param inner the inner #ThingstreamTransport instance to use
+ * @param udpConfigInit the modem initialisation routine that will be passed
+ *   to Thingstream_createModemTransport()
+ * @param buffer a buffer to hold a socket command line and application
+ *   socket reads
+ * @param bufSize the size of the buffer, we suggest #MODEM_SOCKET_BUFFER_LEN
+ * @return the #ThingstreamTransport instance
+ */
+extern ThingstreamTransport* Thingstream_createModemSocketTransport(ThingstreamTransport* inner, ThingstreamModemUdpInit udpConfigInit, uint8_t* buffer, uint16_t bufSize);
+
+/**
+ * Open an application UDP socket alongside the socket used by the modem
+ * transport, e.g. for an NTP server or a second upload endpoint.
+ *
+ * Application sockets are supported on u-blox modems. They can only be
+ * used once the modem transport has initialised the modem, and are closed
+ * (the callback is called with a zero length) if the modem is initialised
+ * again.
+ *
+ * This and the other application socket routines issue AT commands, so
+ * they must be called from the application's main loop and not from
+ * within a Thingstream SDK callback.
+ *
+ * @param self this instance of modem socket transport
+ * @param address the remote IP address, the string must remain valid
+ *   until the socket is closed
+ * @param port the remote port
+ * @param queue a buffer to queue outgoing datagrams, each needs its length
+ *   plus two bytes
+ * @param queueSize the size of the queue
+ * @param callback the function to receive datagrams
+ * @param cookie an opaque value passed to the callback
+ * @param millis the maximum number of milliseconds to wait for the modem
+ * @return a socket handle (zero or above) or a negative
+ *   #ThingstreamTransportResult status code
+ */
+extern int16_t Thingstream_ModemSocket_open(ThingstreamTransport* self, const char* address, uint16_t port, uint8_t* queue, uint16_t queueSize, ThingstreamModemSocketCallback callback, void* cookie, uint32_t millis);
+
+/**
+ * Queue a datagram on an application socket. It is sent by the next call
+ * to Thingstream_ModemSocket_service().
+ *
+ * @param self this instance of modem socket transport
+ * @param handle the handle returned by Thingstream_ModemSocket_open()
+ * @param data the datagram
+ * @param len the length of the datagram
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+extern ThingstreamTransportResult Thingstream_ModemSocket_send(ThingstreamTransport* self, int16_t handle, const uint8_t* data, uint16_t len);
+
+/**
+ * Send the queued datagrams and read the datagrams that the modem has
+ * announced on the application sockets, passing them to the callbacks.
+ *
+ * @param self this instance of modem socket transport
+ * @param millis the maximum number of milliseconds to run
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+extern ThingstreamTransportResult Thingstream_ModemSocket_service(ThingstreamTransport* self, uint32_t millis);
+
+/**
+ * Close an application socket, discarding any queued datagrams.
+ *
+ * @param self this instance of modem socket transport
+ * @param handle the handle returned by Thingstream_ModemSocket_open()
+ * @param millis the maximum number of milliseconds to wait for the modem
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+extern ThingstreamTransportResult Thingstream_ModemSocket_close(ThingstreamTransport* self, int16_t handle, uint32_t millis);
+
+/**
+ * Enable or disable transparent (direct link) mode for the socket used by
+ * the modem transport.
+ *
+ * When enabled, the next socket write issued by the modem transport
+ * (AT+USOST=socket,"address",port,length) connects its UDP socket to the
+ * server and switches the modem to transparent mode (u-blox AT+USODL).
+ * From then on each write is answered here with the '@' prompt, the
+ * payload that follows it is written to the serial line as is, without an
+ * AT command, and the expected write response is returned to the modem
+ * transport. Received
+ * bytes are split into datagrams using the MQTT-SN length header and
+ * presented to the modem transport as the usual data URC and read
+ * response.
+ *
+ * Any other AT command, including one sent with
+ * Thingstream_Modem_sendLine() or by the application socket routines,
+ * switches the modem back to command mode with the "+++" escape sequence
+ * first (with #MODEM_SOCKET_ESCAPE_GUARD_MS of silence either side), and
+ * the next socket write switches to transparent mode again. Transparent
+ * mode therefore suits connected sessions in which the modem transport
+ * exchanges many datagrams between status queries.
+ *
+ * Transparent mode is supported on u-blox modems. If the modem refuses to
+ * enter transparent mode, it is disabled until this is called again.
+ * Received data not yet read by the modem transport when the modem leaves
+ * transparent mode is lost, as any UDP datagram may be.
+ *
+ * @param self this instance of modem socket transport
+ * @param buffer a buffer for received datagrams, or NULL to disable
+ *   transparent mode; we suggest #MODEM_UDP_BUFFER_LEN bytes
+ * @param bufSize the size of the buffer
+ * @param millis the maximum number of milliseconds to wait for the modem
+ *   if it has to leave transparent mode
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+extern ThingstreamTransportResult Thingstream_ModemSocket_setTransparent(ThingstreamTransport* self, uint8_t* buffer, uint16_t bufSize, uint32_t millis);
+
+/**
+ * The silence needed before and after the "+++" escape sequence that
+ * returns the modem from transparent mode to command mode.
+ * @hideinitializer
+ */
+#ifndef MODEM_SOCKET_ESCAPE_GUARD_MS
+#define MODEM_SOCKET_ESCAPE_GUARD_MS 1000
+#endif
+
+/**
+ * The longest time that socket reads issued by the modem transport are
+ * answered locally while the modem has not announced any received data.
+ * @hideinitializer
+ */
+#ifndef MODEM_SOCKET_READ_POLL_MS
+#define MODEM_SOCKET_READ_POLL_MS 5000
+#endif
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_MODEM_SOCKET_TRANSPORT_H */
@@ -0,0 +1,652 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Health and error statistics from the modem traffic
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "modem_stats_transport.h"
+#include "modem_transport.h"
+#include "client_platform.h"
+#include "thingstream_util.h"
+
+/** The space for a line of modem output, enough for the reports parsed */
+#define STATS_LINE_LEN      48
+
+/** The upper limit of the first latency bucket, in milliseconds */
+#define LATENCY_FIRST_MS    16
+
+/** The registration reports, for circuit, packet and EPS domains */
+static const char* const registrationReports[] = {
+    "+CREG: ",
+    "+CGREG: ",
+    "+CEREG: ",
+};
+
+/** The commands that open a UDP socket, for each modem family */
+static const char* const socketOpenCommands[] = {
+    "AT+USOCR",
+    "AT+QIOPEN",
+    "AT+CAOPEN",
+    "AT+CIPOPEN",
+    "AT+CIPSTART",
+    "AT^SISO",
+};
+
+#define ARRAY_LEN(a) (sizeof(a) / sizeof((a)[0]))
+
+/**
+ * The ModemStatsState structure is used to store state for the modem stats
+ * transport.
+ */
+typedef struct ModemStatsState_s
+{
+    /** The inner transport */
+    ThingstreamTransport* inner;
+    /** The callback registered by the outer transport */
+    ThingstreamTransportCallback_t callback;
+    /** Cookie associated with the registered callback */
+    void* cookie;
+    /** The statistics */
+    ThingstreamModemStats stats;
+    /** The time the current state was entered */
+    uint32_t stateSince;
+    /** The time the modem was last seen unregistered */
+    uint32_t searchingSince;
+    /** A command is waiting for its final result */
+    bool pending;
+    /** The pending command is the forced reset */
+    bool pendingReset;
+    /** The index in stats.commands of the pending command, or
+     * MODEM_STATS_COMMANDS if it is untracked */
+    uint8_t pendingIndex;
+    /** The time the pending command was sent */
+    uint32_t sentAt;
+    /** A socket has been opened since the transport was initialised */
+    bool socketOpened;
+    /** The number of bytes in txLine, or zero outside a command */
+    uint8_t txLen;
+    /** The command being sent */
+    char txLine[MODEM_STATS_COMMAND_LEN + 1];
+    /** The command being sent is longer than txLine */
+    bool txLong;
+    /** The number of bytes in rxLine */
+    uint8_t rxLen;
+    /** The current line of modem output */
+    char rxLine[STATS_LINE_LEN];
+} ModemStatsState;
+
+/** Instance of ModemStatsState */
+static ModemStatsState _modem_stats_transport_state;
+
+static ThingstreamTransportResult modem_stats_init(ThingstreamTransport* self, uint16_t version);
+static ThingstreamTransportResult modem_stats_shutdown(ThingstreamTransport* self);
+static ThingstreamTransportResult modem_stats_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len);
+static ThingstreamTransportResult modem_stats_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis);
+static ThingstreamTransportResult modem_stats_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie);
+static ThingstreamTransportResult modem_stats_run(ThingstreamTransport* self, uint32_t millis);
+
+/** Instance of ThingstreamTransport for the modem stats transport */
+static const ThingstreamTransport _modem_stats_transport_instance = {
+    (ThingstreamTransportState_t*)&_modem_stats_transport_state,
+    modem_stats_init,
+    modem_stats_shutdown,
+    modem_stats_get_buffer,
+    NULL, /* This slot no longer used */
+    modem_stats_send,
+    modem_stats_register_callback,
+    NULL, /* This slot no longer used */
+    modem_stats_run
+};
+
+
+ThingstreamTransport* Thingstream_createModemStatsTransport(ThingstreamTransport* inner)
+{
+    ThingstreamTransport* self = (ThingstreamTransport*)&_modem_stats_transport_instance;
+    ModemStatsState* state = (ModemStatsState*)self->_state;
+
+    if (inner == NULL)
+    {
+        return NULL;
+    }
+    memset(state, 0, sizeof(*state));
+    state->inner = inner;
+    state->stats.state = MODEM_STATS_SEARCHING;
+    state->stateSince = Thingstream_Platform_getTimeMillis();
+    state->searchingSince = state->stateSince;
+    return self;
+}
+
+
+void Thingstream_ModemStats_get(ThingstreamTransport* self, ThingstreamTransport* modem, ThingstreamModemStats* stats)
+{
+    ModemStatsState* state = (ModemStatsState*)self->_state;
+    *stats = state->stats;
+    stats->stateMs[stats->state] += Thingstream_Platform_getTimeMillis() - state->stateSince;
+    if (modem != NULL)
+    {
+        stats->cusdErrors = Thingstream_Modem_getCUSDErrors(modem, 0);
+        stats->seriousErrors = Thingstream_Modem_getSeriousErrors(modem, 0);
+    }
+}
+
+
+void Thingstream_ModemStats_reset(ThingstreamTransport* self, ThingstreamTransport* modem)
+{
+    ModemStatsState* state = (ModemStatsState*)self->_state;
+    ThingstreamModemStatsState current = state->stats.state;
+    memset(&state->stats, 0, sizeof(state->stats));
+    state->stats.state = current;
+    state->stateSince = Thingstream_Platform_getTimeMillis();
+    state->pendingIndex = MODEM_STATS_COMMANDS;
+    if (modem != NULL)
+    {
+        (void)Thingstream_Modem_getCUSDErrors(modem, 1);
+        (void)Thingstream_Modem_getSeriousErrors(modem, 1);
+    }
+}
+
+
+/**
+ * Return true if the text starts with the prefix.
+ */
+static bool startsWith(const char* text, uint16_t len, const char* prefix)
+{
+    uint16_t prefixLen = (uint16_t)strlen(prefix);
+    return (len >= prefixLen) && (memcmp(text, prefix, prefixLen) == 0);
+}
+
+/**
+ * Move to a new state, adding the time spent in the old one.
+ *
+ * @param state the modem stats state
+ * @param next the new state
+ * @param now the current time
+ */
+static void setState(ModemStatsState* state, ThingstreamModemStatsState next, uint32_t now)
+{
+    ThingstreamModemStats* stats = &state->stats;
+    if (stats->state == next)
+    {
+        return;
+    }
+    stats->stateMs[stats->state] += now - state->stateSince;
+    state->stateSince = now;
+    if (next == MODEM_STATS_REGISTERED)
+    {
+        uint32_t took = now - state->searchingSince;
+        stats->registrations++;
+        stats->lastRegistrationMs = took;
+        if (took > stats->maxRegistrationMs)
+        {
+            stats->maxRegistrationMs = took;
+        }
+    }
+    else if (stats->state == MODEM_STATS_REGISTERED)
+    {
+        state->searchingSince = now;
+    }
+    stats->state = next;
+}
+
+/**
+ * Return true if the command is the first line of the forced reset string.
+ */
+static bool isForcedReset(const char* command, uint16_t len)
+{
+    const char* reset = Thingstream_Modem_forceResetString;
+    const char* end;
+    if (*reset == '?')
+    {
+        ++reset;
+    }
+    end = strchr(reset, '\n');
+    if (end == NULL)
+    {
+        end = reset + strlen(reset);
+    }
+    return (len == (uint16_t)(end - reset)) && (memcmp(command, reset, len) == 0);
+}
+
+/**
+ * Record an AT command sent to the modem.
+ *
+ * @param state the modem stats state
+ * @param now the current time
+ */
+static void commandSent(ModemStatsState* state, uint32_t now)
+{
+    ThingstreamModemStats* stats = &state->stats;
+    const char* line = state->txLine;
+    uint16_t len = state->txLen;
+    uint8_t nameLen = 0;
+    uint8_t i;
+
+    if (state->pending && (state->pendingIndex < MODEM_STATS_COMMANDS))
+    {
+        stats->commands[state->pendingIndex].noReply++;
+    }
+
+    /* The command name stops at its parameters or query */
+    while ((nameLen < len) && (line[nameLen] != '=') && (line[nameLen] != '?')
+           && (line[nameLen] != ';'))
+    {
+        ++nameLen;
+    }
+    for (i = 0; i < stats->commandCount; ++i)
+    {
+        if ((strlen(stats->commands[i].name) == nameLen)
+            && (memcmp(stats->commands[i].name, line, nameLen) == 0))
+        {
+            break;
+        }
+    }
+    if ((i == stats->commandCount) && (i < MODEM_STATS_COMMANDS))
+    {
+        memcpy(stats->commands[i].name, line, nameLen);
+        stats->commands[i].name[nameLen] = '\0';
+        stats->commandCount++;
+    }
+    if (i < MODEM_STATS_COMMANDS)
+    {
+        stats->commands[i].count++;
+    }
+    else
+    {
+        stats->commandsUntracked++;
+    }
+
+    state->pending = true;
+    state->pendingIndex = i;
+    state->sentAt = now;
+    state->pendingReset = !state->txLong && isForcedReset(line, len);
+    if (state->pendingReset)
+    {
+        stats->forcedResets++;
+        setState(state, MODEM_STATS_RESETTING, now);
+    }
+
+    for (i = 0; i < ARRAY_LEN(socketOpenCommands); ++i)
+    {
+        if (startsWith(line, len, socketOpenCommands[i]))
+        {
+            stats->socketOpens++;
+            if (state->socketOpened)
+            {
+                stats->socketReopens++;
+            }
+            state->socketOpened = true;
+            break;
+        }
+    }
+}
+
+/**
+ * Record the final result of the pending command.
+ *
+ * @param state the modem stats state
+ * @param error true if the result was an error
+ * @param now the current time
+ */
+static void commandDone(ModemStatsState* state, bool error, uint32_t now)
+{
+    if (!state->pending)
+    {
+        return;
+    }
+    state->pending = false;
+    if (state->pendingIndex < MODEM_STATS_COMMANDS)
+    {
+        ThingstreamModemCommandStats* command = &state->stats.commands[state->pendingIndex];
+        uint32_t took = now - state->sentAt;
+        uint32_t limit = LATENCY_FIRST_MS;
+        uint8_t bucket = 0;
+        while ((bucket < MODEM_STATS_LATENCY_BUCKETS - 1) && (took >= limit))
+        {
+            limit <<= 2;
+            ++bucket;
+        }
+        command->latency[bucket]++;
+        if (took > command->maxMs)
+        {
+            command->maxMs = took;
+        }
+        if (error)
+        {
+            command->errors++;
+        }
+    }
+
+    /* The first answer to a later command shows the modem has restarted */
+    if (!state->pendingReset && !error && (state->stats.state == MODEM_STATS_RESETTING))
+    {
+        setState(state, MODEM_STATS_SEARCHING, now);
+    }
+}
+
+/**
+ * Count a +CME ERROR code, keeping the table in order of frequency.
+ *
+ * @param stats the statistics
+ * @param code the error code
+ */
+static void countCmeError(ThingstreamModemStats* stats, uint16_t code)
+{
+    uint8_t i;
+    for (i = 0; i < stats->cmeCount; ++i)
+    {
+        if (stats->cmeErrors[i].code == code)
+        {
+            break;
+        }
+    }
+    if (i == stats->cmeCount)
+    {
+        if (i == MODEM_STATS_CME_CODES)
+        {
+            stats->cmeUntracked++;
+            return;
+        }
+        stats->cmeErrors[i].code = code;
+        stats->cmeErrors[i].count = 0;
+        stats->cmeCount++;
+    }
+    stats->cmeErrors[i].count++;
+    while ((i > 0) && (stats->cmeErrors[i].count > stats->cmeErrors[i - 1].count))
+    {
+        ThingstreamModemCmeStats swap = stats->cmeErrors[i - 1];
+        stats->cmeErrors[i - 1] = stats->cmeErrors[i];
+        stats->cmeErrors[i] = swap;
+        --i;
+    }
+}
+
+/**
+ * Check a registration report for the registration state, in a solicited
+ * report (+CEREG: n,stat...) or an unsolicited one (+CEREG: stat...).
+ *
+ * @param state the modem stats state
+ * @param p the report's parameters
+ * @param end the end of the report
+ * @param now the current time
+ */
+static void registrationReport(ModemStatsState* state, const char* p, const char* end, uint32_t now)
+{
+    const char* second = memchr(p, ',', (size_t)(end - p));
+    uint32_t stat;
+
+    /* In the unsolicited report the second parameter is the quoted area */
+    if ((second != NULL) && (second + 1 < end) && (second[1] >= '0') && (second[1] <= '9'))
+    {
+        p = second + 1;
+    }
+    stat = Thingstream_Util_parseUInt(p, end, NULL);
+    if ((stat == 1) || (stat == 5))
+    {
+        setState(state, MODEM_STATS_REGISTERED, now);
+    }
+    else if (state->stats.state == MODEM_STATS_REGISTERED)
+    {
+        setState(state, MODEM_STATS_SEARCHING, now);
+    }
+}
+
+/**
+ * Handle a complete line of modem output.
+ *
+ * @param state the modem stats state
+ */
+static void outputLine(ModemStatsState* state)
+{
+    const char* line = state->rxLine;
+    uint16_t len = state->rxLen;
+    const char* end = line + len;
+    uint32_t now = Thingstream_Platform_getTimeMillis();
+    uint8_t i;
+
+    if ((len == 2) && (memcmp(line, "OK", 2) == 0))
+    {
+        commandDone(state, false, now);
+    }
+    else if (startsWith(line, len, "CONNECT"))
+    {
+        commandDone(state, false, now);
+    }
+    else if (((len == 5) && (memcmp(line, "ERROR", 5) == 0))
+             || startsWith(line, len, "NO CARRIER"))
+    {
+        commandDone(state, true, now);
+    }
+    else if (startsWith(line, len, "+CME ERROR:"))
+    {
+        const char* p = line + strlen("+CME ERROR:");
+        const char* number;
+        while ((p < end) && (*p == ' '))
+        {
+            ++p;
+        }
+        number = p;
+        uint32_t code = Thingstream_Util_parseUInt(number, end, &p);
+        countCmeError(&state->stats,
+                      ((p == number) || (p != end) || (code >= MODEM_STATS_CME_TEXT))
+                      ? MODEM_STATS_CME_TEXT : (uint16_t)code);
+        commandDone(state, true, now);
+    }
+    else if (startsWith(line, len, "+CMS ERROR:"))
+    {
+        state->stats.cmsErrors++;
+        commandDone(state, true, now);
+    }
+    else
+    {
+        for (i = 0; i < ARRAY_LEN(registrationReports); ++i)
+        {
+            if (startsWith(line, len, registrationReports[i]))
+            {
+                registrationReport(state, line + strlen(registrationReports[i]), end, now);
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * Callback from the inner transport with modem output.
+ *
+ * @param cookie the modem stats state
+ * @param data the modem output
+ * @param len the length of the modem output
+ */
+static void modem_stats_callback(void* cookie, uint8_t* data, uint16_t len)
+{
+    ModemStatsState* state = (ModemStatsState*)cookie;
+    uint16_t i;
+
+    state->stats.bytesIn += len;
+    for (i = 0; i < len; ++i)
+    {
+        char ch = (char)data[i];
+        if ((ch == '\r') || (ch == '\n'))
+        {
+            if (state->rxLen > 0)
+            {
+                outputLine(state);
+                state->rxLen = 0;
+            }
+        }
+        else if (state->rxLen < sizeof(state->rxLine))
+        {
+            state->rxLine[state->rxLen++] = ch;
+        }
+    }
+    if (state->callback != NULL)
+    {
+        state->callback(state->cookie, data, len);
+    }
+}
+
+/**
+ * Initialize the transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param version the transport API version
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_stats_init(ThingstreamTransport* self, uint16_t version)
+{
+    ModemStatsState* state = (ModemStatsState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+
+    if (!TRANSPORT_CHECK_VERSION_1(version))
+    {
+        return TRANSPORT_VERSION_MISMATCH;
+    }
+    state->pending = false;
+    state->socketOpened = false;
+    state->txLen = 0;
+    state->rxLen = 0;
+
+    ThingstreamTransportResult tRes;
+    tRes = inner->register_callback(inner, modem_stats_callback, state);
+    if (tRes == TRANSPORT_SUCCESS)
+    {
+        tRes = inner->init(inner, version);
+    }
+    return tRes;
+}
+
+/**
+ * Shutdown the transport (i.e. the opposite of initialize)
+ *
+ * @param self the #ThingstreamTransport instance
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_stats_shutdown(ThingstreamTransport* self)
+{
+    ModemStatsState* state = (ModemStatsState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    return inner->shutdown(inner);
+}
+
+/**
+ * Pass the buffer request to the inner transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param buffer where to write the buffer pointer
+ * @param len where the write the buffer length
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_stats_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len)
+{
+    ModemStatsState* state = (ModemStatsState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    if (inner->get_buffer == NULL)
+    {
+        return TRANSPORT_ERROR;
+    }
+    return inner->get_buffer(inner, buffer, len);
+}
+
+/**
+ * Send the data to the inner transport, noting the AT commands in it.
+ * Data that does not start with AT (e.g. a binary socket payload) is only
+ * counted.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param flags an indication of the type of the data, zero is normal.
+ * @param data a pointer to the data
+ * @param len the length of the raw data
+ * @param millis the maximum number of milliseconds to run
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_stats_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis)
+{
+    ModemStatsState* state = (ModemStatsState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    uint16_t i = 0;
+
+    state->stats.bytesOut += len;
+    if ((state->txLen == 0) && !state->txLong)
+    {
+        if ((len < 2) || (((data[0] | 0x20) != 'a') || ((data[1] | 0x20) != 't')))
+        {
+            i = len;
+        }
+    }
+    for (; i < len; ++i)
+    {
+        char ch = (char)data[i];
+        if ((ch == '\r') || (ch == '\n'))
+        {
+            if (state->txLen > 0)
+            {
+                commandSent(state, Thingstream_Platform_getTimeMillis());
+            }
+            state->txLen = 0;
+            state->txLong = false;
+
+            /* Anything after the command is data for it */
+            break;
+        }
+        else if (state->txLen < MODEM_STATS_COMMAND_LEN)
+        {
+            state->txLine[state->txLen++] = ch;
+        }
+        else
+        {
+            state->txLong = true;
+        }
+    }
+    return inner->send(inner, flags, data, len, millis);
+}
+
+/**
+ * Register a callback function that will be called when this transport
+ * has data to send to its next outermost ThingstreamTransport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param callback the callback function
+ * @param cookie a opaque value passed to the callback function
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_stats_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie)
+{
+    ModemStatsState* state = (ModemStatsState*)self->_state;
+    state->callback = callback;
+    state->cookie = cookie;
+    return TRANSPORT_SUCCESS;
+}
+
+/**
+ * Allow the inner transport to run for at most the given number of
+ * milliseconds.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param millis the maximum number of milliseconds to run (a value of zero
+ *        processes all pending operations).
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult modem_stats_run(ThingstreamTransport* self, uint32_t millis)
+{
+    ModemStatsState* state = (ModemStatsState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    return inner->run(inner, millis);
+}
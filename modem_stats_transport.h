@@ -0,0 +1,212 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief ThingstreamTransport implementation that gathers health and error
+ * statistics from the traffic between the modem transport and the modem.
+ */
+
+#ifndef INC_MODEM_STATS_TRANSPORT_H
+#define INC_MODEM_STATS_TRANSPORT_H
+
+#include <stdint.h>
+
+#include "transport_api.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * The number of different AT commands for which latency is recorded.
+ * Commands seen once the table is full are only counted in
+ * ThingstreamModemStats.commandsUntracked.
+ * @hideinitializer
+ */
+#ifndef MODEM_STATS_COMMANDS
+#define MODEM_STATS_COMMANDS 12
+#endif
+
+/**
+ * The number of different +CME ERROR codes that are counted.
+ * @hideinitializer
+ */
+#ifndef MODEM_STATS_CME_CODES
+#define MODEM_STATS_CME_CODES 8
+#endif
+
+/**
+ * The longest command name recorded, e.g. "AT+USOST".
+ * @hideinitializer
+ */
+#define MODEM_STATS_COMMAND_LEN 12
+
+/**
+ * The number of buckets in each latency histogram. Bucket i counts the
+ * replies that took less than 16 * 4^i milliseconds (16ms, 64ms, 256ms ...
+ * 65.5s), the last bucket counts the longer ones.
+ * @hideinitializer
+ */
+#define MODEM_STATS_LATENCY_BUCKETS 8
+
+/**
+ * The code recorded for a +CME ERROR reported as text (AT+CMEE=2) rather
+ * than as a number.
+ * @hideinitializer
+ */
+#define MODEM_STATS_CME_TEXT 0xFFFF
+
+/**
+ * The states of the modem, as seen in its traffic.
+ */
+typedef enum ThingstreamModemStatsState_e
+{
+    /** The modem is not registered with a network */
+    MODEM_STATS_SEARCHING,
+    /** The modem is registered with a network */
+    MODEM_STATS_REGISTERED,
+    /** The modem transport has forced a reset and the modem has yet to
+     * answer again */
+    MODEM_STATS_RESETTING,
+    /** The number of states */
+    MODEM_STATS_STATES
+} ThingstreamModemStatsState;
+
+/**
+ * The replies to one AT command.
+ */
+typedef struct ThingstreamModemCommandStats_s
+{
+    /** The command, e.g. "AT+CSQ", null-terminated */
+    char name[MODEM_STATS_COMMAND_LEN + 1];
+    /** The number of times the command was sent */
+    uint32_t count;
+    /** The number of replies that were ERROR, +CME ERROR or +CMS ERROR */
+    uint32_t errors;
+    /** The number of times the command had no reply before the next
+     * command was sent */
+    uint32_t noReply;
+    /** The longest reply time, in milliseconds */
+    uint32_t maxMs;
+    /** The histogram of reply times */
+    uint32_t latency[MODEM_STATS_LATENCY_BUCKETS];
+} ThingstreamModemCommandStats;
+
+/**
+ * The number of times one +CME ERROR code was reported.
+ */
+typedef struct ThingstreamModemCmeStats_s
+{
+    /** The error code, or #MODEM_STATS_CME_TEXT */
+    uint16_t code;
+    /** The number of times it was reported */
+    uint32_t count;
+} ThingstreamModemCmeStats;
+
+/**
+ * The statistics gathered by the modem stats transport.
+ */
+typedef struct ThingstreamModemStats_s
+{
+    /** The AT commands sent, in the order first seen */
+    ThingstreamModemCommandStats commands[MODEM_STATS_COMMANDS];
+    /** The number of entries used in commands */
+    uint8_t commandCount;
+    /** The number of commands sent once the commands table was full */
+    uint32_t commandsUntracked;
+    /** The +CME ERROR codes reported, most frequent first */
+    ThingstreamModemCmeStats cmeErrors[MODEM_STATS_CME_CODES];
+    /** The number of entries used in cmeErrors */
+    uint8_t cmeCount;
+    /** The number of +CME ERROR reports once the cmeErrors table was full */
+    uint32_t cmeUntracked;
+    /** The number of +CMS ERROR reports */
+    uint32_t cmsErrors;
+    /** The number of resets forced by the modem transport (each of which
+     * it reports as #TRANSPORT_MODEM_FORCED_RESET) */
+    uint32_t forcedResets;
+    /** The number of times the modem registered with a network */
+    uint32_t registrations;
+    /** The time the latest registration took, in milliseconds */
+    uint32_t lastRegistrationMs;
+    /** The longest time a registration took, in milliseconds */
+    uint32_t maxRegistrationMs;
+    /** The number of UDP sockets opened */
+    uint32_t socketOpens;
+    /** The number of UDP sockets opened after the first since the
+     * transport was initialised */
+    uint32_t socketReopens;
+    /** The number of bytes sent to the modem */
+    uint32_t bytesOut;
+    /** The number of bytes received from the modem */
+    uint32_t bytesIn;
+    /** The time spent in each state, in milliseconds */
+    uint32_t stateMs[MODEM_STATS_STATES];
+    /** The current state */
+    ThingstreamModemStatsState state;
+    /** The +CUSD: errors counted by the modem transport, see
+     * Thingstream_Modem_getCUSDErrors() */
+    uint32_t cusdErrors;
+    /** The serious errors counted by the modem transport, see
+     * Thingstream_Modem_getSeriousErrors() */
+    uint32_t seriousErrors;
+} ThingstreamModemStats;
+
+/**
+ * Create an instance of the modem stats transport, which passes all data
+ * unchanged and gathers statistics from the AT commands sent to the modem
+ * and the modem's replies.
+ *
+ * It should be placed directly below the modem transport (or the modem
+ * socket transport, if used), so that it sees the traffic the modem really
+ * handles, and above the ring buffer
+ * transport, so that it is not called from an interrupt handler.
+ * The cost is a few comparisons per line and no time is spent while the
+ * modem is idle, so it can be left in production builds.
+ *
+ * @param inner the inner #ThingstreamTransport instance to use
+ * @return the #ThingstreamTransport instance
+ */
+extern ThingstreamTransport* Thingstream_createModemStatsTransport(ThingstreamTransport* inner);
+
+/**
+ * Copy the statistics gathered since the transport was created or
+ * Thingstream_ModemStats_reset() was called.
+ *
+ * @param self this instance of modem stats transport
+ * @param modem the modem transport instance, whose own error counts are
+ *   included, or NULL
+ * @param stats where to copy the statistics
+ */
+extern void Thingstream_ModemStats_get(ThingstreamTransport* self, ThingstreamTransport* modem, ThingstreamModemStats* stats);
+
+/**
+ * Clear the statistics. The current state is kept.
+ *
+ * @param self this instance of modem stats transport
+ * @param modem the modem transport instance, whose own error counts are
+ *   also cleared, or NULL
+ */
+extern void Thingstream_ModemStats_reset(ThingstreamTransport* self, ThingstreamTransport* modem);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_MODEM_STATS_TRANSPORT_H */
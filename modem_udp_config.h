@@ -1,5 +1,5 @@
 /*
- * Copyright 2020-2022 Thingstream AG
+ * Copyright 2020-2022, 2026 Thingstream AG
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,6 +17,10 @@
 /**
  * @file
  * @brief Configuration files for modems with UDP support in the Thingstream SDK
+ *
+ * These configurations open their sockets to the Thingstream UDP server by
+ * its IP address, which is selected from the APN, so no DNS lookup is made
+ * when the socket is opened (Quectel modems are told so with AT+QIDNSIP=0).
  */
 
 #ifndef INC_MODEM_UDP_CONFIG_H
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Default platform hooks to count processor cycles for benchmarks
+ */
+
+#include "platform_cycles.h"
+
+/* Cortex-M3/M4/M7 data watchpoint and trace unit registers */
+#define DEMCR         (*(volatile uint32_t*)0xE000EDFCu)
+#define DEMCR_TRCENA  (1u << 24)
+#define DWT_CTRL      (*(volatile uint32_t*)0xE0001000u)
+#define DWT_CYCCNTENA (1u << 0)
+#define DWT_CYCCNT    (*(volatile uint32_t*)0xE0001004u)
+
+/**
+ * Default implementation to start the cycle counter, using the DWT unit
+ * on Cortex-M3 and above.
+ *
+ * @return true if a cycle counter is available.
+ */
+__attribute__((weak))
+bool Platform_initCycleCounter(void)
+{
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+    DEMCR |= DEMCR_TRCENA;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CYCCNTENA;
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Default implementation to return the cycle count.
+ *
+ * @return the number of cycles since an arbitrary point.
+ */
+__attribute__((weak))
+uint32_t Platform_getCycleCount(void)
+{
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+    return DWT_CYCCNT;
+#else
+    return 0;
+#endif
+}
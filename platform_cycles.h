@@ -0,0 +1,53 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Platform hooks to count processor cycles for benchmarks
+ */
+
+#ifndef INC_PLATFORM_CYCLES_H_
+#define INC_PLATFORM_CYCLES_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * Start the processor cycle counter.
+ *
+ * @return true if a cycle counter is available.
+ */
+extern bool Platform_initCycleCounter(void);
+
+/**
+ * Return the processor cycle count. The count wraps at 2^32 so only the
+ * difference between two calls is meaningful.
+ *
+ * @return the number of cycles since an arbitrary point.
+ */
+extern uint32_t Platform_getCycleCount(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_PLATFORM_CYCLES_H_ */
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Default storage of small values, which stores nothing
+ *
+ * Override Platform_storageRead() and Platform_storageWrite() with an
+ * implementation using non-volatile storage to enable the features that
+ * keep values across reboots; see platform_storage.h.
+ */
+
+#include "platform_storage.h"
+
+/**
+ * Default implementation to read a stored value.
+ *
+ * @param key the key of the value
+ * @param data a buffer to receive the value
+ * @param len the size of the buffer
+ * @return 0, no value is ever stored.
+ */
+__attribute__((weak))
+uint16_t Platform_storageRead(uint16_t key, uint8_t *data, uint16_t len)
+{
+    (void)key;
+    (void)data;
+    (void)len;
+    return 0;
+}
+
+/**
+ * Default implementation to store a value.
+ *
+ * @param key the key of the value
+ * @param data the value
+ * @param len the length of the value
+ * @return false, unless len is zero (the value is removed).
+ */
+__attribute__((weak))
+bool Platform_storageWrite(uint16_t key, const uint8_t *data, uint16_t len)
+{
+    (void)key;
+    (void)data;
+    return (len == 0);
+}
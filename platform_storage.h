@@ -0,0 +1,86 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Platform hooks to keep small values across reboots
+ *
+ * The values must survive a power cycle, so they are kept in non-volatile
+ * storage. The default implementations in platform_storage.c store
+ * nothing, which leaves the features that use them (the saved modem model,
+ * operator and datagram sizes) disabled. Platforms with flash storage
+ * enable them by overriding both functions, for example using Nordic FDS
+ * with the key as the record key.
+ */
+
+#ifndef INC_PLATFORM_STORAGE_H_
+#define INC_PLATFORM_STORAGE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * @name Storage keys
+ * The keys used by the SDK extensions in this directory.
+ * @{
+ */
+/** The modem model chosen by Thingstream_ModemDetect_select() */
+#define PLATFORM_STORAGE_KEY_MODEM_MODEL    1
+/** The operator (plmn[,act]) last registered with, see
+ * Thingstream_ModemDetect_attach() */
+#define PLATFORM_STORAGE_KEY_MODEM_OPERATOR 2
+/** The datagram sizes found by Thingstream_ModemMtu_probe() */
+#define PLATFORM_STORAGE_KEY_MODEM_MTU      3
+/** @} */
+
+/**
+ * The largest value that an implementation must be able to store.
+ */
+#define PLATFORM_STORAGE_MAX_LEN            64
+
+/**
+ * Read a stored value.
+ *
+ * @param key the key of the value
+ * @param data a buffer to receive the value
+ * @param len the size of the buffer
+ * @return the length of the value, or 0 if no value is stored or it
+ *    does not fit in the buffer.
+ */
+extern uint16_t Platform_storageRead(uint16_t key, uint8_t *data, uint16_t len);
+
+/**
+ * Store a value, replacing any previous value for the key.
+ * A zero length removes the value.
+ *
+ * @param key the key of the value
+ * @param data the value
+ * @param len the length of the value
+ * @return true if the value has been stored.
+ */
+extern bool Platform_storageWrite(uint16_t key, const uint8_t *data, uint16_t len);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_PLATFORM_STORAGE_H_ */
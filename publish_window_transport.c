@@ -0,0 +1,478 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Windowed QoS 1 publishing implemented as a ThingstreamTransport
+ * instance
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "publish_window_transport.h"
+#include "client_platform.h"
+
+/** The MQTT-SN PUBLISH message type */
+#define MQTTSN_PUBLISH          0x0C
+
+/** The MQTT-SN PUBACK message type */
+#define MQTTSN_PUBACK           0x0D
+
+/** The MQTT-SN length byte that introduces a 3-byte length */
+#define MQTTSN_LONG_LENGTH      0x01
+
+/** The MQTT-SN flag of a PUBLISH that is sent again */
+#define FLAG_DUP                0x80
+
+/** The MQTT-SN flag of a QoS 1 PUBLISH */
+#define FLAG_QOS1               0x20
+
+/** The MQTT-SN flag of a PUBLISH to be retained */
+#define FLAG_RETAIN             0x10
+
+/** The length of a PUBLISH header with a 1-byte length */
+#define SHORT_PUBLISH_HEADER_LEN 7
+
+/** The length of a PUBLISH header with a 3-byte length */
+#define LONG_PUBLISH_HEADER_LEN 9
+
+/** The message ids used, the client uses smaller ones */
+#define MSG_ID_BASE             0x8000
+
+/** The time allowed for the inner transport to send a packet */
+#define SEND_MS                 5000
+
+/** The number of times a message is sent before it has timed out */
+#define MAX_SENDS               4
+
+/**
+ * A message waiting for its PUBACK.
+ */
+typedef struct WindowEntry_s
+{
+    /** The payload of the message */
+    const uint8_t* payload;
+    /** The time at which the message was last sent */
+    uint32_t sentAt;
+    /** The topic of the message */
+    ThingstreamTopic topic;
+    /** The length of the payload */
+    uint16_t len;
+    /** The message id, 0 if the entry is free */
+    uint16_t msgId;
+    /** The number of times the message has been sent */
+    uint8_t sends;
+    /** The message should be retained */
+    bool retained;
+} WindowEntry;
+
+/**
+ * The PublishWindowState structure is used to store state for the publish
+ * window transport.
+ */
+typedef struct PublishWindowState_s
+{
+    /** The inner transport */
+    ThingstreamTransport* inner;
+    /** The callback registered by the outer transport */
+    ThingstreamTransportCallback_t callback;
+    /** Cookie associated with the registered callback */
+    void* cookie;
+    /** The routine told the outcome of each message */
+    ThingstreamPublishWindowCallback_t done;
+    /** Cookie passed to the done routine */
+    void* doneCookie;
+    /** The time to wait for a PUBACK */
+    uint32_t retryMs;
+    /** The messages in flight */
+    WindowEntry entries[PUBLISH_WINDOW_MAX];
+    /** The number of entries in use */
+    uint8_t window;
+    /** The number of messages in flight */
+    uint8_t inFlight;
+    /** The id of the next message, less MSG_ID_BASE */
+    uint16_t nextId;
+} PublishWindowState;
+
+/** Instance of PublishWindowState */
+static PublishWindowState _publish_window_transport_state;
+
+static ThingstreamTransportResult publish_window_init(ThingstreamTransport* self, uint16_t version);
+static ThingstreamTransportResult publish_window_shutdown(ThingstreamTransport* self);
+static ThingstreamTransportResult publish_window_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len);
+static ThingstreamTransportResult publish_window_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis);
+static ThingstreamTransportResult publish_window_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie);
+static ThingstreamTransportResult publish_window_run(ThingstreamTransport* self, uint32_t millis);
+
+/** Instance of ThingstreamTransport for the publish window transport */
+static const ThingstreamTransport _publish_window_transport_instance = {
+    (ThingstreamTransportState_t*)&_publish_window_transport_state,
+    publish_window_init,
+    publish_window_shutdown,
+    publish_window_get_buffer,
+    NULL, /* This slot no longer used */
+    publish_window_send,
+    publish_window_register_callback,
+    NULL, /* This slot no longer used */
+    publish_window_run
+};
+
+
+ThingstreamTransport* Thingstream_createPublishWindowTransport(ThingstreamTransport* inner, uint8_t window, uint32_t retryMs, ThingstreamPublishWindowCallback_t callback, void* cookie)
+{
+    ThingstreamTransport* self = (ThingstreamTransport*)&_publish_window_transport_instance;
+    PublishWindowState* state = (PublishWindowState*)self->_state;
+
+    if ((inner == NULL) || (window == 0) || (window > PUBLISH_WINDOW_MAX)
+        || (callback == NULL))
+    {
+        return NULL;
+    }
+    memset(state, 0, sizeof(*state));
+    state->inner = inner;
+    state->window = window;
+    state->retryMs = retryMs;
+    state->done = callback;
+    state->doneCookie = cookie;
+    return self;
+}
+
+
+/**
+ * Build the PUBLISH packet for the entry in the inner transport's buffer
+ * and send it.
+ *
+ * @param state the publish window state
+ * @param entry the message to send
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult sendEntry(PublishWindowState* state, WindowEntry* entry)
+{
+    ThingstreamTransport* inner = state->inner;
+    ThingstreamTransportResult tRes;
+    uint8_t* buf;
+    uint16_t bufLen;
+    uint32_t packetLen;
+    uint8_t* p;
+
+    if (inner->get_buffer == NULL)
+    {
+        return TRANSPORT_ERROR;
+    }
+    tRes = inner->get_buffer(inner, &buf, &bufLen);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return tRes;
+    }
+    packetLen = SHORT_PUBLISH_HEADER_LEN + (uint32_t)entry->len;
+    if (packetLen > 0xFF)
+    {
+        packetLen = LONG_PUBLISH_HEADER_LEN + (uint32_t)entry->len;
+    }
+    if ((packetLen > bufLen) || (packetLen > 0xFFFF))
+    {
+        return TRANSPORT_ILLEGAL_ARGUMENT;
+    }
+
+    p = buf;
+    if (packetLen > 0xFF)
+    {
+        *p++ = MQTTSN_LONG_LENGTH;
+        *p++ = (uint8_t)(packetLen >> 8);
+    }
+    *p++ = (uint8_t)packetLen;
+    *p++ = MQTTSN_PUBLISH;
+    *p++ = (uint8_t)(FLAG_QOS1 | (entry->retained ? FLAG_RETAIN : 0)
+                     | (entry->sends > 0 ? FLAG_DUP : 0)
+                     | (entry->topic.topicType & 0x03));
+    *p++ = (uint8_t)(entry->topic.topicId >> 8);
+    *p++ = (uint8_t)entry->topic.topicId;
+    *p++ = (uint8_t)(entry->msgId >> 8);
+    *p++ = (uint8_t)entry->msgId;
+    if (entry->len > 0)
+    {
+        memcpy(p, entry->payload, entry->len);
+    }
+
+    entry->sends++;
+    entry->sentAt = Thingstream_Platform_getTimeMillis();
+    return inner->send(inner, 0, buf, (uint16_t)packetLen, SEND_MS);
+}
+
+/**
+ * Free the entry and report the outcome of its message.
+ *
+ * @param state the publish window state
+ * @param entry the message that is complete
+ * @param result the outcome
+ */
+static void completeEntry(PublishWindowState* state, WindowEntry* entry, ThingstreamClientResult result)
+{
+    uint16_t msgId = entry->msgId;
+    entry->msgId = 0;
+    state->inFlight--;
+    state->done(state->doneCookie, msgId, result);
+}
+
+ThingstreamClientResult Thingstream_PublishWindow_publish(ThingstreamTransport* self, ThingstreamTopic topic, bool retained, const uint8_t* payload, uint16_t len, uint16_t* msgId)
+{
+    PublishWindowState* state = (PublishWindowState*)self->_state;
+    WindowEntry* entry = NULL;
+    ThingstreamTransportResult tRes;
+    uint8_t i;
+
+    if ((payload == NULL) && (len > 0))
+    {
+        return CLIENT_ILLEGAL_ARGUMENT;
+    }
+    for (i = 0; i < state->window; ++i)
+    {
+        if (state->entries[i].msgId == 0)
+        {
+            entry = &state->entries[i];
+            break;
+        }
+    }
+    if (entry == NULL)
+    {
+        return CLIENT_CONGESTION;
+    }
+
+    entry->payload = payload;
+    entry->topic = topic;
+    entry->len = len;
+    entry->retained = retained;
+    entry->sends = 0;
+    entry->msgId = (uint16_t)(MSG_ID_BASE | state->nextId);
+    state->nextId = (uint16_t)((state->nextId + 1) & ~MSG_ID_BASE);
+
+    tRes = sendEntry(state, entry);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        entry->msgId = 0;
+        if (tRes == TRANSPORT_ILLEGAL_ARGUMENT)
+        {
+            return CLIENT_PUBLISH_TOO_LONG;
+        }
+        return (ThingstreamClientResult)tRes;
+    }
+    state->inFlight++;
+    if (msgId != NULL)
+    {
+        *msgId = entry->msgId;
+    }
+    return CLIENT_SUCCESS;
+}
+
+
+uint8_t Thingstream_PublishWindow_inFlight(ThingstreamTransport* self)
+{
+    PublishWindowState* state = (PublishWindowState*)self->_state;
+    return state->inFlight;
+}
+
+
+/**
+ * Complete the message acknowledged by a PUBACK for one of our message
+ * ids, and pass every other packet to the outer transport.
+ *
+ * @param cookie the publish window state
+ * @param data a pointer to the data
+ * @param len the length of the data
+ */
+static void publish_window_callback(void* cookie, uint8_t* data, uint16_t len)
+{
+    PublishWindowState* state = (PublishWindowState*)cookie;
+    const uint8_t* p = data;
+    uint16_t remaining = len;
+
+    if ((len >= 2) && (data[0] == MQTTSN_LONG_LENGTH))
+    {
+        p += 2;
+        remaining -= 2;
+    }
+    if ((remaining >= 7) && (p[1] == MQTTSN_PUBACK))
+    {
+        uint16_t msgId = (uint16_t)((p[4] << 8) | p[5]);
+        uint8_t i;
+        if (msgId & MSG_ID_BASE)
+        {
+            for (i = 0; i < state->window; ++i)
+            {
+                WindowEntry* entry = &state->entries[i];
+                if (entry->msgId == msgId)
+                {
+                    ThingstreamClientResult result;
+                    switch (p[6])
+                    {
+                    case 0:  result = CLIENT_SUCCESS;        break;
+                    case 1:  result = CLIENT_CONGESTION;     break;
+                    case 2:  result = CLIENT_TOPIC_INVALID;  break;
+                    default: result = CLIENT_PUBLISH_BAD_ACK; break;
+                    }
+                    completeEntry(state, entry, result);
+                    break;
+                }
+            }
+            /* A late or repeated PUBACK is dropped too */
+            return;
+        }
+    }
+    if (state->callback != NULL)
+    {
+        state->callback(state->cookie, data, len);
+    }
+}
+
+/**
+ * Initialize the transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param version the transport API version
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult publish_window_init(ThingstreamTransport* self, uint16_t version)
+{
+    PublishWindowState* state = (PublishWindowState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    ThingstreamTransportResult tRes;
+
+    if (!TRANSPORT_CHECK_VERSION_1(version))
+    {
+        return TRANSPORT_VERSION_MISMATCH;
+    }
+    tRes = inner->register_callback(inner, publish_window_callback, state);
+    if (tRes != TRANSPORT_SUCCESS)
+    {
+        return tRes;
+    }
+    return inner->init(inner, version);
+}
+
+/**
+ * Shutdown the transport (i.e. the opposite of initialize), abandoning
+ * the messages in flight.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult publish_window_shutdown(ThingstreamTransport* self)
+{
+    PublishWindowState* state = (PublishWindowState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    uint8_t i;
+
+    for (i = 0; i < state->window; ++i)
+    {
+        if (state->entries[i].msgId != 0)
+        {
+            completeEntry(state, &state->entries[i], CLIENT_NOT_CONNECTED);
+        }
+    }
+    return inner->shutdown(inner);
+}
+
+/**
+ * Pass the buffer request to the inner transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param buffer where to write the buffer pointer
+ * @param len where the write the buffer length
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult publish_window_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len)
+{
+    PublishWindowState* state = (PublishWindowState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    if (inner->get_buffer == NULL)
+    {
+        return TRANSPORT_ERROR;
+    }
+    return inner->get_buffer(inner, buffer, len);
+}
+
+/**
+ * Send the data to the inner transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param flags an indication of the type of the data, zero is normal.
+ * @param data a pointer to the data
+ * @param len the length of the raw data
+ * @param millis the maximum number of milliseconds to run
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult publish_window_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis)
+{
+    PublishWindowState* state = (PublishWindowState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    return inner->send(inner, flags, data, len, millis);
+}
+
+/**
+ * Register a callback function that will be called when this transport
+ * has data to send to its next outermost ThingstreamTransport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param callback the callback function
+ * @param cookie a opaque value passed to the callback function
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult publish_window_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie)
+{
+    PublishWindowState* state = (PublishWindowState*)self->_state;
+    state->callback = callback;
+    state->cookie = cookie;
+    return TRANSPORT_SUCCESS;
+}
+
+/**
+ * Allow the inner transport to run for at most the given number of
+ * milliseconds, then send again the messages whose PUBACK is overdue.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param millis the maximum number of milliseconds to run (a value of zero
+ *        processes all pending operations).
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult publish_window_run(ThingstreamTransport* self, uint32_t millis)
+{
+    PublishWindowState* state = (PublishWindowState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    ThingstreamTransportResult tRes = inner->run(inner, millis);
+    uint32_t now = Thingstream_Platform_getTimeMillis();
+    uint8_t i;
+
+    for (i = 0; i < state->window; ++i)
+    {
+        WindowEntry* entry = &state->entries[i];
+        if ((entry->msgId != 0)
+            && TIME_COMPARE(now, >=, entry->sentAt + state->retryMs))
+        {
+            if (entry->sends >= MAX_SENDS)
+            {
+                completeEntry(state, entry, CLIENT_OPERATION_TIMED_OUT);
+            }
+            else
+            {
+                /* A failed send is treated as lost and tried again */
+                (void)sendEntry(state, entry);
+            }
+        }
+    }
+    return tRes;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Windowed QoS 1 publishing with several messages in flight
+ *
+ * Thingstream_Client_publish() at #ThingstreamQOS1 waits for the PUBACK
+ * before it returns, so each message costs a round trip.
+ * Thingstream_PublishWindow_publish() instead sends the PUBLISH and
+ * returns at once, allowing up to the window size of messages to be
+ * waiting for their PUBACK. The PUBACKs are matched in any order as the
+ * client runs, messages that are not acknowledged in time are sent again,
+ * and the outcome of each message is reported to a callback.
+ *
+ * The publish window transport sits between the client (or the client
+ * logger) and the protocol transport. It uses message ids from 0x8000
+ * upwards, which the client never uses, and consumes the PUBACKs for them.
+ */
+
+#ifndef INC_PUBLISH_WINDOW_TRANSPORT_H
+#define INC_PUBLISH_WINDOW_TRANSPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "client_api.h"
+#include "transport_api.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * The largest window that can be used.
+ * @hideinitializer
+ */
+#ifndef PUBLISH_WINDOW_MAX
+#define PUBLISH_WINDOW_MAX 8
+#endif
+
+/**
+ * Type of the routine that is told the outcome of each message.
+ *
+ * @param cookie the cookie passed to Thingstream_createPublishWindowTransport()
+ * @param msgId the message id returned by Thingstream_PublishWindow_publish()
+ * @param result #CLIENT_SUCCESS if the server accepted the message,
+ *   #CLIENT_CONGESTION, #CLIENT_TOPIC_INVALID or #CLIENT_PUBLISH_BAD_ACK if
+ *   it was rejected, #CLIENT_OPERATION_TIMED_OUT if it was not
+ *   acknowledged, or #CLIENT_NOT_CONNECTED if the transport was shut down
+ */
+typedef void (*ThingstreamPublishWindowCallback_t)(void* cookie, uint16_t msgId, ThingstreamClientResult result);
+
+/**
+ * Create a publish window transport instance.
+ *
+ * @param inner the inner transport instance (e.g. the protocol transport)
+ * @param window the most messages waiting for a PUBACK, at most
+ *   #PUBLISH_WINDOW_MAX
+ * @param retryMs the time to wait for a PUBACK before sending the message
+ *   again
+ * @param callback the routine told the outcome of each message
+ * @param cookie an opaque value passed to the callback
+ * @return the instance, or NULL if an argument is not valid
+ */
+extern ThingstreamTransport* Thingstream_createPublishWindowTransport(ThingstreamTransport* inner, uint8_t window, uint32_t retryMs, ThingstreamPublishWindowCallback_t callback, void* cookie);
+
+/**
+ * Publish a message at QoS 1 without waiting for the PUBACK.
+ * The client must be connected, and a normal topic registered. The
+ * payload is not copied and must stay valid until the callback has been
+ * told the outcome. Thingstream_Client_run() should be called while
+ * messages are in flight so that PUBACKs are received and messages are
+ * sent again.
+ *
+ * @param self the publish window transport instance
+ * @param topic the topic to publish to
+ * @param retained true if the server should retain the message
+ * @param payload the payload of the message
+ * @param len the length of the payload
+ * @param msgId where to write the message id, may be NULL
+ * @return #CLIENT_SUCCESS if the message was sent, #CLIENT_CONGESTION if
+ *   the window is full, #CLIENT_PUBLISH_TOO_LONG if the message does not
+ *   fit in the transport buffer, else the transport error
+ */
+extern ThingstreamClientResult Thingstream_PublishWindow_publish(ThingstreamTransport* self, ThingstreamTopic topic, bool retained, const uint8_t* payload, uint16_t len, uint16_t* msgId);
+
+/**
+ * Return the number of messages waiting for a PUBACK.
+ *
+ * @param self the publish window transport instance
+ * @return the number of messages in flight
+ */
+extern uint8_t Thingstream_PublishWindow_inFlight(ThingstreamTransport* self);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_PUBLISH_WINDOW_TRANSPORT_H */
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Compact binary encoding of records described by a schema
+ *
+ * Fields are copied with memcpy() so the records need not be aligned.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "record_codec.h"
+
+/** The bit of #ThingstreamRecordType that marks a signed field */
+#define RECORD_SIGNED   0x80
+
+/** The bits of #ThingstreamRecordType that give the size of a field */
+#define RECORD_SIZE     0x07
+
+/**
+ * Check that a field type is one of #ThingstreamRecordType.
+ */
+static bool validType(uint8_t type)
+{
+    uint8_t size = type & RECORD_SIZE;
+    return ((type & ~(RECORD_SIGNED | RECORD_SIZE)) == 0)
+        && ((size == 1) || (size == 2) || (size == 4));
+}
+
+/**
+ * Read a field, zigzag encoded if it is signed.
+ */
+static uint32_t readField(const uint8_t* record, const ThingstreamRecordField* field)
+{
+    const uint8_t* p = record + field->offset;
+    int32_t s;
+
+    switch (field->type)
+    {
+    case RECORD_UINT8:  { uint8_t v;  memcpy(&v, p, sizeof(v)); return v; }
+    case RECORD_UINT16: { uint16_t v; memcpy(&v, p, sizeof(v)); return v; }
+    case RECORD_UINT32: { uint32_t v; memcpy(&v, p, sizeof(v)); return v; }
+    case RECORD_INT8:   { int8_t v;   memcpy(&v, p, sizeof(v)); s = v; break; }
+    case RECORD_INT16:  { int16_t v;  memcpy(&v, p, sizeof(v)); s = v; break; }
+    default:            { memcpy(&s, p, sizeof(s)); break; }
+    }
+    return ((uint32_t)s << 1) ^ (uint32_t)(s >> 31);
+}
+
+/**
+ * Write a field, zigzag decoding it if it is signed.
+ *
+ * @return false if the value is too big for the field
+ */
+static bool writeField(uint8_t* record, const ThingstreamRecordField* field, uint32_t value)
+{
+    uint8_t* p = record + field->offset;
+    uint8_t size = field->type & RECORD_SIZE;
+
+    if ((size < 4) && ((value >> (8 * size)) != 0))
+    {
+        return false;
+    }
+    if (field->type & RECORD_SIGNED)
+    {
+        value = (value >> 1) ^ (0u - (value & 1));
+    }
+    switch (size)
+    {
+    case 1: { uint8_t v = (uint8_t)value;   memcpy(p, &v, sizeof(v)); break; }
+    case 2: { uint16_t v = (uint16_t)value; memcpy(p, &v, sizeof(v)); break; }
+    default: memcpy(p, &value, sizeof(value)); break;
+    }
+    return true;
+}
+
+uint32_t Thingstream_Record_changed(const ThingstreamRecordField* schema, uint8_t count, const void* record, const void* previous)
+{
+    uint32_t changed = 0;
+    uint8_t i;
+
+    for (i = 0; (i < count) && (i < RECORD_MAX_FIELDS); ++i)
+    {
+        uint16_t offset = schema[i].offset;
+        uint8_t size = schema[i].type & RECORD_SIZE;
+        if (memcmp((const uint8_t*)record + offset,
+                   (const uint8_t*)previous + offset, size) != 0)
+        {
+            changed |= 1ul << i;
+        }
+    }
+    return changed;
+}
+
+int32_t Thingstream_Record_encode(uint8_t* out, uint16_t outLen, const ThingstreamRecordField* schema, uint8_t count, const void* record, uint32_t present)
+{
+    uint16_t mapLen = (uint16_t)((count + 7) / 8);
+    uint16_t o = mapLen;
+    uint8_t i;
+
+    if ((count > RECORD_MAX_FIELDS) || (outLen < mapLen))
+    {
+        return -1;
+    }
+    if (count < RECORD_MAX_FIELDS)
+    {
+        present &= (1ul << count) - 1;
+    }
+    for (i = 0; i < mapLen; ++i)
+    {
+        out[i] = (uint8_t)(present >> (8 * i));
+    }
+
+    for (i = 0; i < count; ++i)
+    {
+        uint32_t value;
+        if ((present & (1ul << i)) == 0)
+        {
+            continue;
+        }
+        if (!validType(schema[i].type))
+        {
+            return -1;
+        }
+        value = readField((const uint8_t*)record, &schema[i]);
+        do
+        {
+            if (o >= outLen)
+            {
+                return -1;
+            }
+            out[o++] = (uint8_t)((value & 0x7F) | ((value > 0x7F) ? 0x80 : 0));
+            value >>= 7;
+        }
+        while (value != 0);
+    }
+    return o;
+}
+
+int32_t Thingstream_Record_decode(void* record, const ThingstreamRecordField* schema, uint8_t count, const uint8_t* data, uint16_t len, uint32_t* present)
+{
+    uint16_t mapLen = (uint16_t)((count + 7) / 8);
+    uint16_t i = mapLen;
+    uint32_t map = 0;
+    uint8_t f;
+
+    if ((count > RECORD_MAX_FIELDS) || (len < mapLen))
+    {
+        return -1;
+    }
+    for (f = 0; f < mapLen; ++f)
+    {
+        map |= (uint32_t)data[f] << (8 * f);
+    }
+    if ((count < RECORD_MAX_FIELDS) && ((map >> count) != 0))
+    {
+        return -1;
+    }
+
+    for (f = 0; f < count; ++f)
+    {
+        uint32_t value = 0;
+        uint8_t shift = 0;
+        uint8_t b;
+        if ((map & (1ul << f)) == 0)
+        {
+            continue;
+        }
+        if (!validType(schema[f].type))
+        {
+            return -1;
+        }
+        do
+        {
+            if ((i >= len) || (shift > 28))
+            {
+                return -1;
+            }
+            b = data[i++];
+            value |= (uint32_t)(b & 0x7F) << shift;
+            shift = (uint8_t)(shift + 7);
+        }
+        while (b & 0x80);
+        if (!writeField((uint8_t*)record, &schema[f], value))
+        {
+            return -1;
+        }
+    }
+    if (present != NULL)
+    {
+        *present = map;
+    }
+    return i;
+}
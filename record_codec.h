@@ -0,0 +1,135 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Compact binary encoding of records described by a schema
+ *
+ * A record is a C structure of integer fields, and its schema is an array
+ * of #ThingstreamRecordField, normally written with #RECORD_FIELD:
+ * <pre>
+ *   static const ThingstreamRecordField schema[] = {
+ *       RECORD_FIELD(Sensor, temperature, RECORD_INT16),
+ *       RECORD_FIELD(Sensor, pressure,    RECORD_UINT16),
+ *   };
+ * </pre>
+ * The encoded record is a presence bitmap of (count + 7) / 8 bytes, bit i
+ * (from the least significant bit of the first byte) set if field i is
+ * present, followed by the present fields in schema order. Each field is
+ * a base 128 varint, least significant group first, and signed fields are
+ * zigzag encoded first so that small negative values stay short.
+ */
+
+#ifndef INC_RECORD_CODEC_H
+#define INC_RECORD_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * The types of field in a record. The low bits give the size in bytes.
+ */
+typedef enum ThingstreamRecordType_e
+{
+    RECORD_UINT8  = 0x01,
+    RECORD_UINT16 = 0x02,
+    RECORD_UINT32 = 0x04,
+    RECORD_INT8   = 0x81,
+    RECORD_INT16  = 0x82,
+    RECORD_INT32  = 0x84
+} ThingstreamRecordType;
+
+/**
+ * The description of one field in a record.
+ */
+typedef struct ThingstreamRecordField_s
+{
+    /** The offset of the field in the structure */
+    uint16_t offset;
+    /** The #ThingstreamRecordType of the field */
+    uint8_t type;
+} ThingstreamRecordField;
+
+/**
+ * Describe a field of a record structure.
+ * @param structType the type of the structure
+ * @param member the name of the field
+ * @param type the #ThingstreamRecordType of the field
+ * @hideinitializer
+ */
+#define RECORD_FIELD(structType, member, type) \
+    { (uint16_t)offsetof(structType, member), (uint8_t)(type) }
+
+/**
+ * The largest number of fields in a schema.
+ * @hideinitializer
+ */
+#define RECORD_MAX_FIELDS 32
+
+/**
+ * The longest encoding of a record with the given number of fields.
+ * @hideinitializer
+ */
+#define RECORD_MAX_ENCODED_LEN(count) (((count) + 7) / 8 + 5 * (count))
+
+/**
+ * Compare two records.
+ * @param schema the schema of the records
+ * @param count the number of fields in the schema
+ * @param record the record
+ * @param previous the record to compare with
+ * @return a bitmap with bit i set if field i differs
+ */
+extern uint32_t Thingstream_Record_changed(const ThingstreamRecordField* schema, uint8_t count, const void* record, const void* previous);
+
+/**
+ * Encode some of the fields of a record.
+ * @param out buffer to receive the encoding
+ * @param outLen the length of the buffer
+ * @param schema the schema of the record
+ * @param count the number of fields in the schema, at most
+ *    #RECORD_MAX_FIELDS
+ * @param record the record
+ * @param present a bitmap with bit i set if field i is to be encoded
+ * @return the length of the encoding, or -1 if it does not fit in the
+ *    buffer or the schema is not valid
+ */
+extern int32_t Thingstream_Record_encode(uint8_t* out, uint16_t outLen, const ThingstreamRecordField* schema, uint8_t count, const void* record, uint32_t present);
+
+/**
+ * Decode a record. Only the fields present in the encoding are written,
+ * so the record keeps its earlier values for the others.
+ * @param record the record to receive the fields
+ * @param schema the schema of the record
+ * @param count the number of fields in the schema
+ * @param data the encoding
+ * @param len the length of the encoding
+ * @param present where to write the bitmap of the fields present, or NULL
+ * @return the length of the encoding used, or -1 if it is not valid
+ */
+extern int32_t Thingstream_Record_decode(void* record, const ThingstreamRecordField* schema, uint8_t count, const uint8_t* data, uint16_t len, uint32_t* present);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_RECORD_CODEC_H */
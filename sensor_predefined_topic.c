@@ -1,5 +1,5 @@
 /*
- * Copyright 2021-2024 Thingstream AG
+ * Copyright 2021-2026 Thingstream AG
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -26,6 +26,9 @@
 #include "run_example.h"
 #include "platform_delay.h"
 #include "platform_sensor.h"
+#if defined(SENSOR_RECORD)
+#include "record_codec.h"
+#endif
 
 typedef struct Sensor_s
 {
@@ -69,6 +72,28 @@ const ThingstreamTopic PredefinedTemperatureTopic    = MAKE_PREDEFINED_TOPIC(300
 const ThingstreamTopic PredefinedPressureTopic       = MAKE_PREDEFINED_TOPIC(301);
 const ThingstreamTopic PredefinedBatteryVoltageTopic = MAKE_PREDEFINED_TOPIC(302);
 const ThingstreamTopic PredefinedBatteryChargeTopic  = MAKE_PREDEFINED_TOPIC(303);
+#if defined(SENSOR_RECORD)
+const ThingstreamTopic PredefinedSensorRecordTopic   = MAKE_PREDEFINED_TOPIC(304);
+
+/* With SENSOR_RECORD the changed readings are published together as one
+ * binary record (see record_codec.h) rather than as one text message for
+ * each. The server decodes the record with the same schema.
+ */
+static const ThingstreamRecordField sensorSchema[] = {
+    RECORD_FIELD(Sensor, temperature, RECORD_INT16),
+    RECORD_FIELD(Sensor, pressure,    RECORD_UINT16),
+    RECORD_FIELD(Sensor, voltage,     RECORD_UINT16),
+    RECORD_FIELD(Sensor, charge,      RECORD_UINT16)
+};
+
+#define SENSOR_FIELDS (sizeof(sensorSchema) / sizeof(sensorSchema[0]))
+
+/* True once the server holds the values in previous, so that only the
+ * changes need to be sent. Until then (after boot, or after a publish
+ * that failed) every field is sent.
+ */
+static bool recordSynced;
+#endif /* SENSOR_RECORD */
 
 static Sensor previous;
 
@@ -102,6 +127,84 @@ static void reportInvalidTopic(const ThingstreamTopic topic, const char* topicNa
     }
 }
 
+#if defined(SENSOR_COALESCE)
+/* With SENSOR_COALESCE the changed readings are published without
+ * waiting for each PUBACK, and the coalesce transport sends them
+ * together in one datagram.
+ */
+#ifndef COALESCE_WINDOW_MS
+#define COALESCE_WINDOW_MS 2000
+#endif
+
+/* The longest datagram, allowing for base64 and the protocol header */
+#define COALESCE_MAX_LEN ((MODEM_BUFFER_LEN - MODEM__RESERVED_BUFFER) * 3 / 4 - 9)
+
+/* The time to wait for the PUBACKs */
+#define PUBACK_WAIT_MS 30000
+
+static uint8_t coalesceBuf[MODEM_BUFFER_LEN];
+static ThingstreamTransport *coalesce_transport;
+static ThingstreamTransport *window_transport;
+
+/* A reading being published, kept until its PUBACK arrives */
+typedef struct Reading_s
+{
+    ThingstreamTopic topic;
+    const char* topicName;
+    uint16_t msgId;
+    char msg[8];
+} Reading;
+
+static Reading readings[4];
+
+/*
+ * Report the outcome of publishing a reading.
+ */
+static void publishDone(void* cookie, uint16_t msgId, ThingstreamClientResult result)
+{
+    int i;
+    UNUSED(cookie);
+    for (i = 0; i < 4; ++i)
+    {
+        if (readings[i].msgId == msgId)
+        {
+            if (result == CLIENT_TOPIC_INVALID)
+            {
+                reportInvalidTopic(readings[i].topic, readings[i].topicName);
+            }
+            else if (result != CLIENT_SUCCESS)
+            {
+                Thingstream_Util_printf("publish %s ERROR result=%d\n",
+                                        readings[i].topicName, result);
+            }
+        }
+    }
+}
+
+/*
+ * Publish a reading through the publish window transport.
+ */
+static void publishReading(int i, ThingstreamTopic topic,
+                           const char* topicName, int value)
+{
+    Reading* reading = &readings[i];
+    ThingstreamClientResult result;
+
+    reading->topic = topic;
+    reading->topicName = topicName;
+    sprintf(reading->msg, "%d", value);
+    result = Thingstream_PublishWindow_publish(window_transport, topic, false,
+                                               (uint8_t*) reading->msg,
+                                               strlen(reading->msg),
+                                               &reading->msgId);
+    if (result != CLIENT_SUCCESS)
+    {
+        Thingstream_Util_printf("publish %s ERROR result=%d\n",
+                                topicName, result);
+    }
+}
+#endif /* SENSOR_COALESCE */
+
 
 /**
  * Default (dummy) implementation to return a temperature.
@@ -243,7 +346,12 @@ static void publish_sensor_changes(ThingstreamTransport *transport)
 
     /* If no sensor reading has changed, just return */
 
+#if defined(SENSOR_RECORD)
+    if (recordSynced
+     && (current.temperature == previous.temperature)
+#else
     if ((current.temperature == previous.temperature)
+#endif /* SENSOR_RECORD */
      && (current.pressure == previous.pressure)
      && (current.voltage == previous.voltage)
      && (current.charge == previous.charge))
@@ -251,6 +359,23 @@ static void publish_sensor_changes(ThingstreamTransport *transport)
         return;
     }
 
+#if defined(SENSOR_RECORD)
+    /* Encode the changed readings as one record, or all of them if the
+     * server may not hold the previous values
+     */
+    uint8_t record[RECORD_MAX_ENCODED_LEN(SENSOR_FIELDS)];
+    uint32_t changed = (1u << SENSOR_FIELDS) - 1;
+    if (recordSynced)
+    {
+        changed = Thingstream_Record_changed(sensorSchema, SENSOR_FIELDS,
+                                             &current, &previous);
+    }
+    int32_t recordLen = Thingstream_Record_encode(record, sizeof(record),
+                                                  sensorSchema, SENSOR_FIELDS,
+                                                  &current, changed);
+    CHECK("encode record", recordLen > 0);
+#endif /* SENSOR_RECORD */
+
     /* Publish any updated values, so create client and connect */
 
     ThingstreamClient* client = Thingstream_createClient(transport);
@@ -262,6 +387,68 @@ static void publish_sensor_changes(ThingstreamTransport *transport)
     result = Thingstream_Client_connect(client, true, 0, NULL);
     CHECK_CLIENT_SUCCESS("connect", result, shutdown);
 
+#if defined(SENSOR_RECORD)
+    result = Thingstream_Client_publish(client, PredefinedSensorRecordTopic,
+                                        ThingstreamQOS1, false,
+                                        record, (uint16_t)recordLen);
+    /* If the publish failed the server may have missed these changes */
+    recordSynced = (result == CLIENT_SUCCESS);
+    if (result == CLIENT_TOPIC_INVALID)
+    {
+        reportInvalidTopic(PredefinedSensorRecordTopic, "sensor/record");
+    }
+    else
+    {
+        CHECK_CLIENT_SUCCESS("publish record", result, disconnect);
+    }
+    if (recordSynced)
+    {
+        previous = current;
+        count++;
+    }
+#elif defined(SENSOR_COALESCE)
+    if (current.temperature != previous.temperature)
+    {
+        publishReading(0, PredefinedTemperatureTopic,
+                       "sensor/temperature", current.temperature);
+        previous.temperature = current.temperature;
+        count++;
+    }
+    if (current.pressure != previous.pressure)
+    {
+        publishReading(1, PredefinedPressureTopic,
+                       "sensor/pressure", current.pressure);
+        previous.pressure = current.pressure;
+        count++;
+    }
+    if (current.voltage != previous.voltage)
+    {
+        publishReading(2, PredefinedBatteryVoltageTopic,
+                       "sensor/battery/voltage", current.voltage);
+        previous.voltage = current.voltage;
+        count++;
+    }
+    if (current.charge != previous.charge)
+    {
+        publishReading(3, PredefinedBatteryChargeTopic,
+                       "sensor/battery/charge", current.charge);
+        previous.charge = current.charge;
+        count++;
+    }
+
+    /* Send the readings now rather than at the end of the window,
+     * then run the client until all the PUBACKs have arrived.
+     */
+    result = Thingstream_Coalesce_flush(coalesce_transport, PUBACK_WAIT_MS);
+    CHECK_CLIENT_SUCCESS("publish readings", result, disconnect);
+    uint32_t limit = Thingstream_Platform_getTimeMillis() + PUBACK_WAIT_MS;
+    while ((Thingstream_PublishWindow_inFlight(window_transport) > 0)
+           && TIME_COMPARE(Thingstream_Platform_getTimeMillis(), <, limit))
+    {
+        result = Thingstream_Client_run(client, 1000);
+        CHECK_CLIENT_SUCCESS("run", result, disconnect);
+    }
+#else
     /* If the temperature has changed then publish an update */
     char msg[32];
     if (current.temperature != previous.temperature)
@@ -340,6 +527,7 @@ static void publish_sensor_changes(ThingstreamTransport *transport)
         previous.charge = current.charge;
         count++;
     }
+#endif /* SENSOR_RECORD */
 
     ThingstreamClientResult cr;
 disconnect:
@@ -394,13 +582,28 @@ ThingstreamClientResult run_example(ThingstreamTransport *transport,
      */
     modem_transport = transport;
 
-    /* Base 64 encoding is optional when using UDP. */
+    /* Base 64 encoding is bypassed at init when the modem uses UDP. */
     transport = Thingstream_createBase64CodecTransport(transport);
     CHECK("base64", transport != NULL);
 
     transport = Thingstream_createProtocolTransport(transport, NULL, 0);
     CHECK("thingstream", transport != NULL);
 
+#if defined(SENSOR_COALESCE)
+    transport = Thingstream_createCoalesceTransport(transport,
+                                                    coalesceBuf,
+                                                    sizeof(coalesceBuf),
+                                                    COALESCE_MAX_LEN,
+                                                    COALESCE_WINDOW_MS);
+    CHECK("coalesce", transport != NULL);
+    coalesce_transport = transport;
+
+    transport = Thingstream_createPublishWindowTransport(transport, 4, 10000,
+                                                         publishDone, NULL);
+    CHECK("publish_window", transport != NULL);
+    window_transport = transport;
+#endif /* SENSOR_COALESCE */
+
 #if (defined(DEBUG_LOG_CLIENT) && (DEBUG_LOG_CLIENT > 0))
     transport = Thingstream_createClientLogger(transport,
                                                Thingstream_Util_printf,
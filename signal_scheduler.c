@@ -0,0 +1,209 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Deferral of non-urgent publishes while the signal is weak
+ */
+
+#include <string.h>
+
+#include "signal_scheduler.h"
+#include "modem_transport.h"
+#include "client_platform.h"
+#include "sdk_data.h"
+
+/** The AT+CSQ strength reported when it is not known */
+#define CSQ_UNKNOWN         99
+
+/** A held publish, followed in the buffer by its payload */
+typedef struct HeldPublish_s
+{
+    /** The time by which the message must be sent */
+    uint32_t deadline;
+    /** The topic to publish to */
+    ThingstreamTopic topic;
+    /** The length of the payload */
+    uint16_t len;
+    /** The quality of service */
+    int8_t qos;
+    /** The message should be retained */
+    uint8_t retained;
+} HeldPublish;
+
+/** The state of the scheduler */
+static struct
+{
+    /** The modem transport used to sample the signal, or NULL */
+    ThingstreamTransport* modem;
+    /** The buffer of held publishes */
+    uint8_t* buffer;
+    /** The size of the buffer */
+    uint16_t bufSize;
+    /** The number of bytes of the buffer in use */
+    uint16_t used;
+    /** The number of held publishes */
+    uint16_t count;
+    /** The lowest strength at which held publishes are sent */
+    uint8_t minStrength;
+    /** The signal has been sampled */
+    bool sampled;
+    /** The time the signal was last sampled */
+    uint32_t sampledAt;
+} scheduler;
+
+
+void Thingstream_SignalScheduler_init(ThingstreamTransport* modem, uint8_t* buffer, uint16_t bufSize, uint8_t minStrength)
+{
+    memset(&scheduler, 0, sizeof(scheduler));
+    scheduler.modem = modem;
+    scheduler.buffer = buffer;
+    scheduler.bufSize = bufSize;
+    scheduler.minStrength = minStrength;
+}
+
+/**
+ * Return true if the signal is strong enough to send held publishes,
+ * asking the modem for the strength if it has not been read recently.
+ */
+static bool signalGood(void)
+{
+    uint32_t now = Thingstream_Platform_getTimeMillis();
+    if ((scheduler.modem != NULL)
+        && (!scheduler.sampled
+            || TIME_COMPARE(now, >=, scheduler.sampledAt + SIGNAL_SCHEDULER_SAMPLE_MS)))
+    {
+        /* The modem transport stores the +CSQ response in the bearer data */
+        scheduler.sampled = true;
+        scheduler.sampledAt = now;
+        (void)Thingstream_Modem_sendLine(scheduler.modem, "AT+CSQ",
+                                         SIGNAL_SCHEDULER_CSQ_MS);
+    }
+    uint8_t strength = SDK_DATA_GSM_BEARER(strength);
+    return (strength != CSQ_UNKNOWN) && (strength >= scheduler.minStrength);
+}
+
+/**
+ * Publish the held messages in the order they were held.
+ *
+ * @param client the client instance
+ * @return #CLIENT_SUCCESS, or the result of the first publish that failed
+ */
+static ThingstreamClientResult flush(ThingstreamClient* client)
+{
+    ThingstreamClientResult cr = CLIENT_SUCCESS;
+    uint16_t offset = 0;
+
+    while (scheduler.count > 0)
+    {
+        HeldPublish held;
+        memcpy(&held, &scheduler.buffer[offset], sizeof(held));
+        cr = Thingstream_Client_publish(client, held.topic,
+                                        (ThingstreamQualityOfService_t)held.qos,
+                                        held.retained != 0,
+                                        &scheduler.buffer[offset + sizeof(held)],
+                                        held.len);
+        if (cr != CLIENT_SUCCESS)
+        {
+            break;
+        }
+        offset += (uint16_t)(sizeof(held) + held.len);
+        scheduler.count--;
+    }
+
+    /* Keep the messages that were not sent */
+    scheduler.used -= offset;
+    memmove(scheduler.buffer, &scheduler.buffer[offset], scheduler.used);
+    return cr;
+}
+
+ThingstreamClientResult Thingstream_SignalScheduler_publish(ThingstreamClient* client, ThingstreamTopic topic, ThingstreamQualityOfService_t qos, bool retained, uint8_t* payload, uint16_t len, uint32_t deferMs)
+{
+    ThingstreamClientResult cr;
+    uint32_t size = sizeof(HeldPublish) + (uint32_t)len;
+
+    if (deferMs == SIGNAL_SCHEDULER_URGENT)
+    {
+        return Thingstream_Client_publish(client, topic, qos, retained, payload, len);
+    }
+
+    /* Send now, after the held messages, if the signal allows or the
+     * message can never be held
+     */
+    if ((size > scheduler.bufSize) || signalGood())
+    {
+        cr = flush(client);
+        if (cr == CLIENT_SUCCESS)
+        {
+            cr = Thingstream_Client_publish(client, topic, qos, retained, payload, len);
+        }
+        return cr;
+    }
+    if (size > (uint32_t)(scheduler.bufSize - scheduler.used))
+    {
+        cr = flush(client);
+        if (cr != CLIENT_SUCCESS)
+        {
+            return cr;
+        }
+    }
+
+    HeldPublish held;
+    held.deadline = Thingstream_Platform_getTimeMillis() + deferMs;
+    held.topic = topic;
+    held.len = len;
+    held.qos = (int8_t)qos;
+    held.retained = retained ? 1 : 0;
+    memcpy(&scheduler.buffer[scheduler.used], &held, sizeof(held));
+    memcpy(&scheduler.buffer[scheduler.used + sizeof(held)], payload, len);
+    scheduler.used += (uint16_t)size;
+    scheduler.count++;
+    return CLIENT_SUCCESS;
+}
+
+ThingstreamClientResult Thingstream_SignalScheduler_run(ThingstreamClient* client)
+{
+    uint32_t now = Thingstream_Platform_getTimeMillis();
+    uint16_t offset = 0;
+    uint16_t i;
+
+    if (scheduler.count == 0)
+    {
+        return CLIENT_SUCCESS;
+    }
+
+    /* A message that is due takes the others with it */
+    for (i = 0; i < scheduler.count; ++i)
+    {
+        HeldPublish held;
+        memcpy(&held, &scheduler.buffer[offset], sizeof(held));
+        if (TIME_COMPARE(now, >=, held.deadline))
+        {
+            return flush(client);
+        }
+        offset += (uint16_t)(sizeof(held) + held.len);
+    }
+    if (signalGood())
+    {
+        return flush(client);
+    }
+    return CLIENT_SUCCESS;
+}
+
+uint16_t Thingstream_SignalScheduler_pending(void)
+{
+    return scheduler.count;
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Deferral of non-urgent publishes while the signal is weak
+ */
+
+#ifndef INC_SIGNAL_SCHEDULER_H
+#define INC_SIGNAL_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "client_api.h"
+#include "transport_api.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * The shortest time between the AT+CSQ commands sent to re-sample the
+ * signal strength while publishes are deferred.
+ * @hideinitializer
+ */
+#ifndef SIGNAL_SCHEDULER_SAMPLE_MS
+#define SIGNAL_SCHEDULER_SAMPLE_MS 30000
+#endif
+
+/**
+ * The time allowed for the modem to answer AT+CSQ.
+ * @hideinitializer
+ */
+#ifndef SIGNAL_SCHEDULER_CSQ_MS
+#define SIGNAL_SCHEDULER_CSQ_MS 2000
+#endif
+
+/**
+ * Pass as the deferMs of Thingstream_SignalScheduler_publish() to publish
+ * immediately, whatever the signal strength.
+ * @hideinitializer
+ */
+#define SIGNAL_SCHEDULER_URGENT 0
+
+/**
+ * Set up the scheduler. Any deferred publishes are discarded.
+ *
+ * @param modem the modem transport instance, used to re-sample the signal
+ *   strength with AT+CSQ, or NULL to use only the strength that the modem
+ *   transport has read itself
+ * @param buffer the buffer that holds the deferred publishes, each needs
+ *   its payload length plus 12 bytes
+ * @param bufSize the size of the buffer
+ * @param minStrength the lowest AT+CSQ signal strength (0 to 31) at which
+ *   deferred publishes are sent
+ */
+extern void Thingstream_SignalScheduler_init(ThingstreamTransport* modem, uint8_t* buffer, uint16_t bufSize, uint8_t minStrength);
+
+/**
+ * Publish a message now if it is urgent or the signal is strong enough,
+ * otherwise hold it until the signal is strong enough or deferMs has
+ * passed.
+ *
+ * The signal strength is the AT+CSQ value in SDK_DATA_GSM_BEARER(strength),
+ * re-sampled if it is older than #SIGNAL_SCHEDULER_SAMPLE_MS. A message
+ * that does not fit in the buffer is published now, as are all the held
+ * messages if the buffer is full.
+ *
+ * @param client the client instance
+ * @param topic the topic to publish to
+ * @param qos the quality of service
+ * @param retained true if the message should be retained
+ * @param payload the message, which is copied if it is held
+ * @param len the length of the message
+ * @param deferMs the longest time the message may be held, or
+ *   #SIGNAL_SCHEDULER_URGENT
+ * @return #CLIENT_SUCCESS if the message was published or held, else the
+ *   result of Thingstream_Client_publish()
+ */
+extern ThingstreamClientResult Thingstream_SignalScheduler_publish(ThingstreamClient* client, ThingstreamTopic topic, ThingstreamQualityOfService_t qos, bool retained, uint8_t* payload, uint16_t len, uint32_t deferMs);
+
+/**
+ * Send the held messages if the signal has become strong enough or any of
+ * them has been held for its deferMs. This should be called regularly,
+ * e.g. with Thingstream_Client_run().
+ *
+ * @param client the client instance
+ * @return #CLIENT_SUCCESS, or the result of the first
+ *   Thingstream_Client_publish() that failed, in which case that message
+ *   and those after it are still held
+ */
+extern ThingstreamClientResult Thingstream_SignalScheduler_run(ThingstreamClient* client);
+
+/**
+ * Return the number of messages held.
+ *
+ * @return the number of messages held
+ */
+extern uint16_t Thingstream_SignalScheduler_pending(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_SIGNAL_SCHEDULER_H */
@@ -1,5 +1,5 @@
 /*
- * Copyright 2021-2023 Thingstream AG
+ * Copyright 2021-2026 Thingstream AG
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -23,6 +23,7 @@
 #include <client_api.h>
 #include <predefined_topics.h>
 #include <base64_codec_transport.h>
+#include <base85_codec_transport.h>
 #include <thingstream_transport.h>
 #include <modem_transport.h>
 #include <log_client_transport.h>
@@ -31,5 +32,18 @@
 #include <client_platform.h>
 #include <thingstream_util.h>
 #include <ring_buffer_transport.h>
+#include <cmux_transport.h>
+#include <modem_socket_transport.h>
+#include <modem_detect.h>
+#include <modem_psm.h>
+#include <modem_mtu.h>
+#include <modem_stats_transport.h>
+#include <signal_scheduler.h>
+#include <ussd_batch_transport.h>
+#include <client_stream.h>
+#include <gather_transport.h>
+#include <publish_window_transport.h>
+#include <coalesce_transport.h>
+#include <compress_transport.h>
 #include <modem_udp_config.h>
 #include <sdk_data.h>
@@ -1,5 +1,5 @@
 /*
- * Copyright 2017-2023 Thingstream AG
+ * Copyright 2017-2023, 2026 Thingstream AG
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
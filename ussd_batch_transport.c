@@ -0,0 +1,300 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Batching of USSD exchanges into one session
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "ussd_batch_transport.h"
+#include "modem_transport.h"
+#include "client_platform.h"
+
+/** The longest line in Thingstream_Modem_ussdEndSessionString */
+#define END_LINE_LEN        32
+
+/** The time allowed to end the session from the run routine */
+#define END_SESSION_MS      5000
+
+/** The longest wait for the reply to an exchange, after which the session
+ * is ended even though the reply has not arrived */
+#define REPLY_WAIT_MS       30000
+
+/**
+ * The UssdBatchState structure is used to store state for the USSD batch
+ * transport.
+ */
+typedef struct UssdBatchState_s
+{
+    /** The modem transport */
+    ThingstreamTransport* inner;
+    /** The callback registered by the outer transport */
+    ThingstreamTransportCallback_t callback;
+    /** Cookie associated with the registered callback */
+    void* cookie;
+    /** The time to keep the session open after an exchange */
+    uint32_t lingerMs;
+    /** A session is being kept open */
+    bool sessionOpen;
+    /** The reply to the last send in the session has not arrived */
+    volatile bool awaitingReply;
+    /** The time of the last send in the session */
+    uint32_t sentAt;
+    /** The time at which the session is ended, once no reply is awaited */
+    volatile uint32_t endAt;
+} UssdBatchState;
+
+/** Instance of UssdBatchState */
+static UssdBatchState _ussd_batch_transport_state;
+
+static ThingstreamTransportResult ussd_batch_init(ThingstreamTransport* self, uint16_t version);
+static ThingstreamTransportResult ussd_batch_shutdown(ThingstreamTransport* self);
+static ThingstreamTransportResult ussd_batch_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len);
+static ThingstreamTransportResult ussd_batch_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis);
+static ThingstreamTransportResult ussd_batch_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie);
+static ThingstreamTransportResult ussd_batch_run(ThingstreamTransport* self, uint32_t millis);
+
+/** Instance of ThingstreamTransport for the USSD batch transport */
+static const ThingstreamTransport _ussd_batch_transport_instance = {
+    (ThingstreamTransportState_t*)&_ussd_batch_transport_state,
+    ussd_batch_init,
+    ussd_batch_shutdown,
+    ussd_batch_get_buffer,
+    NULL, /* This slot no longer used */
+    ussd_batch_send,
+    ussd_batch_register_callback,
+    NULL, /* This slot no longer used */
+    ussd_batch_run
+};
+
+
+ThingstreamTransport* Thingstream_createUssdBatchTransport(ThingstreamTransport* modem, uint32_t lingerMs)
+{
+    ThingstreamTransport* self = (ThingstreamTransport*)&_ussd_batch_transport_instance;
+    UssdBatchState* state = (UssdBatchState*)self->_state;
+
+    if (modem == NULL)
+    {
+        return NULL;
+    }
+    memset(state, 0, sizeof(*state));
+    state->inner = modem;
+    state->lingerMs = lingerMs;
+    return self;
+}
+
+
+ThingstreamTransportResult Thingstream_UssdBatch_endSession(ThingstreamTransport* self, uint32_t millis)
+{
+    UssdBatchState* state = (UssdBatchState*)self->_state;
+    const char* p = Thingstream_Modem_ussdEndSessionString;
+    uint32_t limit = Thingstream_Platform_getTimeMillis() + millis;
+
+    if (!state->sessionOpen)
+    {
+        return TRANSPORT_SUCCESS;
+    }
+    state->sessionOpen = false;
+    state->awaitingReply = false;
+
+    /* Send each line of the string, the session may already have been
+     * ended by the network so errors are expected
+     */
+    while (*p != '\0')
+    {
+        char line[END_LINE_LEN];
+        size_t len = strcspn(p, "\n");
+        const char* start = (*p == '?') ? p + 1 : p;
+        size_t lineLen = len - (size_t)(start - p);
+        uint32_t now = Thingstream_Platform_getTimeMillis();
+
+        if (TIME_COMPARE(now, >=, limit))
+        {
+            return TRANSPORT_SEND_TIMEOUT;
+        }
+        if ((lineLen > 0) && (lineLen < sizeof(line)) && (*start != '~'))
+        {
+            memcpy(line, start, lineLen);
+            line[lineLen] = '\0';
+            (void)Thingstream_Modem_sendLine(state->inner, line, limit - now);
+        }
+        p += len;
+        if (*p == '\n')
+        {
+            ++p;
+        }
+    }
+    return TRANSPORT_SUCCESS;
+}
+
+
+/**
+ * Initialize the transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param version the transport API version
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult ussd_batch_init(ThingstreamTransport* self, uint16_t version)
+{
+    UssdBatchState* state = (UssdBatchState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+
+    if (!TRANSPORT_CHECK_VERSION_1(version))
+    {
+        return TRANSPORT_VERSION_MISMATCH;
+    }
+    state->sessionOpen = false;
+    state->awaitingReply = false;
+    return inner->init(inner, version);
+}
+
+/**
+ * Shutdown the transport (i.e. the opposite of initialize), ending any
+ * session that is being kept open.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult ussd_batch_shutdown(ThingstreamTransport* self)
+{
+    UssdBatchState* state = (UssdBatchState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    (void)Thingstream_UssdBatch_endSession(self, END_SESSION_MS);
+    return inner->shutdown(inner);
+}
+
+/**
+ * Pass the buffer request to the inner transport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param buffer where to write the buffer pointer
+ * @param len where the write the buffer length
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult ussd_batch_get_buffer(ThingstreamTransport* self, uint8_t** buffer, uint16_t* len)
+{
+    UssdBatchState* state = (UssdBatchState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    if (inner->get_buffer == NULL)
+    {
+        return TRANSPORT_ERROR;
+    }
+    return inner->get_buffer(inner, buffer, len);
+}
+
+/**
+ * Send the data to the inner transport, keeping the session open where
+ * the protocol transport asks for it to end. The session is not ended
+ * until the reply to this send has arrived and lingerMs has passed.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param flags an indication of the type of the data, zero is normal.
+ * @param data a pointer to the data
+ * @param len the length of the raw data
+ * @param millis the maximum number of milliseconds to run
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult ussd_batch_send(ThingstreamTransport* self, uint16_t flags, uint8_t* data, uint16_t len, uint32_t millis)
+{
+    UssdBatchState* state = (UssdBatchState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+
+    if ((flags & TSEND_USSD_SESSION_END) || state->sessionOpen)
+    {
+        uint32_t now = Thingstream_Platform_getTimeMillis();
+        flags &= (uint16_t)~TSEND_USSD_SESSION_END;
+        state->sessionOpen = true;
+        state->awaitingReply = true;
+        state->sentAt = now;
+        state->endAt = now + state->lingerMs;
+    }
+    return inner->send(inner, flags, data, len, millis);
+}
+
+/**
+ * Callback from the modem transport with inbound data. Inbound data
+ * completes the exchange and keeps the session open for another lingerMs.
+ *
+ * @param cookie the USSD batch state
+ * @param data the inbound data
+ * @param len the length of the inbound data
+ */
+static void ussd_batch_callback(void* cookie, uint8_t* data, uint16_t len)
+{
+    UssdBatchState* state = (UssdBatchState*)cookie;
+    if (state->sessionOpen)
+    {
+        state->awaitingReply = false;
+        state->endAt = Thingstream_Platform_getTimeMillis() + state->lingerMs;
+    }
+    if (state->callback != NULL)
+    {
+        state->callback(state->cookie, data, len);
+    }
+}
+
+/**
+ * Register a callback function that will be called when this transport
+ * has data to send to its next outermost ThingstreamTransport.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param callback the callback function
+ * @param cookie a opaque value passed to the callback function
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult ussd_batch_register_callback(ThingstreamTransport* self, ThingstreamTransportCallback_t callback, void* cookie)
+{
+    UssdBatchState* state = (UssdBatchState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    state->callback = callback;
+    state->cookie = cookie;
+    return inner->register_callback(inner, ussd_batch_callback, state);
+}
+
+/**
+ * Allow the inner transport to run for at most the given number of
+ * milliseconds, then end the session if the burst is over: the reply to
+ * the last exchange has arrived (or has not arrived within REPLY_WAIT_MS)
+ * and there has been no traffic for lingerMs.
+ *
+ * @param self the #ThingstreamTransport instance
+ * @param millis the maximum number of milliseconds to run (a value of zero
+ *        processes all pending operations).
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+static ThingstreamTransportResult ussd_batch_run(ThingstreamTransport* self, uint32_t millis)
+{
+    UssdBatchState* state = (UssdBatchState*)self->_state;
+    ThingstreamTransport* inner = state->inner;
+    ThingstreamTransportResult tRes = inner->run(inner, millis);
+    if (state->sessionOpen)
+    {
+        uint32_t now = Thingstream_Platform_getTimeMillis();
+        bool over = state->awaitingReply
+                    ? TIME_COMPARE(now, >=, state->sentAt + REPLY_WAIT_MS)
+                    : TIME_COMPARE(now, >=, state->endAt);
+        if (over)
+        {
+            (void)Thingstream_UssdBatch_endSession(self, END_SESSION_MS);
+        }
+    }
+    return tRes;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2026 Thingstream AG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief ThingstreamTransport implementation that keeps a USSD session open
+ * across a burst of exchanges.
+ */
+
+#ifndef INC_USSD_BATCH_TRANSPORT_H
+#define INC_USSD_BATCH_TRANSPORT_H
+
+#include <stdint.h>
+
+#include "transport_api.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#elif 0
+}
+#endif
+
+/**
+ * Create an instance of the USSD batch transport. It is placed directly
+ * above the modem transport, below the base64 codec transport.
+ *
+ * The protocol transport asks for the USSD session to end (with
+ * #TSEND_USSD_SESSION_END) after each exchange, so each publish, ping or
+ * inbound drain sets up a new session. This transport removes that request
+ * and keeps the session open for lingerMs after the last exchange, so that
+ * the next exchange in a burst uses the same session. An exchange is over
+ * when its reply has arrived, and any inbound traffic restarts lingerMs.
+ * When the burst is over the session is ended with
+ * #Thingstream_Modem_ussdEndSessionString from the run routine.
+ *
+ * UDP traffic does not use #TSEND_USSD_SESSION_END and is unaffected.
+ *
+ * @param modem the modem transport instance
+ * @param lingerMs the time to keep the session open after an exchange
+ * @return the #ThingstreamTransport instance
+ */
+extern ThingstreamTransport* Thingstream_createUssdBatchTransport(ThingstreamTransport* modem, uint32_t lingerMs);
+
+/**
+ * End the USSD session now if one is being kept open, e.g. before the
+ * application stops calling Thingstream_Client_run() to sleep.
+ *
+ * @param self this instance of USSD batch transport
+ * @param millis the maximum number of milliseconds to run
+ * @return a #ThingstreamTransportResult status code (success / fail)
+ */
+extern ThingstreamTransportResult Thingstream_UssdBatch_endSession(ThingstreamTransport* self, uint32_t millis);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* INC_USSD_BATCH_TRANSPORT_H */